@@ -0,0 +1,556 @@
+/*******************************************************************************
+ Benchmark: Headless integration throughput benchmark.
+
+ This file is part of the Dynamics Toolset.
+
+ The Dynamics Toolset is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by the Free
+ Software Foundation, either version 3 of the License, or (at your option) any
+ later version.
+
+ The Dynamics Toolset is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ details.
+
+ You should have received a copy of the GNU General Public License
+ along with the Dynamics Toolset. If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+
+/*
+ Loads the experiment plugins the way the application does, without Vrui, and
+ measures how fast each of their integrators advances states:
+
+   single  one trajectory through Experiment::getStepper(), the path of the
+           StaticSolver tool (fused for experiments that register a stepper)
+   virtual one trajectory through Experiment::stepState()
+   batch   a particle system through Integrator::stepBatch(), split across
+           a ThreadPool as in the DotSpreader and ParticleSprayer tools
+
+ for every combination of experiment (and so dimension), integrator, particle
+ count and thread count. The particles start on the attractor, spread along
+ a trajectory that has run through a transient. Each result has the steps
+ per second of all threads together, the wall-clock nanoseconds per
+ evaluation of the model and the nanoseconds of processor time per
+ evaluation (wall time times threads), from the evaluations the integrators
+ count (see DTS::Counters). The results are written as JSON:
+
+   benchmark [-p plugins] [-m models] [-o benchmark.json] [-t seconds]
+             [-n 1000,100000] [-j 1,2,4] [-e experiment] [-i integrator]
+ */
+
+#include "PluginLoader.h"
+
+// STL includes
+//
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// System includes
+//
+#include <dlfcn.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+// Project includes
+//
+#include "Counters.h"
+#include "Factory.h"
+#include "ThreadPool.h"
+
+///< Filled in by the plugins
+ExperimentFactory Factory;
+
+namespace
+{
+
+typedef Experiment<Scalar> DTSExperiment;
+
+struct Options
+{
+      std::string pluginDirectory;
+      std::string modelDirectory;
+      std::string output;
+      double minTime; ///< Seconds each measurement runs at least.
+      std::vector<size_t> particles;
+      std::vector<int> threads;
+      std::string experiment; ///< Only this experiment, if not empty.
+      std::string integrator; ///< Only this integrator, if not empty.
+};
+
+struct Result
+{
+      std::string experiment;
+      int dimension;
+      std::string integrator;
+      std::string mode;
+      size_t particles;
+      int threads;
+      unsigned long long steps;
+      double seconds;
+      double evaluationsPerStep; ///< Negative if not known.
+};
+
+double now()
+{
+   struct timeval tv;
+   gettimeofday(&tv, 0);
+   return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+template <typename T>
+std::vector<T> parseList(const char* text)
+{
+   std::vector<T> values;
+   std::istringstream in(text);
+   std::string item;
+   while (std::getline(in, item, ','))
+   {
+      std::istringstream value(item);
+      T v;
+      if (value >> v)
+         values.push_back(v);
+   }
+   return values;
+}
+
+/** Model evaluations per integrator step, from the DTS::Counters the
+ * integrators add to.
+ */
+class EvaluationCounter
+{
+   public:
+      EvaluationCounter()
+      {
+         DTS::Counters::read(start);
+      }
+
+      double evaluationsPerStep() const
+      {
+         std::vector<DTS::Counters::Value> end;
+         DTS::Counters::read(end);
+
+         DTS::Counters::Value steps=end[DTS::Counters::STEPS] - start[DTS::Counters::STEPS];
+         if (steps == 0)
+            return -1;
+         return double(end[DTS::Counters::EVALUATIONS] - start[DTS::Counters::EVALUATIONS]) / steps;
+      }
+
+   private:
+      std::vector<DTS::Counters::Value> start;
+};
+
+/// Steps from the start near the center to the attractor, and between the
+/// starting states of consecutive particles.
+const unsigned int TransientSteps=10000;
+const unsigned int ParticleSpacing=3;
+
+/** Starting states on the attractor, in SoA layout.
+ *
+ * A start with equal offsets from the center lies on the invariant diagonal
+ * of symmetric models like Halvorsen and Thomas, where the states decay
+ * until the arithmetic is on denormals. So the offsets differ between the
+ * components, and the states are taken from the trajectory after a
+ * transient.
+ */
+void initialStates(DTSExperiment* experiment, std::vector<Scalar>& states,
+      size_t count, size_t stride)
+{
+   int dimension=experiment->model->getDimension();
+   DynamicalModel<Scalar>::Vector center=experiment->model->getCenterPoint();
+
+   std::vector<Scalar> state(dimension);
+   for (int k=0; k < dimension; k++)
+   {
+      state[k]=center[k] + 0.1 * (k + 1) + 0.013 * k * k;
+   }
+
+   for (unsigned int s=0; s < TransientSteps; s++)
+      experiment->stepState(&state[0]);
+
+   states.assign(dimension * stride, 0.0);
+   for (size_t i=0; i < count; i++)
+   {
+      for (int k=0; k < dimension; k++)
+      {
+         states[k * stride + i]=state[k];
+      }
+      for (unsigned int s=0; s < ParticleSpacing; s++)
+         experiment->stepState(&state[0]);
+   }
+}
+
+/** Advances a range of particles, as the DotSpreader tool does.
+ */
+class StepTask: public DTS::ThreadPool::Task
+{
+   public:
+      DTSExperiment* experiment;
+      int dimension;
+      size_t stride;
+      Scalar* states;
+      Scalar* steps;
+      Integrator<Scalar>::Workspace* workspaces; ///< Indexed by thread.
+
+      void run(size_t begin, size_t end, int thread)
+      {
+         experiment->integrator->stepBatch(states + begin, steps + begin,
+               end - begin, stride, workspaces[thread]);
+         for (int k=0; k < dimension; k++)
+         {
+            Scalar* state=states + k * stride;
+            const Scalar* step=steps + k * stride;
+            for (size_t i=begin; i < end; i++)
+            {
+               state[i]+=step[i];
+            }
+         }
+      }
+};
+
+/** Runs 'run' with growing repetition counts until it takes minTime,
+ * returning the repetitions and seconds of the last round.
+ */
+template <typename RunParam>
+void measure(RunParam& run, double minTime, unsigned long long& repetitions, double& seconds)
+{
+   run.reset();
+   run(1); // warm up caches and multistep histories
+
+   repetitions=1;
+   while (true)
+   {
+      run.reset();
+      double start=now();
+      run(repetitions);
+      seconds=now() - start;
+
+      if (seconds >= minTime || repetitions >= (1ULL << 40))
+         return;
+
+      // aim a little past minTime to save rounds
+      double factor=seconds > 0.0 ? 1.5 * minTime / seconds : 100.0;
+      if (factor < 2.0)
+         factor=2.0;
+      if (factor > 100.0)
+         factor=100.0;
+      repetitions=(unsigned long long) (repetitions * factor);
+   }
+}
+
+struct SingleRun
+{
+      DTSExperiment* experiment;
+      bool fused;
+      std::vector<Scalar> start;
+      std::vector<Scalar> state;
+
+      void reset()
+      {
+         state=start;
+      }
+
+      void operator()(unsigned long long repetitions)
+      {
+         if (fused)
+         {
+            DTSExperiment::Stepper& stepper=experiment->getStepper();
+            for (unsigned long long r=0; r < repetitions; r++)
+               stepper(&state[0]);
+         }
+         else
+         {
+            for (unsigned long long r=0; r < repetitions; r++)
+               experiment->stepState(&state[0]);
+         }
+      }
+};
+
+struct BatchRun
+{
+      DTSExperiment* experiment;
+      DTS::ThreadPool* pool;
+      size_t count;
+      std::vector<Scalar> start;
+      std::vector<Scalar> states;
+      std::vector<Scalar> steps;
+      std::vector<Integrator<Scalar>::Workspace> workspaces;
+
+      void reset()
+      {
+         states=start;
+      }
+
+      void operator()(unsigned long long repetitions)
+      {
+         StepTask task;
+         task.experiment=experiment;
+         task.dimension=experiment->model->getDimension();
+         task.stride=count;
+         task.states=&states[0];
+         task.steps=&steps[0];
+         task.workspaces=&workspaces[0];
+
+         for (unsigned long long r=0; r < repetitions; r++)
+            pool->parallelFor(count, 1024, task);
+      }
+};
+
+Result makeResult(const std::string& name, DTSExperiment* experiment, const std::string& mode,
+      size_t particles, int threads)
+{
+   Result result;
+   result.experiment=name;
+   result.dimension=experiment->model->getDimension();
+   result.integrator=experiment->integrator->getName();
+   result.mode=mode;
+   result.particles=particles;
+   result.threads=threads;
+   result.steps=0;
+   result.seconds=0.0;
+   result.evaluationsPerStep=-1;
+   return result;
+}
+
+void report(const Result& result)
+{
+   std::fprintf(stderr, "   %-10s %-8s %-7s %8lu particles %2d threads %12.4g steps/s\n",
+         result.experiment.c_str(), result.integrator.c_str(), result.mode.c_str(),
+         (unsigned long) result.particles, result.threads,
+         result.steps / result.seconds);
+}
+
+void benchmarkExperiment(const std::string& name, DTSExperiment* experiment,
+      const Options& options, std::vector<Result>& results)
+{
+   int dimension=experiment->model->getDimension();
+   std::vector<std::string> integrators=experiment->getIntegratorNames();
+
+   for (size_t n=0; n < integrators.size(); n++)
+   {
+      if (!options.integrator.empty() && integrators[n] != options.integrator)
+         continue;
+
+      experiment->setIntegrator(integrators[n]);
+      Integrator<Scalar>* integrator=experiment->integrator;
+
+      // one trajectory, through the stepper and the virtual path
+      for (int fused=1; fused >= 0; fused--)
+      {
+         SingleRun run;
+         run.experiment=experiment;
+         run.fused=fused;
+         initialStates(experiment, run.start, 1, 1);
+
+         Result result=makeResult(name, experiment, fused ? "single" : "virtual", 1, 1);
+         EvaluationCounter counter;
+         measure(run, options.minTime, result.steps, result.seconds);
+         result.evaluationsPerStep=counter.evaluationsPerStep();
+         results.push_back(result);
+         report(result);
+      }
+
+      // particle systems, in parallel only where the integrator allows it
+      for (size_t p=0; p < options.particles.size(); p++)
+      {
+         size_t count=options.particles[p];
+         for (size_t t=0; t < options.threads.size(); t++)
+         {
+            int threads=options.threads[t];
+            if (threads > 1 && !integrator->isReentrant())
+               continue;
+
+            DTS::ThreadPool pool(threads);
+
+            BatchRun run;
+            run.experiment=experiment;
+            run.pool=&pool;
+            run.count=count;
+            initialStates(experiment, run.start, count, count);
+            run.steps.resize(dimension * count);
+            run.workspaces.resize(pool.getNumThreads());
+
+            Result result=makeResult(name, experiment, "batch", count, pool.getNumThreads());
+            EvaluationCounter counter;
+            unsigned long long repetitions;
+            measure(run, options.minTime, repetitions, result.seconds);
+            result.steps=repetitions * count;
+            result.evaluationsPerStep=counter.evaluationsPerStep();
+            results.push_back(result);
+            report(result);
+         }
+      }
+   }
+}
+
+std::string jsonString(const std::string& text)
+{
+   std::string quoted="\"";
+   for (size_t i=0; i < text.size(); i++)
+   {
+      if (text[i] == '"' || text[i] == '\\')
+         quoted+='\\';
+      quoted+=text[i];
+   }
+   return quoted + "\"";
+}
+
+void writeJson(std::ostream& out, const Options& options, const std::vector<Result>& results)
+{
+   char host[256]="";
+   gethostname(host, sizeof(host) - 1);
+
+   char date[64]="";
+   time_t t=time(0);
+   strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", gmtime(&t));
+
+   out.precision(6);
+   out << "{\n";
+   out << "  \"host\": " << jsonString(host) << ",\n";
+   out << "  \"date\": " << jsonString(date) << ",\n";
+   out << "  \"processors\": " << DTS::ThreadPool::getNumProcessors() << ",\n";
+   out << "  \"minTime\": " << options.minTime << ",\n";
+   out << "  \"results\": [";
+   for (size_t i=0; i < results.size(); i++)
+   {
+      const Result& r=results[i];
+      double stepsPerSecond=r.steps / r.seconds;
+
+      out << (i == 0 ? "\n" : ",\n");
+      out << "    {\"experiment\": " << jsonString(r.experiment)
+          << ", \"dimension\": " << r.dimension
+          << ", \"integrator\": " << jsonString(r.integrator)
+          << ", \"mode\": " << jsonString(r.mode)
+          << ", \"particles\": " << r.particles
+          << ", \"threads\": " << r.threads
+          << ", \"steps\": " << r.steps
+          << ", \"seconds\": " << r.seconds
+          << ", \"stepsPerSecond\": " << stepsPerSecond;
+      if (r.evaluationsPerStep > 0)
+      {
+         double nsPerEvaluation=1e9 / (stepsPerSecond * r.evaluationsPerStep);
+         out << ", \"evaluationsPerStep\": " << r.evaluationsPerStep
+             << ", \"nsPerEvaluation\": " << nsPerEvaluation
+             << ", \"cpuNsPerEvaluation\": " << nsPerEvaluation * r.threads;
+      }
+      else
+      {
+         out << ", \"evaluationsPerStep\": null, \"nsPerEvaluation\": null"
+             << ", \"cpuNsPerEvaluation\": null";
+      }
+      out << "}";
+   }
+   out << "\n  ]\n}\n";
+}
+
+void usage(const char* program)
+{
+   std::cerr << "Usage: " << program << " [-p plugin directory] [-m model directory]"
+         << " [-o output.json|-] [-t seconds] [-n particle counts] [-j thread counts]"
+         << " [-e experiment] [-i integrator]" << std::endl;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+   Options options;
+   options.pluginDirectory="plugins";
+   options.modelDirectory="models";
+   options.output="benchmark.json";
+   options.minTime=0.2;
+   options.particles.push_back(1000);
+   options.particles.push_back(100000);
+   for (int threads=1; threads < DTS::ThreadPool::getNumProcessors(); threads*=2)
+      options.threads.push_back(threads);
+   options.threads.push_back(DTS::ThreadPool::getNumProcessors());
+
+   for (int i=1; i < argc; i++)
+   {
+      std::string option=argv[i];
+      if (i + 1 >= argc || option.size() != 2 || option[0] != '-')
+      {
+         usage(argv[0]);
+         return 1;
+      }
+
+      const char* value=argv[++i];
+      switch (option[1])
+      {
+         case 'p':
+            options.pluginDirectory=value;
+            break;
+         case 'm':
+            options.modelDirectory=value;
+            break;
+         case 'o':
+            options.output=value;
+            break;
+         case 't':
+            options.minTime=std::atof(value);
+            break;
+         case 'n':
+            options.particles=parseList<size_t> (value);
+            break;
+         case 'j':
+            options.threads=parseList<int> (value);
+            break;
+         case 'e':
+            options.experiment=value;
+            break;
+         case 'i':
+            options.integrator=value;
+            break;
+         default:
+            usage(argv[0]);
+            return 1;
+      }
+   }
+
+   std::vector<void*> libraries;
+   loadPlugins(options.pluginDirectory, options.modelDirectory, libraries);
+   if (Factory.empty())
+   {
+      std::cerr << "ERROR: no experiments in " << options.pluginDirectory << std::endl;
+      return 1;
+   }
+
+   std::vector<Result> results;
+   for (ExperimentFactory::iterator it=Factory.begin(); it != Factory.end(); ++it)
+   {
+      if (!options.experiment.empty() && it->first != options.experiment)
+         continue;
+
+      DTSExperiment* experiment=it->second();
+      benchmarkExperiment(it->first, experiment, options, results);
+      delete experiment;
+   }
+
+   if (options.output == "-")
+   {
+      writeJson(std::cout, options, results);
+   }
+   else
+   {
+      std::ofstream file(options.output.c_str());
+      writeJson(file, options, results);
+      if (!file)
+      {
+         std::cerr << "ERROR: cannot write " << options.output << std::endl;
+         return 1;
+      }
+      std::cerr << "Results written to " << options.output << std::endl;
+   }
+
+   for (size_t i=0; i < libraries.size(); i++)
+      dlclose(libraries[i]);
+
+   return 0;
+}
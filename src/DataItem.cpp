@@ -43,10 +43,15 @@ DataItem::DataItem(void)
    : hasPointParameterExtension(GLARBPointParameters::isSupported()),
    hasVertexBufferObjectExtension(GLARBVertexBufferObject::isSupported()),
    hasShaders(GLARBShaderObjects::isSupported()&&GLARBVertexShader::isSupported()&&GLARBFragmentShader::isSupported()),
-   vertexBufferId(0), spriteTextureObjectId(0), versionDS(0),
+   vertexBufferId(0), particleSprayerBufferId(0), particleSprayerBufferCapacity(0),
+   spriteTextureObjectId(0), versionDS(0),
    versionPS(0),
    vertexShaderObject(0),fragmentShaderObject(0),programObject(0),
-   numParticlesDS(0), numParticlesPS(0), tempDisplay(3)
+   numParticlesDS(0), numParticlesPS(0), staticSolverBufferId(0), staticSolverTubeVersion(0), sweepBufferId(0), sweepBufferVersion(0),
+   poincareBufferId(0), poincareBufferVersion(0), poincareBufferCapacity(0),
+   poincareUploadedPoints(0), dynamicSolverBufferId(0), dynamicSolverBufferCapacity(0),
+   dynamicSolverIndexBufferId(0), dynamicSolverIndexedLines(0), dynamicSolverIndexedHistory(0),
+   dynamicSolverSphereListId(0), dynamicSolverSphereRadius(-1.0f), tempDisplay(3)
 {
    master::filter masterout(std::cout);
 
@@ -71,6 +76,12 @@ DataItem::DataItem(void)
 
       // create a vertex buffer object
       glGenBuffersARB(1,&vertexBufferId);
+      glGenBuffersARB(1,&particleSprayerBufferId);
+      glGenBuffersARB(1,&staticSolverBufferId);
+      glGenBuffersARB(1,&sweepBufferId);
+      glGenBuffersARB(1,&poincareBufferId);
+      glGenBuffersARB(1,&dynamicSolverBufferId);
+      glGenBuffersARB(1,&dynamicSolverIndexBufferId);
 
       masterout() << ansi::green(ansi::BOLD) << "OK" << ansi::endl;
    }
@@ -131,6 +142,10 @@ DataItem::DataItem(void)
    /* Display list for StaticSolverTool */
    dataDisplayListVersion = 0;
    dataDisplayListId=glGenLists(1);
+   staticSolverBufferVersion = 0;
+
+   /* Display list for the head spheres of DynamicSolverTool */
+   dynamicSolverSphereListId=glGenLists(1);
 }
 
 DataItem::~DataItem(void)
@@ -144,6 +159,41 @@ DataItem::~DataItem(void)
       glDeleteBuffersARB(1,&vertexBufferId);
    }
 
+   if(particleSprayerBufferId>0)
+   {
+      glDeleteBuffersARB(1,&particleSprayerBufferId);
+   }
+
+   if(staticSolverBufferId>0)
+   {
+      glDeleteBuffersARB(1,&staticSolverBufferId);
+   }
+
+   if(!staticSolverTubeBufferIds.empty())
+   {
+      glDeleteBuffersARB(staticSolverTubeBufferIds.size(),&staticSolverTubeBufferIds[0]);
+   }
+
+   if(sweepBufferId>0)
+   {
+      glDeleteBuffersARB(1,&sweepBufferId);
+   }
+
+   if(poincareBufferId>0)
+   {
+      glDeleteBuffersARB(1,&poincareBufferId);
+   }
+
+   if(dynamicSolverBufferId>0)
+   {
+      glDeleteBuffersARB(1,&dynamicSolverBufferId);
+   }
+
+   if(dynamicSolverIndexBufferId>0)
+   {
+      glDeleteBuffersARB(1,&dynamicSolverIndexBufferId);
+   }
+
    // delete texture object(s)
    glDeleteTextures(1, &spriteTextureObjectId);
 
@@ -157,6 +207,9 @@ DataItem::~DataItem(void)
    /* Display list for StaticSolverTool */
    glDeleteLists(dataDisplayListId, 1);
 
+   /* Display list for DynamicSolverTool */
+   glDeleteLists(dynamicSolverSphereListId, 1);
+
 }
 
 } // namspace::DTS
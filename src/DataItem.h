@@ -32,9 +32,14 @@
 // font rendering
 #include <FTGL/ftgl.h>
 
+// STL includes
+#include <vector>
+
 // local Vector
 #include "Vector.h"
 
+#include "ColorPoint.h"
+
 
 
 namespace DTS
@@ -50,6 +55,8 @@ struct DataItem: public GLObject::DataItem
       bool hasShaders; ///< Flag whether local OpenGL supports GLSL shaders.
 
       GLuint vertexBufferId; ///< Vertex object buffer ID.
+      GLuint particleSprayerBufferId; ///< Vertex buffer of the ParticleSprayerTool.
+      size_t particleSprayerBufferCapacity; ///< Particles the sprayer buffer has room for.
       GLuint spriteTextureObjectId; ///< Texture object ID for point sprites.
 
       ///< Used for syncing VOB rendering.
@@ -99,6 +106,41 @@ struct DataItem: public GLObject::DataItem
       GLuint dataDisplayListId;
       unsigned int dataDisplayListVersion;
 
+      /* Lines of the static solutions still being computed, appended to
+         as points arrive (see StaticSolverTool::drawPartialLines) */
+      GLuint staticSolverBufferId;
+      unsigned int staticSolverBufferVersion;
+      std::vector<unsigned int> staticSolverUploadedPoints; ///< Points in the buffer, per dataset.
+
+      /* Tube meshes of the StaticSolverTool, uploaded when they are rebuilt
+         (see StaticSolverTool::drawTubes) */
+      std::vector<GLuint> staticSolverTubeBufferIds; ///< Vertex and index buffer per tube.
+      unsigned int staticSolverTubeVersion;
+
+      /* Points of the SweepViewerTool, uploaded when they change */
+      GLuint sweepBufferId;
+      unsigned int sweepBufferVersion;
+
+      /* Crossings of the PoincareSectionTool, appended to as they arrive */
+      GLuint poincareBufferId;
+      unsigned int poincareBufferVersion;
+      size_t poincareBufferCapacity; ///< Points the buffer has room for.
+      size_t poincareUploadedPoints; ///< Points in the buffer.
+
+      /* Trails and heads of the DynamicSolverTool, transformed and uploaded
+         once per frame (see DynamicSolverTool::updateVertices) */
+      GLuint dynamicSolverBufferId;
+      size_t dynamicSolverBufferCapacity; ///< Vertices the buffer has room for.
+      GLuint dynamicSolverIndexBufferId; ///< Segment indices, then head indices.
+      std::vector<GLuint> dynamicSolverIndices; ///< The indices as uploaded, drawn from client memory without VBOs.
+      unsigned int dynamicSolverIndexedLines; ///< Lines the indices were made for.
+      unsigned int dynamicSolverIndexedHistory; ///< Trail length the indices were made for.
+      GLuint dynamicSolverSphereListId; ///< Head sphere mesh, drawn once per head.
+      float dynamicSolverSphereRadius; ///< Radius the sphere list was compiled for.
+      std::vector<double> dynamicSolverStates; ///< Gathered trail states, structure-of-arrays.
+      std::vector<double> dynamicSolverDisplays; ///< Display positions of the trail states.
+      std::vector<ColorPoint> dynamicSolverVertices; ///< Vertices as uploaded.
+
       // fonts
       FTFont* font;
 
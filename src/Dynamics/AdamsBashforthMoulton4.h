@@ -0,0 +1,257 @@
+#ifndef ADAMSBASHFORTHMOULTON4_H
+#define ADAMSBASHFORTHMOULTON4_H
+
+#include <vector>
+
+#include "Integrator.h"
+#include "RungeKutta4Batch.h"
+
+/*
+    Fourth-order Adams-Bashforth-Moulton predictor-corrector.
+
+    Each step predicts the new state from the derivatives at the last four
+    states (Adams-Bashforth), evaluates the model there and corrects the
+    prediction (Adams-Moulton). Together with the derivative at the start
+    of the step, which becomes part of the history, a step costs two
+    evaluations of the model instead of the four of "rk4", at the same
+    order and step size.
+
+    The derivatives belong to one trajectory and are kept in a History,
+    which callers stepping a trajectory pass to step() explicitly. The first
+    three steps of a History are Runge-Kutta 4 steps. A History restarts by
+    itself when the state passed in is not the one it returned last, or
+    when the model or the step size changed.
+
+    The generic step() keeps a History of its own, so consecutive calls for
+    one trajectory are multistep steps and anything else falls back to
+    RK4. stepBatch() has no history per state and always uses RK4.
+*/
+class AdamsBashforthMoulton4 : public Integrator<double>
+{
+public:
+
+    class History
+    {
+        friend class AdamsBashforthMoulton4;
+
+    private:
+
+        // Last four derivatives, the newest at index 'newest'
+        std::vector<Scalar> derivatives;
+        // State at the end of the last step
+        std::vector<Scalar> state;
+        int count;
+        int newest;
+        unsigned int modelVersion;
+        unsigned int integratorVersion;
+
+    public:
+
+        History()
+        : count(0),
+          newest(0),
+          modelVersion(0),
+          integratorVersion(0)
+        {
+        }
+
+        // Start over with the next step
+        void reset()
+        {
+            count = 0;
+        }
+    };
+
+private:
+
+    /* Elements: */
+
+    int dimension;
+
+    // History of the generic step()
+    History history;
+
+    // Vectors for intermediate calculations
+    std::vector<Scalar> k2;
+    std::vector<Scalar> k3;
+    std::vector<Scalar> k4;
+    std::vector<Scalar> temp;
+
+    // Arguments of the model, see DynamicalModel::evaluateState()
+    Vector stateTemp;
+    Vector valueTemp;
+
+public:
+
+    /* Constructors and destructors: */
+
+    AdamsBashforthMoulton4(const Model& model, Scalar stepSize=.01)
+    : Integrator<double>(model),
+      dimension(model.getDimension()),
+      k2(dimension),
+      k3(dimension),
+      k4(dimension),
+      temp(dimension),
+      stateTemp(dimension),
+      valueTemp(dimension)
+    {
+        if (dimension == 0)
+        {
+            throw IntegratorException();
+        }
+
+        name = "abm4";
+
+        addRealParameter( RealParameter("stepSize", stepSize, .0001, .2, .01, .0001) );
+    }
+
+    virtual ~AdamsBashforthMoulton4()
+    {
+    }
+
+    /* Methods: */
+
+    void step(Vector const& v, Vector& out)
+    {
+        step(history, v, out);
+    }
+
+    // Step vector from v, continuing the trajectory of 'h' if possible
+    void step(History& h, Vector const& v, Vector& out)
+    {
+        Scalar stepSize = realParamValues[0];
+
+        DTS::Counters::add(DTS::Counters::STEPS);
+
+        if (!continues(h, v))
+        {
+            h.derivatives.resize(4 * dimension);
+            h.state.resize(dimension);
+            h.count = 0;
+            h.modelVersion = model.getVersion();
+            h.integratorVersion = getVersion();
+        }
+
+        /* The derivative at v joins the history: */
+        h.newest = (h.newest + 1) % 4;
+        Scalar* f0 = &h.derivatives[h.newest * dimension];
+        model(v, valueTemp);
+        for (int c = 0; c < dimension; c++)
+        {
+            f0[c] = valueTemp[c];
+        }
+        if (h.count < 4)
+        {
+            h.count++;
+        }
+
+        if (h.count < 4)
+        {
+            DTS::Counters::add(DTS::Counters::EVALUATIONS, 4);
+            rungeKutta4(f0, v, out);
+        }
+        else
+        {
+            DTS::Counters::add(DTS::Counters::EVALUATIONS, 2);
+            Scalar const* f1 = derivative(h, 1);
+            Scalar const* f2 = derivative(h, 2);
+            Scalar const* f3 = derivative(h, 3);
+            Scalar const scale = stepSize / Scalar(24);
+
+            /* Predict: */
+            for (int c = 0; c < dimension; c++)
+            {
+                temp[c] = v[c] + scale * (Scalar(55) * f0[c] - Scalar(59) * f1[c] +
+                                          Scalar(37) * f2[c] - Scalar(9) * f3[c]);
+            }
+
+            /* Evaluate and correct: */
+            model.evaluateState(&temp[0], &k2[0], stateTemp, valueTemp);
+            for (int c = 0; c < dimension; c++)
+            {
+                out[c] = scale * (Scalar(9) * k2[c] + Scalar(19) * f0[c] -
+                                  Scalar(5) * f1[c] + f2[c]);
+            }
+        }
+
+        // Callers add the step vector to v, store the state the same way
+        for (int c = 0; c < dimension; c++)
+        {
+            h.state[c] = v[c] + out[c];
+        }
+    }
+
+    using Integrator<double>::stepBatch;
+
+    // Particles have no history, step them with RK4 in 'work'
+    void stepBatch(Scalar const* in, Scalar* out, size_t count, size_t stride,
+                   Workspace& work)
+    {
+        rungeKutta4StepBatch(model, realParamValues[0], in, out, count, stride, work);
+    }
+
+    bool isReentrant() const
+    {
+        return true;
+    }
+
+private:
+
+    bool continues(History const& h, Vector const& v) const
+    {
+        if (h.count == 0 || int(h.state.size()) != dimension ||
+            h.modelVersion != model.getVersion() ||
+            h.integratorVersion != getVersion())
+        {
+            return false;
+        }
+
+        for (int c = 0; c < dimension; c++)
+        {
+            if (h.state[c] != v[c])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Derivative 'age' steps before the newest one
+    Scalar const* derivative(History const& h, int age) const
+    {
+        return &h.derivatives[((h.newest + 4 - age) % 4) * dimension];
+    }
+
+    // Runge-Kutta 4 step vector, with the first stage already evaluated
+    void rungeKutta4(Scalar const* k1, Vector const& v, Vector& out)
+    {
+        Scalar stepSize = realParamValues[0];
+        Scalar halfStep = stepSize * Scalar(0.5);
+
+        for (int c = 0; c < dimension; c++)
+        {
+            temp[c] = v[c] + halfStep * k1[c];
+        }
+        model.evaluateState(&temp[0], &k2[0], stateTemp, valueTemp);
+
+        for (int c = 0; c < dimension; c++)
+        {
+            temp[c] = v[c] + halfStep * k2[c];
+        }
+        model.evaluateState(&temp[0], &k3[0], stateTemp, valueTemp);
+
+        for (int c = 0; c < dimension; c++)
+        {
+            temp[c] = v[c] + stepSize * k3[c];
+        }
+        model.evaluateState(&temp[0], &k4[0], stateTemp, valueTemp);
+
+        for (int c = 0; c < dimension; c++)
+        {
+            out[c] = stepSize / Scalar(6) *
+                     (k1[c] + Scalar(2) * (k2[c] + k3[c]) + k4[c]);
+        }
+    }
+};
+
+#endif
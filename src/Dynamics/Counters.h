@@ -0,0 +1,241 @@
+#ifndef DTS_COUNTERS_H
+#define DTS_COUNTERS_H
+
+#include <pthread.h>
+#include <sys/time.h>
+
+#include <string>
+#include <vector>
+
+namespace DTS {
+
+/*
+    Registry of counters for the hot paths: model evaluations, integrator
+    steps, transformer calls, Vector allocations, bytes uploaded to buffer
+    objects and the time tools spend stepping and rendering.
+
+    Counting is meant to stay on in release builds. Every thread adds to a
+    block of counters of its own, without locking or atomic instructions;
+    read() sums the blocks of all threads that ever counted. The totals
+    only grow, so per-frame values are the differences of two reads.
+
+    The built-in counters have fixed indices. Others, like the timers of the
+    tools, are registered by name with getCounter(). Integrators count whole
+    batches, so a count costs about as much as one addition per call and not
+    per state.
+
+    The registry is defined in this header and shared by the application
+    and the plugins, which resolve it to the same symbols at load time.
+*/
+class Counters
+{
+public:
+
+    enum Builtin
+    {
+        EVALUATIONS,  // Evaluations of the model equations, per state
+        STEPS,        // Integrator steps, per state
+        TRANSFORMS,   // States transformed to display coordinates
+        ALLOCATIONS,  // DTS::Vector constructions
+        UPLOAD_BYTES, // Bytes passed to glBufferData
+        NUM_BUILTIN
+    };
+
+    enum Unit
+    {
+        COUNT,
+        BYTES,
+        NANOSECONDS
+    };
+
+    enum
+    {
+        MAX_COUNTERS = 64
+    };
+
+    typedef unsigned long long Value;
+
+    // Counter -1, from a full registry, is ignored
+    static inline void add(int counter, Value amount = 1)
+    {
+        if (counter >= 0)
+        {
+            threadBlock()->values[counter] += amount;
+        }
+    }
+
+    /*
+        Index of the counter with the given name, registered with 'unit' if
+        there is none yet. Returns -1 if the registry is full, which add()
+        and ScopedTimer accept and ignore.
+    */
+    static int getCounter(std::string const& name, Unit unit = COUNT)
+    {
+        Registry& r = registry();
+        pthread_mutex_lock(&r.mutex);
+
+        int counter = -1;
+        for (size_t i = 0; i < r.names.size(); i++)
+        {
+            if (r.names[i] == name)
+            {
+                counter = int(i);
+            }
+        }
+        if (counter < 0 && r.names.size() < MAX_COUNTERS)
+        {
+            counter = int(r.names.size());
+            r.names.push_back(name);
+            r.units.push_back(unit);
+        }
+
+        pthread_mutex_unlock(&r.mutex);
+        return counter;
+    }
+
+    static int getNumCounters()
+    {
+        Registry& r = registry();
+        pthread_mutex_lock(&r.mutex);
+        int count = int(r.names.size());
+        pthread_mutex_unlock(&r.mutex);
+        return count;
+    }
+
+    static std::string getName(int counter)
+    {
+        Registry& r = registry();
+        pthread_mutex_lock(&r.mutex);
+        std::string name = r.names[counter];
+        pthread_mutex_unlock(&r.mutex);
+        return name;
+    }
+
+    static Unit getUnit(int counter)
+    {
+        Registry& r = registry();
+        pthread_mutex_lock(&r.mutex);
+        Unit unit = r.units[counter];
+        pthread_mutex_unlock(&r.mutex);
+        return unit;
+    }
+
+    // Totals of all counters since the start, indexed by counter
+    static void read(std::vector<Value>& totals)
+    {
+        Registry& r = registry();
+        pthread_mutex_lock(&r.mutex);
+
+        totals.assign(r.names.size(), 0);
+        for (Block const* block = r.blocks; block != 0; block = block->next)
+        {
+            for (size_t i = 0; i < totals.size(); i++)
+            {
+                totals[i] += block->values[i];
+            }
+        }
+
+        pthread_mutex_unlock(&r.mutex);
+    }
+
+    // Adds the time until destruction to a NANOSECONDS counter
+    class ScopedTimer
+    {
+    public:
+        explicit ScopedTimer(int counter)
+        : counter(counter),
+          start(now())
+        {
+        }
+
+        ~ScopedTimer()
+        {
+            if (counter >= 0)
+            {
+                add(counter, now() - start);
+            }
+        }
+
+    private:
+        int counter;
+        Value start;
+
+        static Value now()
+        {
+            struct timeval tv;
+            gettimeofday(&tv, 0);
+            return Value(tv.tv_sec) * 1000000000ULL + Value(tv.tv_usec) * 1000ULL;
+        }
+    };
+
+private:
+
+    struct Block
+    {
+        // Written only by the owning thread, read by read()
+        volatile Value values[MAX_COUNTERS];
+        Block* next;
+    };
+
+    struct Registry
+    {
+        pthread_mutex_t mutex;
+        std::vector<std::string> names;
+        std::vector<Unit> units;
+        Block* blocks;
+
+        Registry()
+        : blocks(0)
+        {
+            pthread_mutex_init(&mutex, 0);
+
+            static char const* builtinNames[NUM_BUILTIN] =
+            {
+                "RHS evaluations",
+                "Integrator steps",
+                "Transforms",
+                "Vector allocations",
+                "Buffer uploads"
+            };
+            for (int i = 0; i < NUM_BUILTIN; i++)
+            {
+                names.push_back(builtinNames[i]);
+                units.push_back(i == UPLOAD_BYTES ? BYTES : COUNT);
+            }
+        }
+    };
+
+    static Registry& registry()
+    {
+        static Registry r;
+        return r;
+    }
+
+    // The block of the calling thread, created on first use. Blocks of
+    // finished threads are kept so that the totals never decrease.
+    static inline Block* threadBlock()
+    {
+        static __thread Block* block = 0;
+        if (block == 0)
+        {
+            Block* b = new Block();
+            for (int i = 0; i < MAX_COUNTERS; i++)
+            {
+                b->values[i] = 0;
+            }
+
+            Registry& r = registry();
+            pthread_mutex_lock(&r.mutex);
+            b->next = r.blocks;
+            r.blocks = b;
+            pthread_mutex_unlock(&r.mutex);
+
+            block = b;
+        }
+        return block;
+    }
+};
+
+} // end namespace DTS
+
+#endif
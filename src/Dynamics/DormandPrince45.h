@@ -0,0 +1,404 @@
+#ifndef DORMANDPRINCE45_H
+#define DORMANDPRINCE45_H
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "Counters.h"
+#include "Integrator.h"
+
+/*
+    Dormand-Prince 5(4) with adaptive step size and dense output.
+
+    The integrator advances the fifth-order solution and uses the embedded
+    fourth-order solution to estimate the local error. Steps are accepted
+    when the error is within
+
+        absTolerance + relTolerance * |x|
+
+    in the root-mean-square norm over the components, and the next step
+    size is chosen by a PI controller. The last stage of an accepted step
+    is the first stage of the next one, so a step costs six evaluations of
+    the model.
+
+    The parameter "stepSize" keeps the meaning it has for "rk4": step()
+    returns the step vector over that interval, taking as many internal
+    steps as the tolerances require. The tolerances are given as powers of
+    ten so that the sliders in the experiment dialog span useful ranges.
+
+    integrate() computes a whole trajectory at points spaced "stepSize"
+    apart. The internal steps are as long as the tolerances allow, usually
+    much longer than "stepSize", and the points in between are filled in
+    with the fourth-order interpolant of Dormand and Prince. On smooth
+    stretches of an orbit this takes far fewer model evaluations than
+    "rk4" with a step for each point.
+*/
+class DormandPrince45 : public Integrator<double>
+{
+private:
+
+    /* Elements: */
+
+    int dimension;
+
+    // Current state, trial state and the seven stage derivatives
+    std::vector<Scalar> x;
+    std::vector<Scalar> xNew;
+    std::vector<Scalar> xTemp;
+    std::vector<Scalar> k;
+
+    // Arguments of the model, see DynamicalModel::evaluateState()
+    Vector stateTemp;
+    Vector valueTemp;
+
+    // Coefficients of the interpolant over the last accepted step
+    std::vector<Scalar> dense;
+
+    // Step size to try next and error of the last accepted step, for the
+    // PI controller. Both start over with every call, see restart().
+    Scalar nextStep;
+    Scalar lastError;
+
+    unsigned long evaluations;
+
+public:
+
+    /* Constructors and destructors: */
+
+    DormandPrince45(const Model& model, Scalar stepSize=.01)
+    : Integrator<double>(model),
+      dimension(model.getDimension()),
+      x(dimension),
+      xNew(dimension),
+      xTemp(dimension),
+      k(7 * dimension),
+      stateTemp(dimension),
+      valueTemp(dimension),
+      dense(5 * dimension),
+      nextStep(stepSize),
+      lastError(1e-4),
+      evaluations(0)
+    {
+        if (dimension == 0)
+        {
+            throw IntegratorException();
+        }
+
+        name = "dopri5";
+
+        addRealParameter( RealParameter("stepSize", stepSize, .0001, .2, .01, .0001) );
+        addRealParameter( RealParameter("absTolerance", -8, -12, -2, -8, .5) );
+        addRealParameter( RealParameter("relTolerance", -6, -12, -2, -6, .5) );
+    }
+
+    virtual ~DormandPrince45()
+    {
+    }
+
+    /* Methods: */
+
+    // Step vector over one "stepSize" interval
+    void step(Vector const& v, Vector& out)
+    {
+        Scalar interval = realParamValues[0];
+
+        DTS::Counters::add(DTS::Counters::STEPS);
+
+        restart();
+        for (int c = 0; c < dimension; c++)
+        {
+            x[c] = v[c];
+        }
+        evaluate(&x[0], stage(0));
+
+        Scalar time = 0;
+        Scalar h = std::min(nextStep, interval);
+        while (time < interval)
+        {
+            bool last = time + h >= interval;
+            if (last)
+            {
+                h = interval - time;
+            }
+
+            Scalar error = attempt(h);
+            if (accept(h, error))
+            {
+                time = last ? interval : time + h;
+                advance();
+                if (!isFinite())
+                {
+                    break;
+                }
+            }
+        }
+
+        for (int c = 0; c < dimension; c++)
+        {
+            out[c] = x[c] - v[c];
+        }
+    }
+
+    /*
+        Fill [first + 1, last) with the states "stepSize" apart following
+        *first. The iterators must refer to Vectors of the model dimension.
+    */
+    template <typename IteratorParam>
+    void integrate(IteratorParam first, IteratorParam last)
+    {
+        if (first == last)
+        {
+            return;
+        }
+
+        Scalar interval = realParamValues[0];
+
+        restart();
+        for (int c = 0; c < dimension; c++)
+        {
+            x[c] = (*first)[c];
+        }
+        evaluate(&x[0], stage(0));
+
+        Scalar time = 0;
+        unsigned int index = 1;
+        IteratorParam point = first;
+        ++point;
+        Scalar h = nextStep;
+
+        while (point != last)
+        {
+            Scalar error = attempt(h);
+            Scalar stepped = h;
+            if (!accept(h, error))
+            {
+                continue;
+            }
+
+            /* Emit all points within the accepted step: */
+            prepareDense(stepped);
+            Scalar end = time + stepped;
+            while (point != last && index * interval <= end)
+            {
+                interpolate((index * interval - time) / stepped, *point);
+                ++point;
+                ++index;
+                DTS::Counters::add(DTS::Counters::STEPS);
+            }
+
+            time = end;
+            advance();
+
+            if (!isFinite())
+            {
+                /* The orbit escaped, repeat the last point: */
+                for (; point != last; ++point)
+                {
+                    for (int c = 0; c < dimension; c++)
+                    {
+                        (*point)[c] = x[c];
+                    }
+                }
+            }
+        }
+    }
+
+    // Number of model evaluations since the integrator was created
+    unsigned long getEvaluations() const
+    {
+        return evaluations;
+    }
+
+private:
+
+    /*
+        Reset the step size controller. Every call starts from the same
+        guess, so its result depends only on the state passed in and not on
+        what the integrator computed before.
+    */
+    void restart()
+    {
+        nextStep = realParamValues[0];
+        lastError = 1e-4;
+    }
+
+    Scalar* stage(int i)
+    {
+        return &k[i * dimension];
+    }
+
+    void evaluate(Scalar const* in, Scalar* out)
+    {
+        model.evaluateState(in, out, stateTemp, valueTemp);
+        evaluations++;
+        DTS::Counters::add(DTS::Counters::EVALUATIONS);
+    }
+
+    void combine(Scalar h, int stages, Scalar const* a)
+    {
+        for (int c = 0; c < dimension; c++)
+        {
+            Scalar sum = 0;
+            for (int s = 0; s < stages; s++)
+            {
+                sum += a[s] * k[s * dimension + c];
+            }
+            xTemp[c] = x[c] + h * sum;
+        }
+    }
+
+    /*
+        Compute stages 2-7 and the fifth-order state for a step of size h
+        from x. Returns the scaled error norm, <= 1 if the step is within
+        the tolerances.
+    */
+    Scalar attempt(Scalar h)
+    {
+        static Scalar const a2[] = {1.0 / 5};
+        static Scalar const a3[] = {3.0 / 40, 9.0 / 40};
+        static Scalar const a4[] = {44.0 / 45, -56.0 / 15, 32.0 / 9};
+        static Scalar const a5[] = {19372.0 / 6561, -25360.0 / 2187,
+                                    64448.0 / 6561, -212.0 / 729};
+        static Scalar const a6[] = {9017.0 / 3168, -355.0 / 33, 46732.0 / 5247,
+                                    49.0 / 176, -5103.0 / 18656};
+        static Scalar const a7[] = {35.0 / 384, 0, 500.0 / 1113, 125.0 / 192,
+                                    -2187.0 / 6784, 11.0 / 84};
+        static Scalar const e[] = {71.0 / 57600, 0, -71.0 / 16695, 71.0 / 1920,
+                                   -17253.0 / 339200, 22.0 / 525, -1.0 / 40};
+
+        combine(h, 1, a2);
+        evaluate(&xTemp[0], stage(1));
+        combine(h, 2, a3);
+        evaluate(&xTemp[0], stage(2));
+        combine(h, 3, a4);
+        evaluate(&xTemp[0], stage(3));
+        combine(h, 4, a5);
+        evaluate(&xTemp[0], stage(4));
+        combine(h, 5, a6);
+        evaluate(&xTemp[0], stage(5));
+        combine(h, 6, a7);
+        xNew = xTemp;
+        evaluate(&xNew[0], stage(6));
+
+        Scalar absTolerance = std::pow(Scalar(10), realParamValues[1]);
+        Scalar relTolerance = std::pow(Scalar(10), realParamValues[2]);
+
+        Scalar sum = 0;
+        for (int c = 0; c < dimension; c++)
+        {
+            Scalar error = 0;
+            for (int s = 0; s < 7; s++)
+            {
+                error += e[s] * k[s * dimension + c];
+            }
+            error *= h;
+
+            Scalar scale = absTolerance +
+                relTolerance * std::max(std::fabs(x[c]), std::fabs(xNew[c]));
+            sum += (error / scale) * (error / scale);
+        }
+
+        return std::sqrt(sum / dimension);
+    }
+
+    /*
+        Decide on a step of size h with the given error and set h to the
+        size of the next attempt. Steps that are too small to make progress
+        are accepted regardless of the error.
+    */
+    bool accept(Scalar& h, Scalar error)
+    {
+        Scalar const safety = 0.9;
+        Scalar const minFactor = 0.2;
+        Scalar const maxFactor = 10.0;
+        Scalar const beta = 0.04;
+
+        Scalar minStep = 1e-10 * realParamValues[0];
+
+        if (!(error <= 1) && h > minStep)
+        {
+            /* Rejected, shrink without the integral term: */
+            Scalar factor = safety * std::pow(error, Scalar(-0.2));
+            if (!(factor > minFactor))
+            {
+                factor = minFactor;
+            }
+            h = std::max(h * factor, minStep);
+            return false;
+        }
+
+        Scalar factor = safety * std::pow(std::max(error, Scalar(1e-10)), Scalar(beta * 0.75 - 0.2)) *
+                        std::pow(lastError, beta);
+        factor = std::min(maxFactor, std::max(minFactor, factor));
+        lastError = std::max(error, Scalar(1e-4));
+
+        nextStep = h * factor;
+        h = nextStep;
+        return true;
+    }
+
+    // Move to the end of an accepted step, the last stage becomes the first
+    void advance()
+    {
+        x.swap(xNew);
+        std::copy(stage(6), stage(6) + dimension, stage(0));
+    }
+
+    bool isFinite() const
+    {
+        for (int c = 0; c < dimension; c++)
+        {
+            if (!(std::fabs(x[c]) <= 1e300))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Interpolant coefficients for the accepted step from x to xNew
+    void prepareDense(Scalar h)
+    {
+        static Scalar const d[] = {-12715105075.0 / 11282082432.0, 0,
+                                   87487479700.0 / 32700410799.0,
+                                   -10690763975.0 / 1880347072.0,
+                                   701980252875.0 / 199316789632.0,
+                                   -1453857185.0 / 822651844.0,
+                                   69997945.0 / 29380423.0};
+
+        Scalar* r = &dense[0];
+        for (int c = 0; c < dimension; c++)
+        {
+            Scalar difference = xNew[c] - x[c];
+            Scalar start = h * k[c] - difference;
+
+            Scalar sum = 0;
+            for (int s = 0; s < 7; s++)
+            {
+                sum += d[s] * k[s * dimension + c];
+            }
+
+            r[c] = x[c];
+            r[dimension + c] = difference;
+            r[2 * dimension + c] = start;
+            r[3 * dimension + c] = difference - h * k[6 * dimension + c] - start;
+            r[4 * dimension + c] = h * sum;
+        }
+    }
+
+    // State at fraction theta of the last accepted step
+    void interpolate(Scalar theta, Vector& out) const
+    {
+        Scalar const* r = &dense[0];
+        Scalar theta1 = Scalar(1) - theta;
+        for (int c = 0; c < dimension; c++)
+        {
+            out[c] = r[c] + theta * (r[dimension + c] + theta1 *
+                     (r[2 * dimension + c] + theta * (r[3 * dimension + c] +
+                      theta1 * r[4 * dimension + c])));
+        }
+    }
+};
+
+#endif
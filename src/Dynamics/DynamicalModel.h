@@ -19,7 +19,39 @@
 #include <Parameter.h>
 #include <Vector.h>
 
-template <typename ScalarParam>
+/*
+    One state of a structure-of-arrays batch (see
+    DynamicalModel::evaluateBatch()), component k at first[k * stride]. It
+    lets the static evaluate() of a model read and write the states of a
+    batch in place.
+*/
+template <typename Scalar>
+class StridedState
+{
+public:
+
+    StridedState(Scalar* first, size_t stride)
+    : first(first), stride(stride)
+    {
+    }
+
+    Scalar& operator[](size_t k) const
+    {
+        return first[k * stride];
+    }
+
+private:
+
+    Scalar* first;
+    size_t stride;
+};
+
+/*
+    The vector type defaults to the heap-backed DTS::Vector whose dimension is
+    chosen at runtime. Models whose dimension is known at compile time can
+    also be instantiated on DTS::FixedVector (see FixedExperiment.h).
+*/
+template <typename ScalarParam, typename VectorParam = DTS::Vector<ScalarParam> >
 class DynamicalModel : public ParameterClass<ScalarParam>,
                        public CoordinateClass<ScalarParam>
 {
@@ -27,7 +59,7 @@ class DynamicalModel : public ParameterClass<ScalarParam>,
 public:
 
     typedef ScalarParam Scalar;
-    typedef DTS::Vector<ScalarParam> Vector;
+    typedef VectorParam Vector;
 
     typedef typename CoordinateClass<ScalarParam>::Coordinate Coordinate;
     typedef typename ParameterClass<ScalarParam>::RealParameter Parameter;
@@ -52,6 +84,28 @@ public:
     Vector operator()(Vector const& x) const;
     virtual void operator()(Vector const& x, Vector & out) const = 0;
 
+    /*
+        Evaluate the differential equation for 'count' states at once.
+
+        The states are stored as structure-of-arrays: component k of state i
+        is at in[k * stride + i], with stride >= count. The output uses the
+        same layout and must not overlap the input. The default
+        implementation gathers each state into a Vector and calls
+        operator(); models with a static evaluate() derive from
+        EquationModel, which evaluates the states in place.
+    */
+    virtual void evaluateBatch(Scalar const* in, Scalar* out,
+                               size_t count, size_t stride) const;
+
+    /*
+        Evaluate a single state stored as consecutive scalars through
+        operator(), with 'p' and 'value' of the model's dimension provided
+        by the caller, so nothing is allocated. Integrators working on one
+        state at a time use it instead of a batch of one.
+    */
+    void evaluateState(Scalar const* in, Scalar* out,
+                       Vector& p, Vector& value) const;
+
     Vector getDefaultPoint() const;
     // centerPoint and radius corresponds to the attractor at the defaultPoint    
     Vector getCenterPoint() const; 
@@ -81,28 +135,71 @@ private:
  * Implementations
  */
 
-template <typename ScalarParam>
-DynamicalModel<ScalarParam>::DynamicalModel()
+template <typename ScalarParam, typename VectorParam>
+DynamicalModel<ScalarParam, VectorParam>::DynamicalModel()
     : version(0)
 {
 }
 
-template <typename ScalarParam>
-DynamicalModel<ScalarParam>::~DynamicalModel()
+template <typename ScalarParam, typename VectorParam>
+DynamicalModel<ScalarParam, VectorParam>::~DynamicalModel()
 {
 }
 
-template <typename ScalarParam>
+template <typename ScalarParam, typename VectorParam>
 inline
-DTS::Vector<ScalarParam> DynamicalModel<ScalarParam>::operator()(Vector const& p) const
+VectorParam DynamicalModel<ScalarParam, VectorParam>::operator()(Vector const& p) const
 {
-    Vector out(3);
+    Vector out(getDimension());
     this->operator()(p, out);
     return out;
 }
 
-template <typename ScalarParam>
-DTS::Vector<ScalarParam> DynamicalModel<ScalarParam>::getDefaultPoint() const
+template <typename ScalarParam, typename VectorParam>
+void DynamicalModel<ScalarParam, VectorParam>::evaluateBatch(Scalar const* in, Scalar* out,
+                                                             size_t count, size_t stride) const
+{
+    int dimension = getDimension();
+    Vector p(dimension);
+    Vector value(dimension);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        for (int k = 0; k < dimension; k++)
+        {
+            p[k] = in[k * stride + i];
+        }
+
+        this->operator()(p, value);
+
+        for (int k = 0; k < dimension; k++)
+        {
+            out[k * stride + i] = value[k];
+        }
+    }
+}
+
+template <typename ScalarParam, typename VectorParam>
+inline
+void DynamicalModel<ScalarParam, VectorParam>::evaluateState(Scalar const* in, Scalar* out,
+                                                             Vector& p, Vector& value) const
+{
+    int dimension = getDimension();
+    for (int k = 0; k < dimension; k++)
+    {
+        p[k] = in[k];
+    }
+
+    this->operator()(p, value);
+
+    for (int k = 0; k < dimension; k++)
+    {
+        out[k] = value[k];
+    }
+}
+
+template <typename ScalarParam, typename VectorParam>
+VectorParam DynamicalModel<ScalarParam, VectorParam>::getDefaultPoint() const
 {
     Vector out(getDimension());
     typename CoordinateClass<ScalarParam>::Coordinates const coords = this->getCoords();
@@ -114,14 +211,14 @@ DTS::Vector<ScalarParam> DynamicalModel<ScalarParam>::getDefaultPoint() const
 }
 
 
-template <typename ScalarParam>
-DTS::Vector<ScalarParam> DynamicalModel<ScalarParam>::getCenterPoint() const
+template <typename ScalarParam, typename VectorParam>
+VectorParam DynamicalModel<ScalarParam, VectorParam>::getCenterPoint() const
 {
     return centerPoint;
 }
 
-template <typename ScalarParam>
-ScalarParam DynamicalModel<ScalarParam>::getRadius() const
+template <typename ScalarParam, typename VectorParam>
+ScalarParam DynamicalModel<ScalarParam, VectorParam>::getRadius() const
 {
     // return the largest non-infinite radius from each coordinate
     
@@ -153,9 +250,9 @@ ScalarParam DynamicalModel<ScalarParam>::getRadius() const
     return radius;
 }
 
-template <typename ScalarParam>
+template <typename ScalarParam, typename VectorParam>
 inline
-int DynamicalModel<ScalarParam>::getDimension() const
+int DynamicalModel<ScalarParam, VectorParam>::getDimension() const
 {
     // getCoords() is a non-dependent name.
     // So we must resolve it now by explictly using 'this'.
@@ -164,25 +261,71 @@ int DynamicalModel<ScalarParam>::getDimension() const
 }
 
 
-template <typename ScalarParam>
+template <typename ScalarParam, typename VectorParam>
 inline
-std::string const& DynamicalModel<ScalarParam>::getName() const
+std::string const& DynamicalModel<ScalarParam, VectorParam>::getName() const
 {
     return name;
 }
 
-template <typename ScalarParam>
+template <typename ScalarParam, typename VectorParam>
 inline
-unsigned int const& DynamicalModel<ScalarParam>::getVersion() const
+unsigned int const& DynamicalModel<ScalarParam, VectorParam>::getVersion() const
 {
     return version;
 }
 
-template <typename ScalarParam>
+template <typename ScalarParam, typename VectorParam>
 inline
-unsigned int DynamicalModel<ScalarParam>::updateVersion()
+unsigned int DynamicalModel<ScalarParam, VectorParam>::updateVersion()
 {
     return ++version;
 }
 
+
+/*
+    Base of the models whose equations are a static member template
+
+        template <typename In, typename Out>
+        static void evaluate(In const& p, Out& out, double const* realParamValues);
+
+    of Model, written once for any indexable state: the vectors, the
+    StridedState of a batch and the SIMD packs of SimdRungeKutta4. It
+    implements operator() and evaluateBatch() with it, so a model only
+    declares its coordinates, parameters and equations.
+*/
+template <typename Model, typename ScalarParam, typename VectorParam = DTS::Vector<ScalarParam> >
+class EquationModel : public DynamicalModel<ScalarParam, VectorParam>
+{
+public:
+
+    typedef DynamicalModel<ScalarParam, VectorParam> Base;
+    typedef typename Base::Scalar Scalar;
+    typedef typename Base::Vector Vector;
+
+    virtual void operator()(Vector const& p, Vector & out) const
+    {
+        Model::evaluate(p, out, parameters());
+    }
+
+    virtual void evaluateBatch(Scalar const* in, Scalar* out,
+                               size_t count, size_t stride) const
+    {
+        double const* params = parameters();
+        for (size_t i = 0; i < count; i++)
+        {
+            StridedState<Scalar const> p(in + i, stride);
+            StridedState<Scalar> value(out + i, stride);
+            Model::evaluate(p, value, params);
+        }
+    }
+
+protected:
+
+    double const* parameters() const
+    {
+        return this->realParamValues.empty() ? 0 : &this->realParamValues[0];
+    }
+};
+
 #endif
@@ -2,6 +2,7 @@
 #define DTS_EXPERIMENT
 
 #include <exception>
+#include <vector>
 
 #include <DynamicalModel.h>
 #include <Integrator.h>
@@ -101,6 +102,33 @@ public:
     typedef std::map< std::string, Integrator<ScalarParam>* > IntegratorMap;
     typedef std::map< std::string, Transformer<ScalarParam>* > TransformerMap;    
     typedef typename DynamicalModel<ScalarParam>::Vector Vector;
+
+    /*
+        Function object advancing a single state, stored as 'dimension'
+        consecutive scalars, in place by one step of the integrator it was
+        made for. Experiments register fused steppers with addStepper(),
+        where the model equations are inlined into the integrator stages
+        (see FusedRungeKutta4). Fused steppers hold no intermediate
+        results, so one may be called from several threads at once. The
+        stepper getStepper() returns for an integrator without one goes
+        through stepState(), which uses the scratch vectors of the
+        experiment and of the integrator: only one thread at a time may
+        call it, other threads step a clone() of the experiment.
+    */
+    class Stepper
+    {
+    public:
+        virtual ~Stepper()
+        {
+        }
+
+        virtual void operator()(Scalar* state) = 0;
+    };
+
+    typedef std::map< Integrator<ScalarParam> const*, Stepper* > StepperMap;
+
+    // Function creating a new instance, e.g. the Factory entry of the experiment
+    typedef Experiment* (*Maker)();
     
     Experiment();
     virtual ~Experiment();
@@ -110,11 +138,56 @@ public:
     
     void addIntegrator(Integrator<ScalarParam>*);
     void addTransformer(Transformer<ScalarParam>*);   
+
+    // A registered integrator other than the current one, 0 if unknown.
+    Integrator<ScalarParam>* getIntegrator(std::string const&) const;
+    std::vector<std::string> getIntegratorNames() const;
+
+    /*
+        Fused stepper for a registered integrator; the experiment takes
+        ownership. getStepper() returns the one for the current integrator,
+        or one calling stepState() if there is none. It stays valid until
+        the integrator is changed.
+    */
+    void addStepper(Integrator<ScalarParam> const*, Stepper*);
+    Stepper& getStepper();
+
+    /*
+        An independent instance with the parameter values, integrator and
+        transformer of this one, for work on another thread. Returns 0
+        unless the maker was set by whoever created the experiment.
+    */
+    void setMaker(Maker);
+    Maker getMaker() const;
+    Experiment* clone() const;
+
+    /*
+        Copy the parameter values of the model, integrators and transformers
+        of another instance of the same experiment, and select the same
+        integrator and transformer.
+    */
+    void copyParamValues(Experiment const&);
     
     bool isOutdated();
     unsigned int updateVersion();
     unsigned int const & getVersion() const;
 
+    /*
+        Single states stored as 'dimension' consecutive scalars, without a
+        heap-allocated Vector. stepState() advances the state in place by
+        one integrator step, transformState() writes the three display
+        coordinates and invTransformState() is its inverse. Whole particle
+        systems should use Integrator::stepBatch() and
+        Transformer::transformBatch() instead.
+
+        The default implementations copy through the generic Vector
+        interface. FixedExperiment overrides them for models whose dimension
+        is known at compile time.
+    */
+    virtual void stepState(Scalar* state);
+    virtual void transformState(Scalar const* state, Scalar* display);
+    virtual void invTransformState(Scalar const* display, Scalar* state);
+
     // We use pointers so we can more easily change these at runtime.
     // However, the dynamical model should be treated as a const pointer.
     // Changing where it points is bad since the integrator and transformer
@@ -136,11 +209,40 @@ protected:
      */
     IntegratorMap integrators;
     TransformerMap transformers;  
+    StepperMap steppers;
+    Maker maker;
       
     unsigned int version;
     unsigned int modelVersion;
     unsigned int integratorVersion;    
     unsigned int transformerVersion;    
+
+    // Scratch vectors for the generic state methods
+    Vector stateTemp;
+    Vector stepTemp;
+    Vector displayTemp;
+
+private:
+
+    // The virtual path, for integrators without a fused stepper; not reentrant
+    class GenericStepper : public Stepper
+    {
+    public:
+        GenericStepper(Experiment& experiment)
+        : experiment(experiment)
+        {
+        }
+
+        void operator()(Scalar* state)
+        {
+            experiment.stepState(state);
+        }
+
+    private:
+        Experiment& experiment;
+    };
+
+    GenericStepper genericStepper;
 };
 
 template <typename ScalarParam>
@@ -148,10 +250,15 @@ Experiment<ScalarParam>::Experiment()
  : model(0),
    integrator(0),
    transformer(0),
+   maker(0),
    version(0),
    modelVersion(0),
    integratorVersion(0),
-   transformerVersion(0)
+   transformerVersion(0),
+   stateTemp(0),
+   stepTemp(0),
+   displayTemp(3),
+   genericStepper(*this)
 {
 }
 
@@ -171,6 +278,12 @@ Experiment<ScalarParam>::~Experiment()
     {
         delete it2->second;
     }
+
+    typename StepperMap::iterator it3;
+    for ( it3 = steppers.begin(); it3 != steppers.end(); it3++ )
+    {
+        delete it3->second;
+    }
 }
 
 template <typename ScalarParam>
@@ -188,6 +301,105 @@ void Experiment<ScalarParam>::setIntegrator(std::string const& name)
     }
 }
 
+template <typename ScalarParam>
+Integrator<ScalarParam>* Experiment<ScalarParam>::getIntegrator(std::string const& name) const
+{
+    typename IntegratorMap::const_iterator it = integrators.find(name);
+
+    if ( it == integrators.end() ) return 0;
+
+    return it->second;
+}
+
+template <typename ScalarParam>
+std::vector<std::string> Experiment<ScalarParam>::getIntegratorNames() const
+{
+    std::vector<std::string> names;
+
+    typename IntegratorMap::const_iterator it;
+    for ( it = integrators.begin(); it != integrators.end(); it++ )
+    {
+        names.push_back(it->first);
+    }
+
+    return names;
+}
+
+template <typename ScalarParam>
+void Experiment<ScalarParam>::addStepper(Integrator<ScalarParam> const* integrator, Stepper* stepper)
+{
+    typename StepperMap::iterator it = steppers.find(integrator);
+
+    if ( it != steppers.end() )
+    {
+        delete it->second;
+    }
+    steppers[integrator] = stepper;
+}
+
+template <typename ScalarParam>
+inline
+typename Experiment<ScalarParam>::Stepper& Experiment<ScalarParam>::getStepper()
+{
+    typename StepperMap::iterator it = steppers.find(integrator);
+
+    if ( it == steppers.end() ) return genericStepper;
+
+    return *it->second;
+}
+
+template <typename ScalarParam>
+void Experiment<ScalarParam>::setMaker(Maker m)
+{
+    maker = m;
+}
+
+template <typename ScalarParam>
+typename Experiment<ScalarParam>::Maker Experiment<ScalarParam>::getMaker() const
+{
+    return maker;
+}
+
+template <typename ScalarParam>
+Experiment<ScalarParam>* Experiment<ScalarParam>::clone() const
+{
+    if ( maker == 0 ) return 0;
+
+    Experiment* copy = maker();
+    copy->setMaker(maker);
+    copy->copyParamValues(*this);
+    return copy;
+}
+
+template <typename ScalarParam>
+void Experiment<ScalarParam>::copyParamValues(Experiment const& other)
+{
+    model->copyParamValues(*other.model);
+
+    typename IntegratorMap::const_iterator it1;
+    for ( it1 = other.integrators.begin(); it1 != other.integrators.end(); it1++ )
+    {
+        typename IntegratorMap::iterator it = integrators.find(it1->first);
+        if ( it != integrators.end() )
+        {
+            it->second->copyParamValues(*it1->second);
+        }
+    }
+
+    typename TransformerMap::const_iterator it2;
+    for ( it2 = other.transformers.begin(); it2 != other.transformers.end(); it2++ )
+    {
+        typename TransformerMap::iterator it = transformers.find(it2->first);
+        if ( it != transformers.end() )
+        {
+            it->second->copyParamValues(*it2->second);
+        }
+    }
+
+    setIntegrator(other.integrator->getName());
+    setTransformer(other.transformer->getName());
+}
+
 template <typename ScalarParam>
 void Experiment<ScalarParam>::setTransformer(std::string const& name)
 {
@@ -250,6 +462,12 @@ void Experiment<ScalarParam>::addIntegrator(Integrator<ScalarParam> *integrator)
             if ( it->first == name )
             {
                 // Case 4
+                typename StepperMap::iterator stepper = steppers.find(it->second);
+                if ( stepper != steppers.end() )
+                {
+                    delete stepper->second;
+                    steppers.erase(stepper);
+                }
                 delete it->second;
             }
         }
@@ -339,6 +557,67 @@ unsigned int const& Experiment<ScalarParam>::getVersion() const
     return version;
 }
 
+template <typename ScalarParam>
+void Experiment<ScalarParam>::stepState(Scalar* state)
+{
+    int dimension = model->getDimension();
+    if (stateTemp.getDimension() != dimension)
+    {
+        stateTemp.setDimension(dimension);
+        stepTemp.setDimension(dimension);
+    }
+
+    for (int i = 0; i < dimension; i++)
+    {
+        stateTemp[i] = state[i];
+    }
+    integrator->step(stateTemp, stepTemp);
+    for (int i = 0; i < dimension; i++)
+    {
+        state[i] += stepTemp[i];
+    }
+}
+
+template <typename ScalarParam>
+void Experiment<ScalarParam>::transformState(Scalar const* state, Scalar* display)
+{
+    int dimension = model->getDimension();
+    if (stateTemp.getDimension() != dimension)
+    {
+        stateTemp.setDimension(dimension);
+        stepTemp.setDimension(dimension);
+    }
+
+    for (int i = 0; i < dimension; i++)
+    {
+        stateTemp[i] = state[i];
+    }
+    transformer->transform(stateTemp, displayTemp);
+    display[0] = displayTemp[0];
+    display[1] = displayTemp[1];
+    display[2] = displayTemp[2];
+}
+
+template <typename ScalarParam>
+void Experiment<ScalarParam>::invTransformState(Scalar const* display, Scalar* state)
+{
+    int dimension = model->getDimension();
+    if (stateTemp.getDimension() != dimension)
+    {
+        stateTemp.setDimension(dimension);
+        stepTemp.setDimension(dimension);
+    }
+
+    displayTemp[0] = display[0];
+    displayTemp[1] = display[1];
+    displayTemp[2] = display[2];
+    transformer->invTransform(displayTemp, stateTemp);
+    for (int i = 0; i < dimension; i++)
+    {
+        state[i] = stateTemp[i];
+    }
+}
+
 
 
 #endif
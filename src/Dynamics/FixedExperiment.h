@@ -0,0 +1,189 @@
+#ifndef DTS_FIXED_EXPERIMENT
+#define DTS_FIXED_EXPERIMENT
+
+#include "Experiment.h"
+#include "FixedVector.h"
+#include "FixedRungeKutta4.h"
+#include "RungeKutta4.h"
+#include "ProjectionTransformer.h"
+
+/** Base class for experiments whose model dimension is known at compile time.
+ *
+ * The model is given as a class template taking the vector type, e.g.
+ * LorenzModel. FixedExperiment creates the usual generic instance of it
+ * (this->model), which is what the dialogs and the Experiment interface
+ * operate on, plus a second instance on DTS::FixedVector together with a
+ * FixedRungeKutta4 and a fixed-dimension ProjectionTransformer.
+ *
+ * The state methods (stepState etc.) use the fixed-dimension instances
+ * whenever the generic integrator/transformer currently selected is the
+ * rk4/projection one, so the per-particle work involves no heap vectors.
+ * Parameter values are copied from the generic instances whenever their
+ * versions change. Any other integrator or transformer goes through the
+ * generic path of Experiment.
+ *
+ * \code
+class LorenzExperiment : public FixedExperiment<LorenzModel, 4>
+{
+public:
+    LorenzExperiment()
+    {
+        addIntegrator( new RungeKutta4(*model, .01) );
+        setIntegrator("rk4");
+        ...
+    }
+};
+ * \endcode
+ */
+template <template <typename> class ModelParam, int DimensionParam>
+class FixedExperiment : public Experiment<double>
+{
+public:
+    typedef DTS::FixedVector<double, DimensionParam> FixedVector;
+    typedef ModelParam<DTS::Vector<double> > GenericModel;
+    typedef ModelParam<FixedVector> FixedModel;
+    typedef FixedRungeKutta4<double, DimensionParam> FixedIntegrator;
+    typedef ProjectionTransformer<double, FixedVector> FixedTransformer;
+
+    FixedExperiment();
+    virtual ~FixedExperiment();
+
+    virtual void stepState(Scalar* state);
+    virtual void transformState(Scalar const* state, Scalar* display);
+    virtual void invTransformState(Scalar const* display, Scalar* state);
+
+protected:
+    FixedModel fixedModel;
+    FixedIntegrator fixedIntegrator;
+    FixedTransformer fixedTransformer;
+
+    /* Copy parameter values to the fixed instances if they are outdated. */
+    bool synchronizeIntegrator();
+    bool synchronizeTransformer();
+
+private:
+    unsigned int fixedModelVersion;
+    Integrator<double> const* syncedIntegrator;
+    unsigned int fixedIntegratorVersion;
+    Transformer<double> const* syncedTransformer;
+    unsigned int fixedTransformerVersion;
+};
+
+template <template <typename> class ModelParam, int DimensionParam>
+FixedExperiment<ModelParam, DimensionParam>::FixedExperiment()
+ : Experiment<double>(),
+   fixedModel(),
+   fixedIntegrator(fixedModel),
+   fixedTransformer(fixedModel),
+   fixedModelVersion(0),
+   syncedIntegrator(0),
+   fixedIntegratorVersion(0),
+   syncedTransformer(0),
+   fixedTransformerVersion(0)
+{
+    model = new GenericModel();
+    fixedModelVersion = model->getVersion();
+}
+
+template <template <typename> class ModelParam, int DimensionParam>
+FixedExperiment<ModelParam, DimensionParam>::~FixedExperiment()
+{
+}
+
+template <template <typename> class ModelParam, int DimensionParam>
+bool FixedExperiment<ModelParam, DimensionParam>::synchronizeIntegrator()
+{
+    if ( fixedModelVersion != model->getVersion() )
+    {
+        fixedModel.copyParamValues(*model);
+        fixedModelVersion = model->getVersion();
+    }
+
+    if ( syncedIntegrator != integrator ||
+         fixedIntegratorVersion != integrator->getVersion() )
+    {
+        if ( dynamic_cast<RungeKutta4*>(integrator) == 0 )
+        {
+            return false;
+        }
+        fixedIntegrator.copyParamValues(*integrator);
+        syncedIntegrator = integrator;
+        fixedIntegratorVersion = integrator->getVersion();
+    }
+    return true;
+}
+
+template <template <typename> class ModelParam, int DimensionParam>
+bool FixedExperiment<ModelParam, DimensionParam>::synchronizeTransformer()
+{
+    if ( syncedTransformer != transformer ||
+         fixedTransformerVersion != transformer->getVersion() )
+    {
+        if ( dynamic_cast<ProjectionTransformer<double>*>(transformer) == 0 )
+        {
+            return false;
+        }
+        fixedTransformer.copyParamValues(*transformer);
+        syncedTransformer = transformer;
+        fixedTransformerVersion = transformer->getVersion();
+    }
+    return true;
+}
+
+template <template <typename> class ModelParam, int DimensionParam>
+void FixedExperiment<ModelParam, DimensionParam>::stepState(Scalar* state)
+{
+    if ( !synchronizeIntegrator() )
+    {
+        Experiment<double>::stepState(state);
+        return;
+    }
+
+    FixedVector v(state);
+    FixedVector out;
+    fixedIntegrator.step(v, out);
+    for (int i = 0; i < DimensionParam; i++)
+    {
+        state[i] += out[i];
+    }
+}
+
+template <template <typename> class ModelParam, int DimensionParam>
+void FixedExperiment<ModelParam, DimensionParam>::transformState(Scalar const* state, Scalar* display)
+{
+    if ( !synchronizeTransformer() )
+    {
+        Experiment<double>::transformState(state, display);
+        return;
+    }
+
+    FixedVector v(state);
+    Geometry::Vector<double, 3> out;
+    fixedTransformer.transform(v, out);
+    display[0] = out[0];
+    display[1] = out[1];
+    display[2] = out[2];
+}
+
+template <template <typename> class ModelParam, int DimensionParam>
+void FixedExperiment<ModelParam, DimensionParam>::invTransformState(Scalar const* display, Scalar* state)
+{
+    if ( !synchronizeTransformer() )
+    {
+        Experiment<double>::invTransformState(display, state);
+        return;
+    }
+
+    Geometry::Vector<double, 3> v;
+    v[0] = display[0];
+    v[1] = display[1];
+    v[2] = display[2];
+    FixedVector out;
+    fixedTransformer.invTransform(v, out);
+    for (int i = 0; i < DimensionParam; i++)
+    {
+        state[i] = out[i];
+    }
+}
+
+#endif
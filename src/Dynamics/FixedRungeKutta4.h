@@ -0,0 +1,109 @@
+#ifndef FIXED_RUNGEKUTTA4_H
+#define FIXED_RUNGEKUTTA4_H
+
+#include "FixedVector.h"
+#include "Integrator.h"
+#include "RungeKutta4Batch.h"
+
+/*
+    Runge-Kutta 4 on a state vector of compile-time dimension.
+
+    This is the same scheme as RungeKutta4::step_nd, but since the dimension
+    is a template parameter the component loops are fully unrolled by the
+    compiler and the intermediate vectors live inline in the integrator.
+    There is therefore no need for the generated step_1d ... step_5d
+    functions or for dispatching through a member function pointer.
+*/
+template <typename ScalarParam, int DimensionParam>
+class FixedRungeKutta4 : public Integrator<ScalarParam, DTS::FixedVector<ScalarParam, DimensionParam> >
+{
+public:
+
+    typedef Integrator<ScalarParam, DTS::FixedVector<ScalarParam, DimensionParam> > Base;
+    typedef typename Base::Model Model;
+    typedef typename Base::Scalar Scalar;
+    typedef typename Base::Vector Vector;
+    typedef typename Base::Workspace Workspace;
+    typedef typename Base::RealParameter RealParameter;
+
+private:
+
+    // Vectors for intermediate calculations
+    Vector v0;
+    Vector v1;
+    Vector v2;
+    Vector vTemp;
+
+public:
+
+    /* Constructors and destructors: */
+
+    FixedRungeKutta4(const Model& model, Scalar stepSize=.01)
+    : Base(model)
+    {
+        this->name = "rk4";
+
+        this->addRealParameter( RealParameter("stepSize", stepSize, .0001, .2, .01, .0001) );
+    }
+
+    virtual ~FixedRungeKutta4()
+    {
+    }
+
+    /* Methods: */
+
+    using Base::step;
+
+    void step(Vector const& v, Vector &out)
+    {
+        DTS::Counters::add(DTS::Counters::STEPS);
+        DTS::Counters::add(DTS::Counters::EVALUATIONS, 4);
+
+        Scalar stepSize = this->realParamValues[0];
+
+        /* Calculate first half-step vector: */
+        this->model(v, v0);
+        v0 *= stepSize * Scalar(0.5);
+
+        /* Calculate second half-step vector: */
+        vTemp = v;
+        vTemp += v0;
+        this->model(vTemp, v1);
+        v1 *= stepSize * Scalar(0.5);
+
+        /* Calculate third half-step vector: */
+        vTemp = v;
+        vTemp += v1;
+        this->model(vTemp, v2);
+        v2 *= stepSize;
+
+        /* Calculate fourth half-step vector: */
+        vTemp = v;
+        vTemp += v2;
+        this->model(vTemp, out);
+        out *= stepSize;
+
+        /* Calculate step vector: */
+        v1 *= Scalar(2);
+        v2 += v1;
+        v2 += v0;
+        v2 *= Scalar(2);
+        out += v2;
+        out /= Scalar(6);
+    }
+
+    using Base::stepBatch;
+
+    void stepBatch(Scalar const* in, Scalar* out, size_t count, size_t stride,
+                   Workspace& work)
+    {
+        rungeKutta4StepBatch(this->model, this->realParamValues[0], in, out, count, stride, work);
+    }
+
+    bool isReentrant() const
+    {
+        return true;
+    }
+};
+
+#endif
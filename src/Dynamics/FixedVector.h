@@ -0,0 +1,226 @@
+#ifndef DTS_FIXED_VECTOR_H
+#define DTS_FIXED_VECTOR_H
+
+#include <iostream>
+
+namespace DTS {
+
+/**
+ * A state vector whose dimension is fixed at compile time.
+ *
+ * FixedVector mirrors the interface of DTS::Vector, so DynamicalModel,
+ * Integrator and Transformer can be instantiated on it, but it stores its
+ * components inline. There is no heap allocation, no virtual destructor and
+ * no allocation counter: the class is trivially copyable, so arrays of
+ * FixedVector are a single contiguous block of scalars.
+ *
+ * setDimension() and the dimension argument of the constructor exist only
+ * for source compatibility with DTS::Vector; the dimension is always N.
+ */
+template <typename ScalarParam, int DimensionParam>
+class FixedVector
+{
+    public:
+    typedef ScalarParam Scalar;
+    static const int dimension = DimensionParam;
+
+    protected:
+    ScalarParam components[DimensionParam];
+
+    /* Constructors */
+    public:
+    FixedVector(void)
+    {
+    }
+
+    explicit FixedVector(int const, ScalarParam const& value = ScalarParam())
+    {
+        for(int i = 0; i < DimensionParam; ++i)
+        {
+            components[i] = value;
+        }
+    }
+
+    explicit FixedVector(ScalarParam const* values)
+    {
+        for(int i = 0; i < DimensionParam; ++i)
+        {
+            components[i] = values[i];
+        }
+    }
+
+    /* Generic Methods */
+    int getDimension(void) const
+    {
+        return DimensionParam;
+    }
+
+    void setDimension(int)
+    {
+    }
+
+    ScalarParam const* getComponents(void) const
+    {
+        return components;
+    }
+
+    ScalarParam* getComponents(void)
+    {
+        return components;
+    }
+
+    Scalar operator[](int index) const
+    {
+        return components[index];
+    }
+
+    Scalar& operator[](int index)
+    {
+        return components[index];
+    }
+
+    /* Math Methods */
+    FixedVector operator+(void) const
+    {
+        return *this;
+    }
+
+    FixedVector operator-(void) const
+    {
+        FixedVector result;
+        for(int i = 0; i < DimensionParam; ++i)
+        {
+            result.components[i] = -components[i];
+        }
+        return result;
+    }
+
+    FixedVector& operator+=(FixedVector const& other)
+    {
+        for(int i = 0; i < DimensionParam; ++i)
+        {
+            components[i] += other.components[i];
+        }
+        return *this;
+    }
+
+    FixedVector& operator-=(FixedVector const& other)
+    {
+        for(int i = 0; i < DimensionParam; ++i)
+        {
+            components[i] -= other.components[i];
+        }
+        return *this;
+    }
+
+    FixedVector& operator*=(ScalarParam scalar)
+    {
+        for(int i = 0; i < DimensionParam; ++i)
+        {
+            components[i] *= scalar;
+        }
+        return *this;
+    }
+
+    FixedVector& operator/=(ScalarParam scalar)
+    {
+        for(int i = 0; i < DimensionParam; ++i)
+        {
+            components[i] /= scalar;
+        }
+        return *this;
+    }
+};
+
+template <typename ScalarParam, int DimensionParam>
+const int FixedVector<ScalarParam, DimensionParam>::dimension;
+
+
+/************************************
+ * Operations on FixedVector objects *
+ ************************************/
+
+// ostream operator
+template <typename ScalarParam, int DimensionParam>
+std::ostream& operator<<(std::ostream& stream, const FixedVector<ScalarParam, DimensionParam>& v)
+{
+	stream << "(";
+	for (int i = 0; i < DimensionParam; ++i)
+	{
+		stream << v[i];
+		if (i != DimensionParam - 1)
+		{
+			stream << ", ";
+		}
+	}
+	stream << ")";
+	return stream;
+}
+
+// Equality operator
+template <typename ScalarParam, int DimensionParam>
+inline bool operator==(const FixedVector<ScalarParam, DimensionParam>& v1, const FixedVector<ScalarParam, DimensionParam>& v2)
+{
+	bool result = true;
+	for(int i = 0; i < DimensionParam; ++i)
+	{
+		result &= v1[i] == v2[i];
+	}
+	return result;
+}
+
+// Inequality operator
+template <typename ScalarParam, int DimensionParam>
+inline bool operator!=(const FixedVector<ScalarParam, DimensionParam>& v1, const FixedVector<ScalarParam, DimensionParam>& v2)
+{
+	return !(v1 == v2);
+}
+
+// Addition
+template <typename ScalarParam, int DimensionParam>
+inline FixedVector<ScalarParam, DimensionParam> operator+(const FixedVector<ScalarParam, DimensionParam>& v1, const FixedVector<ScalarParam, DimensionParam>& v2)
+{
+	FixedVector<ScalarParam, DimensionParam> result(v1);
+	result += v2;
+	return result;
+}
+
+// Subtraction
+template <typename ScalarParam, int DimensionParam>
+inline FixedVector<ScalarParam, DimensionParam> operator-(const FixedVector<ScalarParam, DimensionParam>& v1, const FixedVector<ScalarParam, DimensionParam>& v2)
+{
+	FixedVector<ScalarParam, DimensionParam> result(v1);
+	result -= v2;
+	return result;
+}
+
+// Scalar multiplication (from the right)
+template <typename ScalarParam, int DimensionParam>
+inline FixedVector<ScalarParam, DimensionParam> operator*(const FixedVector<ScalarParam, DimensionParam>& v, ScalarParam scalar)
+{
+	FixedVector<ScalarParam, DimensionParam> result(v);
+	result *= scalar;
+	return result;
+}
+
+// Scalar multiplication (from the left)
+template <typename ScalarParam, int DimensionParam>
+inline FixedVector<ScalarParam, DimensionParam> operator*(ScalarParam scalar, const FixedVector<ScalarParam, DimensionParam>& v)
+{
+	FixedVector<ScalarParam, DimensionParam> result(v);
+	result *= scalar;
+	return result;
+}
+
+// Scalar division (only from the right)
+template <typename ScalarParam, int DimensionParam>
+inline FixedVector<ScalarParam, DimensionParam> operator/(const FixedVector<ScalarParam, DimensionParam>& v, ScalarParam scalar)
+{
+	FixedVector<ScalarParam, DimensionParam> result(v);
+	result /= scalar;
+	return result;
+}
+
+} // end namespace DTS
+
+#endif
@@ -0,0 +1,97 @@
+#ifndef FUSED_RUNGEKUTTA4_H
+#define FUSED_RUNGEKUTTA4_H
+
+#include "Experiment.h"
+
+/*
+    Runge-Kutta 4 with the model equations compiled into the stages.
+
+    Going through Integrator::step(), a step makes a virtual call to the
+    integrator and four virtual calls to the model, and none of them can be
+    inlined. FusedRungeKutta4 calls the static evaluate() function of the
+    model class instead (see SimdRungeKutta4 for the requirements), so the
+    whole step is one function working on values in registers. The
+    parameters and the step size are read from the generic model and
+    integrator on every call, so the stepper always follows the sliders.
+
+    Experiments create one for their "rk4" integrator:
+
+        RungeKutta4* rk4 = new SimdRungeKutta4<Lorenz, 4>(*model, .01);
+        addIntegrator( rk4 );
+        addStepper( rk4, new FusedRungeKutta4<Lorenz, 4>(*model, *rk4) );
+
+    Models without a static evaluate() use the virtual path of
+    Experiment::stepState().
+*/
+template <typename ModelParam, int DimensionParam>
+class FusedRungeKutta4 : public Experiment<double>::Stepper
+{
+public:
+
+    typedef double Scalar;
+
+    FusedRungeKutta4(DynamicalModel<double> const& model,
+                     Integrator<double> const& integrator)
+    : model(model),
+      integrator(integrator)
+    {
+    }
+
+    void operator()(Scalar* state)
+    {
+        DTS::Counters::add(DTS::Counters::STEPS);
+        DTS::Counters::add(DTS::Counters::EVALUATIONS, 4);
+
+        step(&model.getRealParamValues()[0],
+             integrator.getRealParamValues()[0], state);
+    }
+
+    // One step of 'state' in place
+    static inline void step(double const* params, Scalar stepSize, Scalar* state)
+    {
+        Scalar const halfStep = stepSize * Scalar(0.5);
+        Scalar const sixthStep = stepSize / Scalar(6);
+
+        Scalar k[DimensionParam];
+        Scalar t[DimensionParam];
+        Scalar sum[DimensionParam];
+
+        /* First stage: */
+        ModelParam::evaluate(state, k, params);
+        for (int c = 0; c < DimensionParam; c++)
+        {
+            sum[c] = k[c];
+            t[c] = state[c] + halfStep * k[c];
+        }
+
+        /* Second stage: */
+        ModelParam::evaluate(t, k, params);
+        for (int c = 0; c < DimensionParam; c++)
+        {
+            sum[c] += Scalar(2) * k[c];
+            t[c] = state[c] + halfStep * k[c];
+        }
+
+        /* Third stage: */
+        ModelParam::evaluate(t, k, params);
+        for (int c = 0; c < DimensionParam; c++)
+        {
+            sum[c] += Scalar(2) * k[c];
+            t[c] = state[c] + stepSize * k[c];
+        }
+
+        /* Fourth stage and new state: */
+        ModelParam::evaluate(t, k, params);
+        for (int c = 0; c < DimensionParam; c++)
+        {
+            state[c] += sixthStep * (sum[c] + k[c]);
+        }
+    }
+
+private:
+
+    DynamicalModel<double> const& model;
+    Integrator<double> const& integrator;
+};
+
+#endif
@@ -4,6 +4,7 @@
 #include <exception>
 #include <string>
 #include <iostream>
+#include <vector>
 
 // Project includes
 //
@@ -27,24 +28,47 @@ class IntegratorException: public std::exception
 template <typename ScalarParam>
 class Experiment;
 
-template <typename ScalarParam>
+template <typename ScalarParam, typename VectorParam = DTS::Vector<ScalarParam> >
 class Integrator : public ParameterClass<ScalarParam>
 {
 
 friend class Experiment<ScalarParam>;
 
 public:
-    typedef DynamicalModel<ScalarParam> Model;
+    typedef DynamicalModel<ScalarParam, VectorParam> Model;
     typedef typename Model::Parameter Parameter;
     typedef typename Model::Scalar Scalar;
     typedef typename Model::Vector Vector;
 
+    // Scratch space for stepBatch(), one per calling thread
+    typedef std::vector<Scalar> Workspace;
+
     Integrator(Model const& model);
     virtual ~Integrator();
 
     Vector step(Vector const& v);
     virtual void step(Vector const& v, Vector & out) = 0;
 
+    /*
+        Compute the step vectors for 'count' states at once.
+
+        Both arrays are structure-of-arrays: component k of state i is at
+        in[k * stride + i], with stride >= count. As with step(), 'out'
+        receives the step vector, not the new state, and must not overlap
+        'in'. The default implementation calls step() for each state.
+
+        The first form uses a workspace owned by the integrator. The second
+        keeps all intermediate results in 'work'; if isReentrant() returns
+        true, it may be called from several threads at once for disjoint
+        ranges of states, as long as each thread passes its own workspace.
+    */
+    void stepBatch(Scalar const* in, Scalar* out,
+                   size_t count, size_t stride);
+    virtual void stepBatch(Scalar const* in, Scalar* out,
+                           size_t count, size_t stride, Workspace& work);
+
+    virtual bool isReentrant() const;
+
     std::string const& getName() const;
     void setName(std::string const& name);
 
@@ -54,6 +78,9 @@ protected:
     Model const& model;
     std::string name;
 
+    // Workspace for the single-threaded form of stepBatch()
+    Workspace workspace;
+
     unsigned int updateVersion();
 
 private:
@@ -61,53 +88,93 @@ private:
 
 };
 
-template <typename ScalarParam>
-Integrator<ScalarParam>::Integrator(Model const& model)
+template <typename ScalarParam, typename VectorParam>
+Integrator<ScalarParam, VectorParam>::Integrator(Model const& model)
 : model(model),
   name("integrator"),
   version(0)
 {
 }
 
-template <typename ScalarParam>
-Integrator<ScalarParam>::~Integrator()
+template <typename ScalarParam, typename VectorParam>
+Integrator<ScalarParam, VectorParam>::~Integrator()
 {
 }
 
-template <typename ScalarParam>
-typename Integrator<ScalarParam>::Vector
-Integrator<ScalarParam>::step(typename Integrator<ScalarParam>::Vector const& v)
+template <typename ScalarParam, typename VectorParam>
+typename Integrator<ScalarParam, VectorParam>::Vector
+Integrator<ScalarParam, VectorParam>::step(typename Integrator<ScalarParam, VectorParam>::Vector const& v)
 {
-    typename Integrator<ScalarParam>::Vector out(v.getDimension());
+    typename Integrator<ScalarParam, VectorParam>::Vector out(v.getDimension());
     step(v, out);
     return out;
 }
 
-template <typename ScalarParam>
+template <typename ScalarParam, typename VectorParam>
 inline
-std::string const& Integrator<ScalarParam>::getName() const
+void Integrator<ScalarParam, VectorParam>::stepBatch(Scalar const* in, Scalar* out,
+                                                     size_t count, size_t stride)
+{
+    stepBatch(in, out, count, stride, workspace);
+}
+
+template <typename ScalarParam, typename VectorParam>
+void Integrator<ScalarParam, VectorParam>::stepBatch(Scalar const* in, Scalar* out,
+                                                     size_t count, size_t stride,
+                                                     Workspace& /* work */)
+{
+    int dimension = model.getDimension();
+    Vector v(dimension);
+    Vector stepVector(dimension);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        for (int k = 0; k < dimension; k++)
+        {
+            v[k] = in[k * stride + i];
+        }
+
+        step(v, stepVector);
+
+        for (int k = 0; k < dimension; k++)
+        {
+            out[k * stride + i] = stepVector[k];
+        }
+    }
+}
+
+template <typename ScalarParam, typename VectorParam>
+bool Integrator<ScalarParam, VectorParam>::isReentrant() const
+{
+    // step() generally keeps intermediate results in members
+    return false;
+}
+
+template <typename ScalarParam, typename VectorParam>
+inline
+std::string const& Integrator<ScalarParam, VectorParam>::getName() const
 {
     return name;
 }
 
-template <typename ScalarParam>
+template <typename ScalarParam, typename VectorParam>
 inline
-void Integrator<ScalarParam>::setName(std::string const& value)
+void Integrator<ScalarParam, VectorParam>::setName(std::string const& value)
 {
     name = value;
 }
 
 
-template <typename ScalarParam>
+template <typename ScalarParam, typename VectorParam>
 inline
-unsigned int const& Integrator<ScalarParam>::getVersion() const
+unsigned int const& Integrator<ScalarParam, VectorParam>::getVersion() const
 {
     return version;
 }
 
-template <typename ScalarParam>
+template <typename ScalarParam, typename VectorParam>
 inline
-unsigned int Integrator<ScalarParam>::updateVersion()
+unsigned int Integrator<ScalarParam, VectorParam>::updateVersion()
 {
     return ++version;
 }
@@ -0,0 +1,118 @@
+#ifndef DTS_PACK_H
+#define DTS_PACK_H
+
+namespace DTS {
+
+/**
+ * A fixed number of doubles that are operated on in lock step.
+ *
+ * Pack wraps a GCC vector extension type. Scalars convert implicitly and
+ * the arithmetic operators work elementwise, so model equations written
+ * once as a template (see LorenzModel::evaluate) compile for doubles as
+ * well as for packs. The instructions emitted for the operations depend on
+ * the target of the function they are inlined into; SimdRungeKutta4 builds
+ * its kernels for SSE2, AVX2 and AVX-512 from the same code.
+ */
+template <int WidthParam>
+struct Pack
+{
+    typedef double Native __attribute__((vector_size(WidthParam * sizeof(double))));
+
+    static const int width = WidthParam;
+
+    Native v;
+
+    /* Constructors */
+    Pack(void)
+    {
+    }
+
+    Pack(double scalar)
+    {
+        v = Native() + scalar;
+    }
+
+    /* Memory access, no alignment required */
+    static Pack load(double const* p)
+    {
+        Pack result;
+        __builtin_memcpy(&result.v, p, sizeof(Native));
+        return result;
+    }
+
+    void store(double* p) const
+    {
+        __builtin_memcpy(p, &v, sizeof(Native));
+    }
+
+    /* Math Methods */
+    Pack& operator+=(Pack const& other)
+    {
+        v += other.v;
+        return *this;
+    }
+
+    Pack& operator-=(Pack const& other)
+    {
+        v -= other.v;
+        return *this;
+    }
+
+    Pack& operator*=(Pack const& other)
+    {
+        v *= other.v;
+        return *this;
+    }
+
+    Pack& operator/=(Pack const& other)
+    {
+        v /= other.v;
+        return *this;
+    }
+
+    /*
+        Defined as friends so they are found for mixed scalar/pack
+        expressions such as 2 * x.
+    */
+    friend Pack operator-(Pack const& a)
+    {
+        Pack result;
+        result.v = -a.v;
+        return result;
+    }
+
+    friend Pack operator+(Pack const& a, Pack const& b)
+    {
+        Pack result;
+        result.v = a.v + b.v;
+        return result;
+    }
+
+    friend Pack operator-(Pack const& a, Pack const& b)
+    {
+        Pack result;
+        result.v = a.v - b.v;
+        return result;
+    }
+
+    friend Pack operator*(Pack const& a, Pack const& b)
+    {
+        Pack result;
+        result.v = a.v * b.v;
+        return result;
+    }
+
+    friend Pack operator/(Pack const& a, Pack const& b)
+    {
+        Pack result;
+        result.v = a.v / b.v;
+        return result;
+    }
+};
+
+template <int WidthParam>
+const int Pack<WidthParam>::width;
+
+} // end namespace DTS
+
+#endif
@@ -95,6 +95,9 @@ public:
     int getIntParamValue(std::string const& name) const;
     RealParam getRealParamValue(std::string const& name) const;
     
+    // Values in the order the parameters were added, for fast access.
+    std::vector<RealParam> const& getRealParamValues() const;
+
     int getBoolParamIndex(std::string const& name) const;    
     int getIntParamIndex(std::string const& name) const;
     int getRealParamIndex(std::string const& name) const;
@@ -108,6 +111,14 @@ public:
     void setIntParamValue(std::string const& name, int const value);    
     void setRealParamValue(std::string const& name, RealParam const value);
 
+    /*
+        Copy every parameter value of 'other' whose name is also a parameter
+        of this instance. This is used to keep two instances of the same
+        class in sync, e.g. the generic and fixed-dimension instantiations
+        of a model. The version is updated once.
+    */
+    void copyParamValues(ParameterClass<RealParam> const& other);
+
 protected:
 
     /*
@@ -283,6 +294,13 @@ RealParam ParameterClass<RealParam>::getRealParamValue(std::string const& name)
     return realParamValues[index];
 }
 
+template <typename RealParam>
+inline
+std::vector<RealParam> const& ParameterClass<RealParam>::getRealParamValues() const
+{
+    return realParamValues;
+}
+
 
 
 
@@ -505,5 +523,29 @@ void ParameterClass<RealParam>::setRealParamValue(std::string const& name, RealP
     updateVersion();
 }
 
+template <typename RealParam>
+void ParameterClass<RealParam>::copyParamValues(ParameterClass<RealParam> const& other)
+{
+    typename BoolParameters::const_iterator bit;
+    for (bit = other.boolParams.begin(); bit != other.boolParams.end(); bit++)
+    {
+        _setBoolParamValue(bit->name, bit->value);
+    }
+
+    typename IntParameters::const_iterator iit;
+    for (iit = other.intParams.begin(); iit != other.intParams.end(); iit++)
+    {
+        _setIntParamValue(iit->name, iit->value);
+    }
+
+    typename RealParameters::const_iterator rit;
+    for (rit = other.realParams.begin(); rit != other.realParams.end(); rit++)
+    {
+        _setRealParamValue(rit->name, rit->value);
+    }
+
+    updateVersion();
+}
+
 #endif
 
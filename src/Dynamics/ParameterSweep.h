@@ -0,0 +1,345 @@
+#ifndef DTS_PARAMETER_SWEEP_H
+#define DTS_PARAMETER_SWEEP_H
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "Experiment.h"
+#include "SweepFile.h"
+#include "ThreadPool.h"
+
+namespace DTS {
+
+/*
+    Integrates an experiment for many values of one real model parameter
+    and collects the points of a bifurcation diagram: after discarding a
+    transient, either the local maxima of one coordinate or the upward
+    crossings of that coordinate through a level (a Poincaré section).
+
+    The values are spread over the threads of a ThreadPool. Every thread
+    works on a clone of the experiment (see Experiment::clone()), so the
+    prototype must have its maker set; the clones start with the parameter
+    values and integrator of the prototype. Each value starts from the same
+    initial state and writes its points to the SweepFile::Writer as soon as
+    it is done, so memory use does not grow with the number of values.
+
+    Maxima are refined by the parabola through the sample and its two
+    neighbours, crossings by linear interpolation between the samples on
+    either side of the level. A trajectory that leaves the finite numbers
+    stops its value early.
+*/
+template <typename ScalarParam>
+class ParameterSweep
+{
+public:
+
+    typedef Experiment<ScalarParam> ExperimentType;
+    typedef ScalarParam Scalar;
+
+    struct Settings
+    {
+        std::string parameter;
+        Scalar first;
+        Scalar last;
+        unsigned int count;
+
+        // Steps discarded before collecting, and steps collected after them
+        unsigned long transient;
+        unsigned long steps;
+
+        SweepFile::Mode mode;
+        unsigned int coordinate;
+        Scalar level;
+
+        // Points kept per parameter value, the first ones found
+        unsigned int maxPoints;
+
+        // Initial state; the center of the model offset by 0.1 if empty
+        std::vector<Scalar> initial;
+
+        Settings()
+        : first(0),
+          last(1),
+          count(1000),
+          transient(20000),
+          steps(20000),
+          mode(SweepFile::MAXIMA),
+          coordinate(0),
+          level(0),
+          maxPoints(200)
+        {
+        }
+    };
+
+    ParameterSweep(ExperimentType const& prototype, Settings const& settings);
+    ~ParameterSweep();
+
+    // The header of the file the sweep writes
+    SweepFile::Header getHeader(std::string const& experimentName) const;
+
+    // Parameter value number i
+    Scalar getValue(unsigned int i) const;
+
+    /*
+        Run the sweep on the threads of 'pool'. Returns false if the
+        experiment cannot be cloned.
+    */
+    bool run(ThreadPool& pool, SweepFile::Writer& writer);
+
+    // Parameter values finished so far, may be read while run() is busy
+    unsigned int getNumFinished() const
+    {
+        return finished;
+    }
+
+private:
+
+    class SweepTask : public ThreadPool::Task
+    {
+    public:
+        ParameterSweep* sweep;
+        SweepFile::Writer* writer;
+
+        void run(size_t begin, size_t end, int thread)
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                sweep->sweepValue(i, thread, *writer);
+            }
+        }
+    };
+
+    // Working space of one thread
+    struct Worker
+    {
+        ExperimentType* experiment;
+        // The last three states, oldest first
+        std::vector<Scalar> states[3];
+        std::vector<Scalar> points;
+
+        Worker()
+        : experiment(0)
+        {
+        }
+    };
+
+    ExperimentType const& prototype;
+    Settings settings;
+    std::vector<Worker> workers;
+    volatile unsigned int finished;
+
+    void sweepValue(unsigned int i, int thread, SweepFile::Writer& writer);
+    void deleteWorkers();
+
+    static bool isFinite(std::vector<Scalar> const& state)
+    {
+        for (size_t c = 0; c < state.size(); c++)
+        {
+            Scalar v = state[c];
+            if (v != v || v - v != 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+template <typename ScalarParam>
+ParameterSweep<ScalarParam>::ParameterSweep(ExperimentType const& prototype, Settings const& settings)
+: prototype(prototype),
+  settings(settings),
+  finished(0)
+{
+    if (this->settings.count == 0)
+    {
+        this->settings.count = 1;
+    }
+}
+
+template <typename ScalarParam>
+ParameterSweep<ScalarParam>::~ParameterSweep()
+{
+    deleteWorkers();
+}
+
+template <typename ScalarParam>
+SweepFile::Header ParameterSweep<ScalarParam>::getHeader(std::string const& experimentName) const
+{
+    SweepFile::Header header;
+    header.mode = settings.mode;
+    header.dimension = prototype.model->getDimension();
+    header.coordinate = settings.coordinate;
+    header.level = settings.level;
+    header.first = settings.first;
+    header.last = settings.last;
+    header.count = settings.count;
+    header.experiment = experimentName;
+    header.parameter = settings.parameter;
+    return header;
+}
+
+template <typename ScalarParam>
+ScalarParam ParameterSweep<ScalarParam>::getValue(unsigned int i) const
+{
+    if (settings.count == 1)
+    {
+        return settings.first;
+    }
+    return settings.first + (settings.last - settings.first) * Scalar(i) / Scalar(settings.count - 1);
+}
+
+template <typename ScalarParam>
+bool ParameterSweep<ScalarParam>::run(ThreadPool& pool, SweepFile::Writer& writer)
+{
+    deleteWorkers();
+    finished = 0;
+
+    int dimension = prototype.model->getDimension();
+    workers.resize(pool.getNumThreads());
+    for (size_t t = 0; t < workers.size(); t++)
+    {
+        workers[t].experiment = prototype.clone();
+        if (workers[t].experiment == 0)
+        {
+            deleteWorkers();
+            return false;
+        }
+        for (int k = 0; k < 3; k++)
+        {
+            workers[t].states[k].resize(dimension);
+        }
+    }
+
+    SweepTask task;
+    task.sweep = this;
+    task.writer = &writer;
+
+    // Every value is a long integration, so deal them out one by one
+    pool.parallelFor(settings.count, 1, task);
+
+    deleteWorkers();
+    return true;
+}
+
+template <typename ScalarParam>
+void ParameterSweep<ScalarParam>::sweepValue(unsigned int i, int thread, SweepFile::Writer& writer)
+{
+    Worker& w = workers[thread];
+    ExperimentType& e = *w.experiment;
+    int dimension = e.model->getDimension();
+    unsigned int c = settings.coordinate;
+    Scalar value = getValue(i);
+
+    // A new model version also restarts multistep integrators
+    e.model->setRealParamValue(settings.parameter, value);
+
+    std::vector<Scalar>* s0 = &w.states[0];
+    std::vector<Scalar>* s1 = &w.states[1];
+    std::vector<Scalar>* s2 = &w.states[2];
+
+    if (settings.initial.size() == size_t(dimension))
+    {
+        *s2 = settings.initial;
+    }
+    else
+    {
+        typename ExperimentType::Vector center = e.model->getCenterPoint();
+        for (int k = 0; k < dimension; k++)
+        {
+            (*s2)[k] = center[k] + 0.1;
+        }
+    }
+
+    typename ExperimentType::Stepper& stepper = e.getStepper();
+
+    for (unsigned long n = 0; n < settings.transient; n++)
+    {
+        stepper(&(*s2)[0]);
+    }
+
+    w.points.clear();
+    unsigned int found = 0;
+
+    for (unsigned long n = 0; n < settings.steps && found < settings.maxPoints; n++)
+    {
+        // Rotate the states, the oldest one is overwritten by the next step
+        std::vector<Scalar>* oldest = s0;
+        s0 = s1;
+        s1 = s2;
+        s2 = oldest;
+        *s2 = *s1;
+        stepper(&(*s2)[0]);
+
+        if (!isFinite(*s2))
+        {
+            break;
+        }
+
+        if (settings.mode == SweepFile::MAXIMA)
+        {
+            if (n < 2)
+            {
+                continue;
+            }
+
+            Scalar x0 = (*s0)[c];
+            Scalar x1 = (*s1)[c];
+            Scalar x2 = (*s2)[c];
+            if (x1 <= x0 || x1 < x2)
+            {
+                continue;
+            }
+
+            // Vertex of the parabola through the three samples, in steps from s1
+            Scalar curvature = x0 - 2 * x1 + x2;
+            Scalar t = curvature < 0 ? 0.5 * (x0 - x2) / curvature : 0;
+            for (int k = 0; k < dimension; k++)
+            {
+                Scalar a = (*s0)[k];
+                Scalar b = (*s1)[k];
+                Scalar d = (*s2)[k];
+                w.points.push_back(b + 0.5 * t * (d - a) + 0.5 * t * t * (a - 2 * b + d));
+            }
+            found++;
+        }
+        else
+        {
+            Scalar x1 = (*s1)[c];
+            Scalar x2 = (*s2)[c];
+            if (n < 1 || !(x1 < settings.level && x2 >= settings.level))
+            {
+                continue;
+            }
+
+            Scalar f = (settings.level - x1) / (x2 - x1);
+            for (int k = 0; k < dimension; k++)
+            {
+                w.points.push_back((*s1)[k] + f * ((*s2)[k] - (*s1)[k]));
+            }
+            found++;
+        }
+    }
+
+    if (found > 0)
+    {
+        writer.write(value, &w.points[0], found);
+    }
+
+    __sync_fetch_and_add(&finished, 1);
+}
+
+template <typename ScalarParam>
+void ParameterSweep<ScalarParam>::deleteWorkers()
+{
+    for (size_t t = 0; t < workers.size(); t++)
+    {
+        delete workers[t].experiment;
+    }
+    workers.clear();
+}
+
+} // end namespace DTS
+
+#endif
@@ -5,31 +5,37 @@
 #include "Parameter.h"
 #include "Transformer.h"
 
-template <typename ScalarParam>
-class ProjectionTransformer : public Transformer<ScalarParam>
+template <typename ScalarParam, typename VectorParam = DTS::Vector<ScalarParam> >
+class ProjectionTransformer : public Transformer<ScalarParam, VectorParam>
 {
 
 public:
 
-    ProjectionTransformer(DynamicalModel<ScalarParam> const& model);
+    typedef typename Transformer<ScalarParam, VectorParam>::Model Model;
+    typedef typename Transformer<ScalarParam, VectorParam>::Vector Vector;
+
+    ProjectionTransformer(Model const& model);
     virtual ~ProjectionTransformer();
 
-    virtual void transform(typename DynamicalModel<ScalarParam>::Vector const& v,
-                           typename DynamicalModel<ScalarParam>::Vector & out) const;
+    virtual void transform(Vector const& v,
+                           Vector & out) const;
 
-    virtual void invTransform(typename DynamicalModel<ScalarParam>::Vector const& v,
-                              typename DynamicalModel<ScalarParam>::Vector & out) const;
+    virtual void invTransform(Vector const& v,
+                              Vector & out) const;
 
-    virtual void transform(typename DynamicalModel<ScalarParam>::Vector const& v,
+    virtual void transform(Vector const& v,
                            Geometry::Vector<ScalarParam, 3> & out) const;
 
     virtual void invTransform(Geometry::Vector<ScalarParam,3> const& v,
-                              typename DynamicalModel<ScalarParam>::Vector & out) const;
+                              Vector & out) const;
+
+    virtual void transformBatch(ScalarParam const* in, ScalarParam* out,
+                                size_t count, size_t stride) const;
 
-    virtual typename DynamicalModel<ScalarParam>::Scalar getRadius(void) const;
+    virtual ScalarParam getRadius(void) const;
 
     // necessary to find overloaded version
-    using Transformer<ScalarParam>::getParameterDisplay;
+    using Transformer<ScalarParam, VectorParam>::getParameterDisplay;
     virtual std::string getParameterDisplay(int parameter);
 };
 
@@ -38,9 +44,9 @@ public:
 // Implementation
 //
 
-template <typename ScalarParam>
-ProjectionTransformer<ScalarParam>::ProjectionTransformer(DynamicalModel<ScalarParam> const& model)
-: Transformer<ScalarParam>(model)
+template <typename ScalarParam, typename VectorParam>
+ProjectionTransformer<ScalarParam, VectorParam>::ProjectionTransformer(Model const& model)
+: Transformer<ScalarParam, VectorParam>(model)
 {
     this->setName("projection");
 
@@ -62,30 +68,32 @@ ProjectionTransformer<ScalarParam>::ProjectionTransformer(DynamicalModel<ScalarP
     this->addIntParameter( IntParameter("zDisplay", z, -1, d-1, z, 1) );
 }
 
-template <typename ScalarParam>
-ProjectionTransformer<ScalarParam>::~ProjectionTransformer()
+template <typename ScalarParam, typename VectorParam>
+ProjectionTransformer<ScalarParam, VectorParam>::~ProjectionTransformer()
 {
 }
 
 
-template <typename ScalarParam>
+template <typename ScalarParam, typename VectorParam>
 inline
-void ProjectionTransformer<ScalarParam>::transform(typename DynamicalModel<ScalarParam>::Vector const& v,
-                                                   typename DynamicalModel<ScalarParam>::Vector & out) const
+void ProjectionTransformer<ScalarParam, VectorParam>::transform(Vector const& v,
+                                                   Vector & out) const
 {
     // A value of -1 means it will be mapped to the value 0.
     int const& xIndex = this->intParamValues[0];
     int const& yIndex = this->intParamValues[1];
     int const& zIndex = this->intParamValues[2];
 
+    DTS::Counters::add(DTS::Counters::TRANSFORMS);
+
     out[0] = ( xIndex == -1 ? 0 : v[ xIndex ] );
     out[1] = ( yIndex == -1 ? 0 : v[ yIndex ] );
     out[2] = ( zIndex == -1 ? 0 : v[ zIndex ] );
 }
 
-template <typename ScalarParam>
-void ProjectionTransformer<ScalarParam>::invTransform(typename DynamicalModel<ScalarParam>::Vector const& v,
-                                                      typename DynamicalModel<ScalarParam>::Vector & out) const
+template <typename ScalarParam, typename VectorParam>
+void ProjectionTransformer<ScalarParam, VectorParam>::invTransform(Vector const& v,
+                                                      Vector & out) const
 {
     // A value of -1 means it will be mapped to the value 0.
     int const& xIndex = this->intParamValues[0];
@@ -107,9 +115,9 @@ void ProjectionTransformer<ScalarParam>::invTransform(typename DynamicalModel<Sc
     }
 }
 
-template <typename ScalarParam>
+template <typename ScalarParam, typename VectorParam>
 inline
-void ProjectionTransformer<ScalarParam>::transform(typename DynamicalModel<ScalarParam>::Vector const& v,
+void ProjectionTransformer<ScalarParam, VectorParam>::transform(Vector const& v,
                                                    Geometry::Vector<ScalarParam, 3> & out) const
 {
     // A value of -1 means it will be mapped to the value 0.
@@ -117,14 +125,16 @@ void ProjectionTransformer<ScalarParam>::transform(typename DynamicalModel<Scala
     int const& yIndex = this->intParamValues[1];
     int const& zIndex = this->intParamValues[2];
 
+    DTS::Counters::add(DTS::Counters::TRANSFORMS);
+
     out[0] = ( xIndex == -1 ? 0 : v[ xIndex ] );
     out[1] = ( yIndex == -1 ? 0 : v[ yIndex ] );
     out[2] = ( zIndex == -1 ? 0 : v[ zIndex ] );
 }
 
-template <typename ScalarParam>
-void ProjectionTransformer<ScalarParam>::invTransform(Geometry::Vector<ScalarParam, 3> const& v,
-                                                      typename DynamicalModel<ScalarParam>::Vector & out) const
+template <typename ScalarParam, typename VectorParam>
+void ProjectionTransformer<ScalarParam, VectorParam>::invTransform(Geometry::Vector<ScalarParam, 3> const& v,
+                                                      Vector & out) const
 {
     // A value of -1 means it will be mapped to the value 0.
     int const& xIndex = this->intParamValues[0];
@@ -146,8 +156,42 @@ void ProjectionTransformer<ScalarParam>::invTransform(Geometry::Vector<ScalarPar
     }
 }
 
-template <typename ScalarParam>
-typename DynamicalModel<ScalarParam>::Scalar ProjectionTransformer<ScalarParam>::getRadius(void) const
+template <typename ScalarParam, typename VectorParam>
+void ProjectionTransformer<ScalarParam, VectorParam>::transformBatch(ScalarParam const* in,
+                                                        ScalarParam* out,
+                                                        size_t count,
+                                                        size_t stride) const
+{
+    // A value of -1 means it will be mapped to the value 0.
+    int const indices[3] = { this->intParamValues[0],
+                             this->intParamValues[1],
+                             this->intParamValues[2] };
+
+    DTS::Counters::add(DTS::Counters::TRANSFORMS, count);
+
+    // Each display coordinate is a copy of one row of the input.
+    for (int c = 0; c < 3; c++)
+    {
+        if (indices[c] == -1)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                out[3 * i + c] = 0;
+            }
+        }
+        else
+        {
+            ScalarParam const* row = in + indices[c] * stride;
+            for (size_t i = 0; i < count; i++)
+            {
+                out[3 * i + c] = row[i];
+            }
+        }
+    }
+}
+
+template <typename ScalarParam, typename VectorParam>
+ScalarParam ProjectionTransformer<ScalarParam, VectorParam>::getRadius(void) const
 {   
     typedef typename CoordinateClass<ScalarParam>::Coordinates Coords;
     typedef typename ParameterClass<double>::IntParameters IntParams;
@@ -189,8 +233,8 @@ typename DynamicalModel<ScalarParam>::Scalar ProjectionTransformer<ScalarParam>:
     return radius;
 }
 
-template <typename ScalarParam>
-std::string ProjectionTransformer<ScalarParam>::getParameterDisplay(int parameterIndex)
+template <typename ScalarParam, typename VectorParam>
+std::string ProjectionTransformer<ScalarParam, VectorParam>::getParameterDisplay(int parameterIndex)
 {
     std::string name;
     typename CoordinateClass<ScalarParam>::Coordinates coords = this->model.getCoords();
@@ -0,0 +1,114 @@
+#ifndef DTS_RANDOM_H
+#define DTS_RANDOM_H
+
+#include <stdint.h>
+
+#include <string>
+
+namespace DTS {
+
+/*
+    Counter-based random numbers, Philox4x32-10 (Salmon et al., "Parallel
+    random numbers: as easy as 1, 2, 3", SC11).
+
+    There is no state that advances with every draw. The numbers are a
+    function of a key and a counter: the key selects a stream and is set up
+    once, here from a seed and a stream number, and the counter names a
+    block of four words within it. Tools use their seed and the number of
+    the frame or release as the key and the index of a particle as the
+    counter, so the numbers of every particle can be drawn on any thread
+    and in any order, and every cluster node that draws them gets the same.
+
+    Ten rounds of Philox pass the BigCrush tests for any keys and counters,
+    including ones that differ in a single bit like consecutive indices.
+*/
+class Random
+{
+public:
+
+    typedef uint32_t Word;
+
+    explicit Random(Word seed = 0, Word stream = 0)
+    {
+        key[0] = seed;
+        key[1] = stream;
+    }
+
+    // A seed derived from a name, such as that of a tool (32 bit FNV-1a)
+    static Word hash(std::string const& name)
+    {
+        Word h = 2166136261u;
+        for (size_t i = 0; i < name.size(); i++)
+        {
+            h ^= (unsigned char)name[i];
+            h *= 16777619u;
+        }
+        return h;
+    }
+
+    // The four words of block 'draw' of the numbers of 'index'
+    void generate(uint64_t index, Word draw, Word out[4]) const
+    {
+        Word counter[4] = { Word(index), Word(index >> 32), draw, 0 };
+        philox(counter, key, out);
+    }
+
+    // Philox4x32-10 of a whole counter and key, as in Random123
+    static void philox(Word const counter[4], Word const key[2], Word out[4])
+    {
+        Word c[4] = { counter[0], counter[1], counter[2], counter[3] };
+        Word k[2] = { key[0], key[1] };
+
+        for (int round = 0; round < 10; round++)
+        {
+            uint64_t p0 = uint64_t(0xD2511F53u) * c[0];
+            uint64_t p1 = uint64_t(0xCD9E8D57u) * c[2];
+
+            Word n[4] =
+            {
+                Word(p1 >> 32) ^ c[1] ^ k[0],
+                Word(p1),
+                Word(p0 >> 32) ^ c[3] ^ k[1],
+                Word(p0)
+            };
+            c[0] = n[0];
+            c[1] = n[1];
+            c[2] = n[2];
+            c[3] = n[3];
+
+            k[0] += 0x9E3779B9u;
+            k[1] += 0xBB67AE85u;
+        }
+
+        out[0] = c[0];
+        out[1] = c[1];
+        out[2] = c[2];
+        out[3] = c[3];
+    }
+
+    // Four numbers uniformly distributed in (0, 1), see generate()
+    void uniform(uint64_t index, Word draw, double out[4]) const
+    {
+        Word words[4];
+        generate(index, draw, words);
+        for (int i = 0; i < 4; i++)
+        {
+            out[i] = toUnit(words[i]);
+        }
+    }
+
+    // The center of the word's interval of width 2^-32 in (0, 1), so that
+    // neither 0 nor 1 come up and logarithms and divisions are safe
+    static double toUnit(Word word)
+    {
+        return (double(word) + 0.5) * (1.0 / 4294967296.0);
+    }
+
+private:
+
+    Word key[2];
+};
+
+} // end namespace DTS
+
+#endif
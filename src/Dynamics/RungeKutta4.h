@@ -2,6 +2,7 @@
 #define RUNGEKUTTA4_H
 
 #include "Integrator.h"
+#include "RungeKutta4Batch.h"
 
 class RungeKutta4 : public Integrator<double>
 {
@@ -69,10 +70,27 @@ public:
     inline
     void step(Vector const& v, Vector &out)
     {
+        DTS::Counters::add(DTS::Counters::STEPS);
+        DTS::Counters::add(DTS::Counters::EVALUATIONS, 4);
+
         // call pointer to member function
         (this->*stepFunction)(v, out);
     }
 
+    using Integrator<double>::stepBatch;
+
+    // Only uses 'work', so threads can share the integrator
+    void stepBatch(Scalar const* in, Scalar* out, size_t count, size_t stride,
+                   Workspace& work)
+    {
+        rungeKutta4StepBatch(model, realParamValues[0], in, out, count, stride, work);
+    }
+
+    bool isReentrant() const
+    {
+        return true;
+    }
+
     // Computes one Runge-Kutta integration step vector
     void step_nd(Vector const& v, Vector &out)
     {
@@ -0,0 +1,123 @@
+#ifndef RUNGEKUTTA4_BATCH_H
+#define RUNGEKUTTA4_BATCH_H
+
+#include <algorithm>
+#include <vector>
+
+#include "Counters.h"
+
+/*
+    Runge-Kutta 4 step vectors for a batch of states stored as
+    structure-of-arrays (see Integrator::stepBatch).
+
+    The states are processed in blocks of at most 'block' states so that
+    the intermediate rows stay in cache. Within a block the model is
+    evaluated once per stage, and the remaining work consists of simple
+    loops over contiguous rows which the compiler can vectorize. 'out'
+    accumulates the weighted stage derivatives and must not overlap 'in'.
+    'work' is resized as needed and can be kept by the caller between calls
+    to avoid reallocation.
+*/
+template <typename ModelParam>
+void rungeKutta4StepBatch(ModelParam const& model,
+                          typename ModelParam::Scalar stepSize,
+                          typename ModelParam::Scalar const* in,
+                          typename ModelParam::Scalar* out,
+                          size_t count, size_t stride,
+                          std::vector<typename ModelParam::Scalar>& work,
+                          size_t block = 256)
+{
+    typedef typename ModelParam::Scalar Scalar;
+
+    if (count == 0)
+    {
+        return;
+    }
+
+    DTS::Counters::add(DTS::Counters::STEPS, count);
+    DTS::Counters::add(DTS::Counters::EVALUATIONS, 4 * count);
+
+    int dimension = model.getDimension();
+    size_t size = dimension * block;
+    if (work.size() < 3 * size)
+    {
+        work.resize(3 * size);
+    }
+    Scalar* x = &work[0];
+    Scalar* k = &work[size];
+    Scalar* temp = &work[2 * size];
+
+    Scalar const halfStep = stepSize * Scalar(0.5);
+    Scalar const sixthStep = stepSize / Scalar(6);
+
+    for (size_t begin = 0; begin < count; begin += block)
+    {
+        size_t n = std::min(block, count - begin);
+
+        /* Copy the block, the model needs equal strides for in and out: */
+        for (int c = 0; c < dimension; c++)
+        {
+            std::copy(in + c * stride + begin, in + c * stride + begin + n,
+                      x + c * block);
+        }
+
+        /* First stage: */
+        model.evaluateBatch(x, k, n, block);
+        for (int c = 0; c < dimension; c++)
+        {
+            Scalar const* xc = x + c * block;
+            Scalar const* kc = k + c * block;
+            Scalar* sum = out + c * stride + begin;
+            Scalar* t = temp + c * block;
+            for (size_t i = 0; i < n; i++)
+            {
+                sum[i] = kc[i];
+                t[i] = xc[i] + halfStep * kc[i];
+            }
+        }
+
+        /* Second stage: */
+        model.evaluateBatch(temp, k, n, block);
+        for (int c = 0; c < dimension; c++)
+        {
+            Scalar const* xc = x + c * block;
+            Scalar const* kc = k + c * block;
+            Scalar* sum = out + c * stride + begin;
+            Scalar* t = temp + c * block;
+            for (size_t i = 0; i < n; i++)
+            {
+                sum[i] += Scalar(2) * kc[i];
+                t[i] = xc[i] + halfStep * kc[i];
+            }
+        }
+
+        /* Third stage: */
+        model.evaluateBatch(temp, k, n, block);
+        for (int c = 0; c < dimension; c++)
+        {
+            Scalar const* xc = x + c * block;
+            Scalar const* kc = k + c * block;
+            Scalar* sum = out + c * stride + begin;
+            Scalar* t = temp + c * block;
+            for (size_t i = 0; i < n; i++)
+            {
+                sum[i] += Scalar(2) * kc[i];
+                t[i] = xc[i] + stepSize * kc[i];
+            }
+        }
+
+        /* Fourth stage and step vector: */
+        model.evaluateBatch(temp, k, n, block);
+        for (int c = 0; c < dimension; c++)
+        {
+            Scalar const* kc = k + c * block;
+            Scalar* sum = out + c * stride + begin;
+            for (size_t i = 0; i < n; i++)
+            {
+                sum[i] = sixthStep * (sum[i] + kc[i]);
+            }
+        }
+    }
+}
+
+#endif
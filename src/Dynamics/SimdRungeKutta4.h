@@ -0,0 +1,206 @@
+#ifndef SIMD_RUNGEKUTTA4_H
+#define SIMD_RUNGEKUTTA4_H
+
+#include "Pack.h"
+#include "RungeKutta4.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define DTS_SIMD_X86
+#endif
+
+/*
+    Runge-Kutta 4 with SIMD batch kernels for a model given at compile time.
+
+    ModelParam must provide a static template function
+
+        template <typename In, typename Out>
+        static void evaluate(In const& p, Out& out, double const* params);
+
+    which is used with DTS::Pack arguments to step several states at once,
+    all four stages kept in registers. Kernels are built for SSE2 (2 states
+    per instruction), AVX2 (4) and AVX-512 (8); the widest one the CPU
+    supports is chosen when the integrator is created.
+
+    Only stepBatch() differs from RungeKutta4: the integrator keeps the
+    "rk4" name and its parameters, so experiments can register it instead
+    of RungeKutta4 and tools pick up the kernels through stepBatch().
+*/
+template <typename ModelParam, int DimensionParam>
+class SimdRungeKutta4 : public RungeKutta4
+{
+public:
+
+    typedef void (*Kernel)(double const* params, double stepSize,
+                           double const* in, double* out,
+                           size_t count, size_t stride);
+
+private:
+
+    Kernel kernel;
+    char const* kernelName;
+
+public:
+
+    /* Constructors and destructors: */
+
+    SimdRungeKutta4(const Model& model, Scalar stepSize=.01)
+    : RungeKutta4(model, stepSize),
+      kernel(&kernelGeneric),
+      kernelName("generic")
+    {
+        if (model.getDimension() != DimensionParam)
+        {
+            throw IntegratorException();
+        }
+
+#ifdef DTS_SIMD_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f"))
+        {
+            kernel = &kernelAvx512;
+            kernelName = "avx512";
+        }
+        else if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        {
+            kernel = &kernelAvx2;
+            kernelName = "avx2";
+        }
+        else
+        {
+            kernel = &kernelSse2;
+            kernelName = "sse2";
+        }
+#endif
+    }
+
+    virtual ~SimdRungeKutta4()
+    {
+    }
+
+    /* Methods: */
+
+    using RungeKutta4::stepBatch;
+
+    // The kernels keep everything in registers, 'work' is not needed
+    void stepBatch(Scalar const* in, Scalar* out, size_t count, size_t stride,
+                   Workspace& /* work */)
+    {
+        DTS::Counters::add(DTS::Counters::STEPS, count);
+        DTS::Counters::add(DTS::Counters::EVALUATIONS, 4 * count);
+
+        kernel(&model.getRealParamValues()[0], realParamValues[0],
+               in, out, count, stride);
+    }
+
+    // The instruction set of the kernel selected at runtime
+    char const* getKernelName() const
+    {
+        return kernelName;
+    }
+
+private:
+
+    /*
+        Step vectors for states begin..end-1, PackParam::width at a time.
+        end - begin must be a multiple of the width.
+    */
+    template <typename PackParam>
+    static inline void stepPacks(double const* params, double stepSize,
+                                 double const* in, double* out,
+                                 size_t begin, size_t end, size_t stride)
+    {
+        PackParam const halfStep = stepSize * 0.5;
+        PackParam const fullStep = stepSize;
+        PackParam const sixthStep = stepSize / 6.0;
+        PackParam const two = 2.0;
+
+        PackParam x[DimensionParam];
+        PackParam k[DimensionParam];
+        PackParam t[DimensionParam];
+        PackParam sum[DimensionParam];
+
+        for (size_t i = begin; i < end; i += PackParam::width)
+        {
+            for (int c = 0; c < DimensionParam; c++)
+            {
+                x[c] = PackParam::load(in + c * stride + i);
+            }
+
+            /* First stage: */
+            ModelParam::evaluate(x, k, params);
+            for (int c = 0; c < DimensionParam; c++)
+            {
+                sum[c] = k[c];
+                t[c] = x[c] + halfStep * k[c];
+            }
+
+            /* Second stage: */
+            ModelParam::evaluate(t, k, params);
+            for (int c = 0; c < DimensionParam; c++)
+            {
+                sum[c] += two * k[c];
+                t[c] = x[c] + halfStep * k[c];
+            }
+
+            /* Third stage: */
+            ModelParam::evaluate(t, k, params);
+            for (int c = 0; c < DimensionParam; c++)
+            {
+                sum[c] += two * k[c];
+                t[c] = x[c] + fullStep * k[c];
+            }
+
+            /* Fourth stage and step vector: */
+            ModelParam::evaluate(t, k, params);
+            for (int c = 0; c < DimensionParam; c++)
+            {
+                (sixthStep * (sum[c] + k[c])).store(out + c * stride + i);
+            }
+        }
+    }
+
+    template <int WidthParam>
+    static inline void stepAll(double const* params, double stepSize,
+                               double const* in, double* out,
+                               size_t count, size_t stride)
+    {
+        size_t packed = count - count % WidthParam;
+        stepPacks<DTS::Pack<WidthParam> >(params, stepSize, in, out, 0, packed, stride);
+        stepPacks<DTS::Pack<1> >(params, stepSize, in, out, packed, count, stride);
+    }
+
+    static void kernelGeneric(double const* params, double stepSize,
+                              double const* in, double* out,
+                              size_t count, size_t stride)
+    {
+        stepAll<2>(params, stepSize, in, out, count, stride);
+    }
+
+#ifdef DTS_SIMD_X86
+    __attribute__((target("sse2"), flatten))
+    static void kernelSse2(double const* params, double stepSize,
+                           double const* in, double* out,
+                           size_t count, size_t stride)
+    {
+        stepAll<2>(params, stepSize, in, out, count, stride);
+    }
+
+    __attribute__((target("avx2,fma"), flatten))
+    static void kernelAvx2(double const* params, double stepSize,
+                           double const* in, double* out,
+                           size_t count, size_t stride)
+    {
+        stepAll<4>(params, stepSize, in, out, count, stride);
+    }
+
+    __attribute__((target("avx512f"), flatten))
+    static void kernelAvx512(double const* params, double stepSize,
+                             double const* in, double* out,
+                             size_t count, size_t stride)
+    {
+        stepAll<8>(params, stepSize, in, out, count, stride);
+    }
+#endif
+};
+
+#endif
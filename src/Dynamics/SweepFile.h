@@ -0,0 +1,259 @@
+#ifndef DTS_SWEEP_FILE_H
+#define DTS_SWEEP_FILE_H
+
+#include <pthread.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace DTS {
+
+/*
+    Binary file of the points collected by a ParameterSweep.
+
+    The file starts with a header:
+
+        char[8]  "DTSSWEEP"
+        uint32   format version (1)
+        uint32   mode (SweepFile::MAXIMA or SweepFile::CROSSINGS)
+        uint32   dimension of the states
+        uint32   coordinate whose maxima or crossings were collected
+        float64  crossing level (CROSSINGS only)
+        float64  first and last parameter value
+        uint32   number of parameter values
+        string   experiment name
+        string   parameter name
+
+    where a string is a uint32 length followed by the characters. Then
+    follows one record per point,
+
+        float64  parameter value
+        float64  state[dimension]
+
+    in the order the points were found. Records of different parameter
+    values may interleave, since the sweep writes them as its threads
+    finish. All values are in the byte order of the machine that wrote the
+    file.
+*/
+class SweepFile
+{
+public:
+
+    enum Mode
+    {
+        MAXIMA,     // Local maxima of the coordinate
+        CROSSINGS   // Upward crossings of the coordinate through the level
+    };
+
+    struct Header
+    {
+        Mode mode;
+        unsigned int dimension;
+        unsigned int coordinate;
+        double level;
+        double first;
+        double last;
+        unsigned int count;
+        std::string experiment;
+        std::string parameter;
+
+        Header()
+        : mode(MAXIMA),
+          dimension(0),
+          coordinate(0),
+          level(0),
+          first(0),
+          last(0),
+          count(0)
+        {
+        }
+    };
+
+    /*
+        Appends records to a file. write() may be called from several
+        threads at once; each call is written as a whole.
+    */
+    class Writer
+    {
+    public:
+        Writer()
+        : file(0),
+          dimension(0),
+          records(0)
+        {
+            pthread_mutex_init(&mutex, 0);
+        }
+
+        ~Writer()
+        {
+            close();
+            pthread_mutex_destroy(&mutex);
+        }
+
+        // Returns false if the file could not be created
+        bool open(std::string const& fileName, Header const& header)
+        {
+            close();
+            file = std::fopen(fileName.c_str(), "wb");
+            if (file == 0)
+            {
+                return false;
+            }
+
+            dimension = header.dimension;
+            records = 0;
+
+            std::fwrite(magic(), 1, 8, file);
+            writeUnsigned(VERSION);
+            writeUnsigned(header.mode);
+            writeUnsigned(header.dimension);
+            writeUnsigned(header.coordinate);
+            std::fwrite(&header.level, sizeof(double), 1, file);
+            std::fwrite(&header.first, sizeof(double), 1, file);
+            std::fwrite(&header.last, sizeof(double), 1, file);
+            writeUnsigned(header.count);
+            writeString(header.experiment);
+            writeString(header.parameter);
+
+            return std::ferror(file) == 0;
+        }
+
+        /*
+            Write 'count' records; 'states' holds 'dimension' values per
+            record.
+        */
+        void write(double parameter, double const* states, size_t count)
+        {
+            pthread_mutex_lock(&mutex);
+            for (size_t i = 0; i < count; i++)
+            {
+                std::fwrite(&parameter, sizeof(double), 1, file);
+                std::fwrite(states + i * dimension, sizeof(double), dimension, file);
+            }
+            records += count;
+            pthread_mutex_unlock(&mutex);
+        }
+
+        unsigned long long getNumRecords() const
+        {
+            return records;
+        }
+
+        // Returns false if writing failed
+        bool close()
+        {
+            if (file == 0)
+            {
+                return true;
+            }
+
+            bool ok = std::ferror(file) == 0;
+            ok = std::fclose(file) == 0 && ok;
+            file = 0;
+            return ok;
+        }
+
+    private:
+        std::FILE* file;
+        unsigned int dimension;
+        unsigned long long records;
+        pthread_mutex_t mutex;
+
+        void writeUnsigned(unsigned int value)
+        {
+            std::fwrite(&value, sizeof(value), 1, file);
+        }
+
+        void writeString(std::string const& s)
+        {
+            writeUnsigned(s.size());
+            std::fwrite(s.data(), 1, s.size(), file);
+        }
+    };
+
+    /*
+        Read a whole file. 'parameters' gets the parameter value and
+        'states' the 'dimension' values of every record. Returns false if
+        the file could not be opened or is not a sweep file, including a
+        header whose mode, dimension or coordinate is out of range; a
+        truncated last record is dropped.
+    */
+    static bool read(std::string const& fileName, Header& header,
+                     std::vector<double>& parameters, std::vector<double>& states)
+    {
+        std::FILE* file = std::fopen(fileName.c_str(), "rb");
+        if (file == 0)
+        {
+            return false;
+        }
+
+        char fileMagic[8];
+        unsigned int version = 0;
+        unsigned int mode = 0;
+        bool ok = std::fread(fileMagic, 1, 8, file) == 8
+            && std::string(fileMagic, 8) == magic()
+            && readUnsigned(file, version) && version == VERSION
+            && readUnsigned(file, mode)
+            && readUnsigned(file, header.dimension)
+            && readUnsigned(file, header.coordinate)
+            && std::fread(&header.level, sizeof(double), 1, file) == 1
+            && std::fread(&header.first, sizeof(double), 1, file) == 1
+            && std::fread(&header.last, sizeof(double), 1, file) == 1
+            && readUnsigned(file, header.count)
+            && readString(file, header.experiment)
+            && readString(file, header.parameter)
+            && mode <= CROSSINGS
+            && header.dimension > 0 && header.dimension <= MAX_DIMENSION
+            && header.coordinate < header.dimension;
+        header.mode = Mode(mode);
+
+        parameters.clear();
+        states.clear();
+        if (ok)
+        {
+            std::vector<double> record(header.dimension + 1);
+            while (std::fread(&record[0], sizeof(double), record.size(), file) == record.size())
+            {
+                parameters.push_back(record[0]);
+                states.insert(states.end(), record.begin() + 1, record.end());
+            }
+        }
+
+        std::fclose(file);
+        return ok;
+    }
+
+private:
+
+    static char const* magic()
+    {
+        return "DTSSWEEP";
+    }
+
+    enum
+    {
+        VERSION = 1,
+        MAX_DIMENSION = 4096    // Keeps dimension + 1 and the records small
+    };
+
+    static bool readUnsigned(std::FILE* file, unsigned int& value)
+    {
+        return std::fread(&value, sizeof(value), 1, file) == 1;
+    }
+
+    static bool readString(std::FILE* file, std::string& s)
+    {
+        unsigned int size;
+        if (!readUnsigned(file, size) || size > 4096)
+        {
+            return false;
+        }
+        s.resize(size);
+        return size == 0 || std::fread(&s[0], 1, size, file) == size;
+    }
+};
+
+} // end namespace DTS
+
+#endif
@@ -0,0 +1,370 @@
+#ifndef DTS_THREAD_POOL_H
+#define DTS_THREAD_POOL_H
+
+#include <pthread.h>
+#include <unistd.h>
+
+#include <vector>
+
+namespace DTS {
+
+/*
+    A fixed set of worker threads for data-parallel loops.
+
+    parallelFor() splits [0, count) into chunks of 'grain' indices and
+    runs Task::run() on them from the calling thread and all workers. Each
+    thread starts with an equal, contiguous share of the chunks and takes
+    them from the front; once its share is used up it steals chunks from the
+    back of the other shares, so threads that are slowed down (by the OS or
+    by more expensive states) do not hold up the loop.
+
+    The workers are created once and sleep between loops. Task::run() gets
+    the index of the thread it runs on (0 is the calling thread), which
+    tasks use to select per-thread scratch space such as an
+    Integrator::Workspace.
+
+    One pool is shared by all users in a process, so the loops do not
+    oversubscribe the processors. parallelFor() may be called from several
+    threads; their loops run one after another. A caller may limit a loop
+    to the first maxThreads threads of the pool, and then only sees thread
+    indices below that.
+*/
+class ThreadPool
+{
+public:
+
+    class Task
+    {
+    public:
+        virtual ~Task()
+        {
+        }
+
+        virtual void run(size_t begin, size_t end, int thread) = 0;
+    };
+
+    /* Constructors and destructors: */
+
+    explicit ThreadPool(int numThreads = 1)
+    : task(0),
+      count(0),
+      grain(1),
+      activeThreads(1),
+      generation(0),
+      finishedWorkers(0),
+      stopping(false)
+    {
+        pthread_mutex_init(&callerMutex, 0);
+        pthread_mutex_init(&mutex, 0);
+        pthread_cond_init(&startCond, 0);
+        pthread_cond_init(&doneCond, 0);
+        startWorkers(numThreads);
+    }
+
+    ~ThreadPool()
+    {
+        stopWorkers();
+        pthread_cond_destroy(&doneCond);
+        pthread_cond_destroy(&startCond);
+        pthread_mutex_destroy(&mutex);
+        pthread_mutex_destroy(&callerMutex);
+    }
+
+    /* Methods: */
+
+    // Number of threads taking part in parallelFor(), including the caller
+    int getNumThreads() const
+    {
+        return int(shares.size());
+    }
+
+    void setNumThreads(int numThreads)
+    {
+        if (numThreads < 1)
+        {
+            numThreads = 1;
+        }
+
+        pthread_mutex_lock(&callerMutex);
+        if (numThreads != getNumThreads())
+        {
+            stopWorkers();
+            startWorkers(numThreads);
+        }
+        pthread_mutex_unlock(&callerMutex);
+    }
+
+    static int getNumProcessors()
+    {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        return n < 1 ? 1 : int(n);
+    }
+
+    // Threads above maxThreads sit the loop out, 0 uses all of them
+    void parallelFor(size_t count, size_t grain, Task& task, int maxThreads = 0)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+        if (grain == 0)
+        {
+            grain = 1;
+        }
+
+        size_t numChunks = (count + grain - 1) / grain;
+        if (maxThreads == 1 || numChunks == 1)
+        {
+            task.run(0, count, 0);
+            return;
+        }
+
+        /* Wait for the loops of other callers: */
+        pthread_mutex_lock(&callerMutex);
+
+        int numThreads = getNumThreads();
+        if (maxThreads > 0 && maxThreads < numThreads)
+        {
+            numThreads = maxThreads;
+        }
+
+        if (numThreads == 1)
+        {
+            pthread_mutex_unlock(&callerMutex);
+            task.run(0, count, 0);
+            return;
+        }
+
+        /* Deal out equal shares of chunks: */
+        for (int t = 0; t < numThreads; t++)
+        {
+            shares[t].set(numChunks * t / numThreads,
+                          numChunks * (t + 1) / numThreads);
+        }
+
+        /* Wake up the workers: */
+        pthread_mutex_lock(&mutex);
+        this->task = &task;
+        this->count = count;
+        this->grain = grain;
+        activeThreads = numThreads;
+        finishedWorkers = 0;
+        generation++;
+        pthread_cond_broadcast(&startCond);
+        pthread_mutex_unlock(&mutex);
+
+        work(0);
+
+        /* Wait until every worker has left the loop: */
+        pthread_mutex_lock(&mutex);
+        while (finishedWorkers < workers.size())
+        {
+            pthread_cond_wait(&doneCond, &mutex);
+        }
+        this->task = 0;
+        pthread_mutex_unlock(&mutex);
+
+        pthread_mutex_unlock(&callerMutex);
+    }
+
+private:
+
+    /*
+        The chunks [begin, end) not yet taken from one thread's share. Both
+        bounds are kept in one word so that taking from either end is a
+        single compare-and-swap. Padded to a cache line so that threads do
+        not invalidate each other's shares.
+    */
+    struct Share
+    {
+        volatile unsigned long long bounds;
+        char padding[64 - sizeof(unsigned long long)];
+
+        void set(size_t begin, size_t end)
+        {
+            bounds = (static_cast<unsigned long long>(end) << 32) | begin;
+        }
+
+        // Take the first chunk (owner)
+        bool popFront(size_t& chunk)
+        {
+            while (true)
+            {
+                unsigned long long old = bounds;
+                unsigned long long begin = old & 0xffffffffULL;
+                unsigned long long end = old >> 32;
+                if (begin >= end)
+                {
+                    return false;
+                }
+                if (__sync_bool_compare_and_swap(&bounds, old, old + 1))
+                {
+                    chunk = size_t(begin);
+                    return true;
+                }
+            }
+        }
+
+        // Take the last chunk (thieves)
+        bool popBack(size_t& chunk)
+        {
+            while (true)
+            {
+                unsigned long long old = bounds;
+                unsigned long long begin = old & 0xffffffffULL;
+                unsigned long long end = old >> 32;
+                if (begin >= end)
+                {
+                    return false;
+                }
+                if (__sync_bool_compare_and_swap(&bounds, old, old - (1ULL << 32)))
+                {
+                    chunk = size_t(end - 1);
+                    return true;
+                }
+            }
+        }
+    };
+
+    struct Worker
+    {
+        ThreadPool* pool;
+        int index;
+        unsigned int generation; ///< Last loop seen by the worker
+        pthread_t thread;
+    };
+
+    std::vector<Share> shares;
+    std::vector<Worker> workers;
+
+    pthread_mutex_t callerMutex; ///< Held by the thread running a loop
+    pthread_mutex_t mutex;
+    pthread_cond_t startCond;
+    pthread_cond_t doneCond;
+
+    /* The current loop, guarded by mutex: */
+    Task* task;
+    size_t count;
+    size_t grain;
+    int activeThreads; ///< Threads taking part in the loop
+    unsigned int generation;
+    size_t finishedWorkers;
+    bool stopping;
+
+    void runChunk(size_t chunk, int thread)
+    {
+        size_t begin = chunk * grain;
+        size_t end = begin + grain < count ? begin + grain : count;
+        task->run(begin, end, thread);
+    }
+
+    void work(int thread)
+    {
+        size_t chunk;
+        int numThreads = activeThreads;
+        if (thread >= numThreads)
+        {
+            return;
+        }
+
+        while (shares[thread].popFront(chunk))
+        {
+            runChunk(chunk, thread);
+        }
+
+        for (int i = 1; i < numThreads; i++)
+        {
+            Share& victim = shares[(thread + i) % numThreads];
+            while (victim.popBack(chunk))
+            {
+                runChunk(chunk, thread);
+            }
+        }
+    }
+
+    static void* workerMain(void* arg)
+    {
+        Worker* worker = static_cast<Worker*>(arg);
+        ThreadPool* pool = worker->pool;
+
+        pthread_mutex_lock(&pool->mutex);
+        unsigned int& seen = worker->generation;
+        while (true)
+        {
+            while (pool->generation == seen && !pool->stopping)
+            {
+                pthread_cond_wait(&pool->startCond, &pool->mutex);
+            }
+            if (pool->stopping)
+            {
+                break;
+            }
+            seen = pool->generation;
+            pthread_mutex_unlock(&pool->mutex);
+
+            pool->work(worker->index);
+
+            pthread_mutex_lock(&pool->mutex);
+            if (++pool->finishedWorkers == pool->workers.size())
+            {
+                pthread_cond_signal(&pool->doneCond);
+            }
+        }
+        pthread_mutex_unlock(&pool->mutex);
+
+        return 0;
+    }
+
+    void startWorkers(int numThreads)
+    {
+        if (numThreads < 1)
+        {
+            numThreads = 1;
+        }
+
+        shares.resize(numThreads);
+        workers.resize(numThreads - 1);
+        stopping = false;
+
+        // Workers must not move once started, so resize first
+        for (size_t i = 0; i < workers.size(); i++)
+        {
+            workers[i].pool = this;
+            workers[i].index = int(i) + 1;
+            // A thread may only get to run after the first loop started
+            workers[i].generation = generation;
+        }
+        for (size_t i = 0; i < workers.size(); i++)
+        {
+            if (pthread_create(&workers[i].thread, 0, &workerMain, &workers[i]) != 0)
+            {
+                // Continue with the threads we have
+                workers.resize(i);
+                shares.resize(i + 1);
+                break;
+            }
+        }
+    }
+
+    void stopWorkers()
+    {
+        pthread_mutex_lock(&mutex);
+        stopping = true;
+        pthread_cond_broadcast(&startCond);
+        pthread_mutex_unlock(&mutex);
+
+        for (size_t i = 0; i < workers.size(); i++)
+        {
+            pthread_join(workers[i].thread, 0);
+        }
+        workers.clear();
+    }
+
+    /* Not copyable */
+    ThreadPool(ThreadPool const&);
+    ThreadPool& operator=(ThreadPool const&);
+};
+
+} // end namespace DTS
+
+#endif
@@ -0,0 +1,341 @@
+#ifndef DTS_TRACE_H
+#define DTS_TRACE_H
+
+#include <pthread.h>
+#include <time.h>
+
+#include <cstdio>
+#include <list>
+#include <string>
+
+namespace DTS {
+
+/*
+    Timeline of scoped markers, written as Chrome trace event JSON which
+    chrome://tracing and Perfetto display.
+
+    A marker is a Trace::Scope on the stack; it records its name, start and
+    duration when it goes out of scope:
+
+        void Viewer::frame()
+        {
+            DTS_TRACE_SCOPE("Viewer::frame");
+            ...
+        }
+
+    Every thread records into a ring buffer of its own, so recording takes
+    no locks. The buffer is created by the first marker of the thread, so
+    threads that never record while tracing is enabled have none, and when
+    a thread finishes its buffer is handed to the next new thread, which
+    drops the finished thread's markers. The buffer keeps the last
+    BUFFER_SIZE markers of the thread;
+    write() copies the buffers of all threads while they keep recording and
+    skips markers that were overwritten in the meantime. While tracing is
+    disabled, which is the default, a marker costs one load and a branch.
+
+    Names must stay valid until the trace is written; pass string literals
+    or names returned by intern().
+*/
+class Trace
+{
+public:
+
+    enum
+    {
+        BUFFER_SIZE = 1 << 16
+    };
+
+    typedef unsigned long long Time;
+
+    class Scope
+    {
+    public:
+        explicit Scope(char const* scopeName)
+        : name(0),
+          start(0)
+        {
+            if (isEnabled())
+            {
+                name = scopeName;
+                start = now();
+            }
+        }
+
+        ~Scope()
+        {
+            if (name != 0)
+            {
+                record(name, start, now() - start);
+            }
+        }
+
+    private:
+        char const* name;
+        Time start;
+    };
+
+    static bool isEnabled()
+    {
+        return state().enabled;
+    }
+
+    // Enabling starts a new trace, the markers recorded so far are dropped
+    static void setEnabled(bool enabled)
+    {
+        State& s = state();
+        if (enabled && !s.enabled)
+        {
+            pthread_mutex_lock(&s.mutex);
+            s.epoch = now();
+            for (std::list<Buffer*>::iterator it = s.buffers.begin(); it != s.buffers.end(); ++it)
+            {
+                (*it)->tail = (*it)->head;
+            }
+            pthread_mutex_unlock(&s.mutex);
+        }
+        __sync_synchronize();
+        s.enabled = enabled;
+    }
+
+    // Name of the calling thread in the trace, kept until its buffer exists
+    static void setThreadName(std::string const& name)
+    {
+        char const* interned = intern(name);
+        threadName() = interned;
+
+        Buffer* b = currentBuffer();
+        if (b != 0)
+        {
+            State& s = state();
+            pthread_mutex_lock(&s.mutex);
+            b->name = interned;
+            pthread_mutex_unlock(&s.mutex);
+        }
+    }
+
+    // A copy of 'name' that lives as long as the program
+    static char const* intern(std::string const& name)
+    {
+        State& s = state();
+        pthread_mutex_lock(&s.mutex);
+        std::list<std::string>::iterator it = s.names.begin();
+        while (it != s.names.end() && *it != name)
+        {
+            ++it;
+        }
+        if (it == s.names.end())
+        {
+            it = s.names.insert(s.names.end(), name);
+        }
+        pthread_mutex_unlock(&s.mutex);
+        return it->c_str();
+    }
+
+    /*
+        Write the markers of all threads to 'fileName'. 'process' is the
+        process id in the trace, so that traces of several cluster nodes
+        can be loaded side by side. Returns false if the file could not be
+        written.
+    */
+    static bool write(std::string const& fileName, int process = 0,
+                      std::string const& processName = "flow")
+    {
+        std::FILE* file = std::fopen(fileName.c_str(), "w");
+        if (file == 0)
+        {
+            return false;
+        }
+
+        State& s = state();
+        pthread_mutex_lock(&s.mutex);
+
+        std::fprintf(file, "{\"traceEvents\":[\n");
+        std::fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":0,"
+                     "\"args\":{\"name\":\"%s\"}}", process, processName.c_str());
+
+        int thread = 0;
+        for (std::list<Buffer*>::iterator it = s.buffers.begin(); it != s.buffers.end(); ++it, ++thread)
+        {
+            Buffer& b = **it;
+
+            std::fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,"
+                         "\"args\":{\"name\":\"%s\"}}", process, thread, b.name.c_str());
+
+            unsigned long head = b.head;
+            __sync_synchronize();
+            unsigned long first = head - b.tail > BUFFER_SIZE ? head - BUFFER_SIZE : b.tail;
+
+            for (unsigned long i = first; i != head; i++)
+            {
+                Event e = b.events[i % BUFFER_SIZE];
+
+                // The owner may have overwritten the event while we copied
+                // it; at head == i + BUFFER_SIZE it is writing this slot
+                __sync_synchronize();
+                if (b.head - i >= BUFFER_SIZE || e.start < s.epoch)
+                {
+                    continue;
+                }
+
+                std::fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,"
+                             "\"ts\":%.3f,\"dur\":%.3f}", e.name, process, thread,
+                             (e.start - s.epoch) * 1e-3, e.duration * 1e-3);
+            }
+        }
+
+        std::fprintf(file, "\n]}\n");
+        pthread_mutex_unlock(&s.mutex);
+
+        return std::fclose(file) == 0;
+    }
+
+    static Time now()
+    {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return Time(ts.tv_sec) * 1000000000ULL + Time(ts.tv_nsec);
+    }
+
+private:
+
+    struct Event
+    {
+        char const* name;
+        Time start;
+        Time duration;
+    };
+
+    struct Buffer
+    {
+        Event events[BUFFER_SIZE];
+        // Events recorded by the owner, only increased by the owner
+        volatile unsigned long head;
+        // First event of the current trace
+        unsigned long tail;
+        std::string name;
+        // The owner finished, the buffer waits for a new thread
+        bool finished;
+
+        Buffer()
+        : head(0),
+          tail(0),
+          finished(false)
+        {
+        }
+    };
+
+    struct State
+    {
+        volatile bool enabled;
+        Time epoch;
+        pthread_mutex_t mutex;
+        // Runs threadFinished() when the owner of a buffer finishes
+        pthread_key_t ownerKey;
+        std::list<Buffer*> buffers;
+        std::list<std::string> names;
+
+        State()
+        : enabled(false),
+          epoch(0)
+        {
+            pthread_mutex_init(&mutex, 0);
+            pthread_key_create(&ownerKey, &threadFinished);
+        }
+    };
+
+    static State& state()
+    {
+        static State s;
+        return s;
+    }
+
+    static void record(char const* name, Time start, Time duration)
+    {
+        Buffer* b = threadBuffer();
+        Event& e = b->events[b->head % BUFFER_SIZE];
+        e.name = name;
+        e.start = start;
+        e.duration = duration;
+
+        // Publish the event before the new head
+        __sync_synchronize();
+        b->head = b->head + 1;
+    }
+
+    static Buffer*& currentBuffer()
+    {
+        static __thread Buffer* buffer = 0;
+        return buffer;
+    }
+
+    static char const*& threadName()
+    {
+        static __thread char const* name = 0;
+        return name;
+    }
+
+    // The buffer of the calling thread, that of a finished thread if any
+    static Buffer* threadBuffer()
+    {
+        Buffer*& buffer = currentBuffer();
+        if (buffer == 0)
+        {
+            State& s = state();
+            pthread_mutex_lock(&s.mutex);
+
+            Buffer* b = 0;
+            unsigned long index = 0;
+            for (std::list<Buffer*>::iterator it = s.buffers.begin(); it != s.buffers.end(); ++it, ++index)
+            {
+                if ((*it)->finished)
+                {
+                    b = *it;
+                    b->finished = false;
+                    b->tail = b->head;
+                    break;
+                }
+            }
+            if (b == 0)
+            {
+                b = new Buffer();
+                s.buffers.push_back(b);
+            }
+
+            if (threadName() != 0)
+            {
+                b->name = threadName();
+            }
+            else
+            {
+                char name[32];
+                std::snprintf(name, sizeof(name), "thread %lu", index);
+                b->name = name;
+            }
+            pthread_setspecific(s.ownerKey, b);
+
+            pthread_mutex_unlock(&s.mutex);
+
+            buffer = b;
+        }
+        return buffer;
+    }
+
+    static void threadFinished(void* buffer)
+    {
+        State& s = state();
+        pthread_mutex_lock(&s.mutex);
+        static_cast<Buffer*>(buffer)->finished = true;
+        pthread_mutex_unlock(&s.mutex);
+    }
+};
+
+} // end namespace DTS
+
+#define DTS_TRACE_CONCAT2(a, b) a ## b
+#define DTS_TRACE_CONCAT(a, b) DTS_TRACE_CONCAT2(a, b)
+
+// Marker from here to the end of the enclosing scope
+#define DTS_TRACE_SCOPE(name) \
+    DTS::Trace::Scope DTS_TRACE_CONCAT(traceScope, __LINE__)(name)
+
+#endif
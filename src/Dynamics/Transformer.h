@@ -6,6 +6,7 @@
 
 #include "Geometry/Vector.h"
 
+#include "Counters.h"
 #include "DynamicalModel.h"
 #include "Vector.h"
 #include "Parameter.h"
@@ -21,16 +22,16 @@ class TransformerException: public std::exception
 template <typename ScalarParam>
 class Experiment;
 
-template <typename ScalarParam>
+template <typename ScalarParam, typename VectorParam = DTS::Vector<ScalarParam> >
 class Transformer : public ParameterClass<ScalarParam>
 {
 
 friend class Experiment<ScalarParam>;
 
 public:
-    typedef DynamicalModel<ScalarParam> Model;
-    typedef typename DynamicalModel<ScalarParam>::Scalar Scalar;
-    typedef typename DynamicalModel<ScalarParam>::Vector Vector;
+    typedef DynamicalModel<ScalarParam, VectorParam> Model;
+    typedef ScalarParam Scalar;
+    typedef VectorParam Vector;
     
     Transformer(Model const& model);
     virtual ~Transformer();
@@ -55,6 +56,14 @@ public:
     Vector invTransform(Geometry::Vector<ScalarParam,3> const& v) const;
     virtual void invTransform(Geometry::Vector<ScalarParam,3> const& v, Vector & out) const;
 
+    /*
+        Transform 'count' states at once. The states are structure-of-arrays
+        as in Integrator::stepBatch(). The display coordinates are written
+        as consecutive triples: out[3 * i + 0..2] for state i.
+    */
+    virtual void transformBatch(Scalar const* in, Scalar* out,
+                                size_t count, size_t stride) const;
+
     /* Generally you need to be careful.  If the coordinate ranges from 0, 2PI
      * and you map it to polar coordinates, then its range is now 0. So
      * the default point, center point, and radius is necessarily transformation
@@ -92,30 +101,32 @@ private:
 //
 
 
-template <typename ScalarParam>
-Transformer<ScalarParam>::Transformer(Model const& model)
+template <typename ScalarParam, typename VectorParam>
+Transformer<ScalarParam, VectorParam>::Transformer(Model const& model)
 : model(model),
   name("transformer"),
   version(0)
 {
 }
 
-template <typename ScalarParam>
-Transformer<ScalarParam>::~Transformer()
+template <typename ScalarParam, typename VectorParam>
+Transformer<ScalarParam, VectorParam>::~Transformer()
 {
 }
 
-template <typename ScalarParam>
-typename DynamicalModel<ScalarParam>::Vector Transformer<ScalarParam>::transform(Vector const& v) const
+template <typename ScalarParam, typename VectorParam>
+VectorParam Transformer<ScalarParam, VectorParam>::transform(Vector const& v) const
 {
     Vector out(3);
     transform(v, out);
     return out;
 }
 
-template <typename ScalarParam>
-void Transformer<ScalarParam>::transform(Vector const& v, Vector & out) const
+template <typename ScalarParam, typename VectorParam>
+void Transformer<ScalarParam, VectorParam>::transform(Vector const& v, Vector & out) const
 {
+    DTS::Counters::add(DTS::Counters::TRANSFORMS);
+
     // Take the first three components
 
     out[0] = v[0];
@@ -130,16 +141,16 @@ void Transformer<ScalarParam>::transform(Vector const& v, Vector & out) const
     }
 }
 
-template <typename ScalarParam>
-typename DynamicalModel<ScalarParam>::Vector Transformer<ScalarParam>::invTransform(Vector const& v) const
+template <typename ScalarParam, typename VectorParam>
+VectorParam Transformer<ScalarParam, VectorParam>::invTransform(Vector const& v) const
 {
     Vector out(model.getDimension());
     invTransform(v, out);
     return out;
 }
 
-template <typename ScalarParam>
-void Transformer<ScalarParam>::invTransform(Vector const& v, Vector & out) const
+template <typename ScalarParam, typename VectorParam>
+void Transformer<ScalarParam, VectorParam>::invTransform(Vector const& v, Vector & out) const
 {
     // Take the first three components
     out[0] = v[0];
@@ -153,17 +164,19 @@ void Transformer<ScalarParam>::invTransform(Vector const& v, Vector & out) const
     }
 }
 
-template <typename ScalarParam>
-Geometry::Vector<ScalarParam,3> Transformer<ScalarParam>::transform2(Vector const& v) const
+template <typename ScalarParam, typename VectorParam>
+Geometry::Vector<ScalarParam,3> Transformer<ScalarParam, VectorParam>::transform2(Vector const& v) const
 {
     Geometry::Vector<ScalarParam,3> out;
     transform(v, out);
     return out;
 }
 
-template <typename ScalarParam>
-void Transformer<ScalarParam>::transform(Vector const& v, Geometry::Vector<ScalarParam,3> & out) const
+template <typename ScalarParam, typename VectorParam>
+void Transformer<ScalarParam, VectorParam>::transform(Vector const& v, Geometry::Vector<ScalarParam,3> & out) const
 {
+    DTS::Counters::add(DTS::Counters::TRANSFORMS);
+
     // Take the first three components
 
     out[0] = v[0];
@@ -178,16 +191,16 @@ void Transformer<ScalarParam>::transform(Vector const& v, Geometry::Vector<Scala
     }
 }
 
-template <typename ScalarParam>
-typename DynamicalModel<ScalarParam>::Vector Transformer<ScalarParam>::invTransform(Geometry::Vector<ScalarParam,3> const& v) const
+template <typename ScalarParam, typename VectorParam>
+VectorParam Transformer<ScalarParam, VectorParam>::invTransform(Geometry::Vector<ScalarParam,3> const& v) const
 {
     Vector out(model.getDimension());
     invTransform(v, out);
     return out;
 }
 
-template <typename ScalarParam>
-void Transformer<ScalarParam>::invTransform(Geometry::Vector<ScalarParam,3> const& v, Vector & out) const
+template <typename ScalarParam, typename VectorParam>
+void Transformer<ScalarParam, VectorParam>::invTransform(Geometry::Vector<ScalarParam,3> const& v, Vector & out) const
 {
     // Take the first three components
 
@@ -202,23 +215,46 @@ void Transformer<ScalarParam>::invTransform(Geometry::Vector<ScalarParam,3> cons
     }
 }
 
-template <typename ScalarParam>
-typename DynamicalModel<ScalarParam>::Vector Transformer<ScalarParam>::getDefaultPoint(void) const
+template <typename ScalarParam, typename VectorParam>
+void Transformer<ScalarParam, VectorParam>::transformBatch(Scalar const* in, Scalar* out,
+                                                           size_t count, size_t stride) const
 {
-    const DTS::Vector<double> defaultPoint = model.getDefaultPoint();
+    int dimension = model.getDimension();
+    Vector v(dimension);
+    Geometry::Vector<ScalarParam,3> display;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        for (int k = 0; k < dimension; k++)
+        {
+            v[k] = in[k * stride + i];
+        }
+
+        transform(v, display);
+
+        out[3 * i + 0] = display[0];
+        out[3 * i + 1] = display[1];
+        out[3 * i + 2] = display[2];
+    }
+}
+
+template <typename ScalarParam, typename VectorParam>
+VectorParam Transformer<ScalarParam, VectorParam>::getDefaultPoint(void) const
+{
+    const Vector defaultPoint = model.getDefaultPoint();
     return transform(defaultPoint);
 
 }
 
-template <typename ScalarParam>
-typename DynamicalModel<ScalarParam>::Vector Transformer<ScalarParam>::getCenterPoint(void) const
+template <typename ScalarParam, typename VectorParam>
+VectorParam Transformer<ScalarParam, VectorParam>::getCenterPoint(void) const
 {
-    const DTS::Vector<double> centerPoint = model.getCenterPoint();
+    const Vector centerPoint = model.getCenterPoint();
     return transform(centerPoint);
 }    
     
-template <typename ScalarParam>
-typename DynamicalModel<ScalarParam>::Scalar Transformer<ScalarParam>::getRadius(void) const
+template <typename ScalarParam, typename VectorParam>
+ScalarParam Transformer<ScalarParam, VectorParam>::getRadius(void) const
 {   
     // return the largest non-infinite radius from the first 3 coordinates
     
@@ -259,36 +295,36 @@ typename DynamicalModel<ScalarParam>::Scalar Transformer<ScalarParam>::getRadius
     return radius;
 }
 
-template <typename ScalarParam>
+template <typename ScalarParam, typename VectorParam>
 inline
-std::string const& Transformer<ScalarParam>::getName() const
+std::string const& Transformer<ScalarParam, VectorParam>::getName() const
 {
     return name;
 }
 
-template <typename ScalarParam>
+template <typename ScalarParam, typename VectorParam>
 inline
-void Transformer<ScalarParam>::setName(std::string const& value)
+void Transformer<ScalarParam, VectorParam>::setName(std::string const& value)
 {
     name = value;
 }
 
-template <typename ScalarParam>
+template <typename ScalarParam, typename VectorParam>
 inline
-unsigned int const& Transformer<ScalarParam>::getVersion() const
+unsigned int const& Transformer<ScalarParam, VectorParam>::getVersion() const
 {
     return version;
 }
 
-template <typename ScalarParam>
+template <typename ScalarParam, typename VectorParam>
 inline
-unsigned int Transformer<ScalarParam>::updateVersion()
+unsigned int Transformer<ScalarParam, VectorParam>::updateVersion()
 {
     return ++version;
 }
 
-template <typename ScalarParam>
-std::string Transformer<ScalarParam>::getParameterDisplay(int parameterIndex)
+template <typename ScalarParam, typename VectorParam>
+std::string Transformer<ScalarParam, VectorParam>::getParameterDisplay(int parameterIndex)
 {
     // Need to update this to work with all parameter types
     // Right now it (and the one below) assume integer parameters.
@@ -296,8 +332,8 @@ std::string Transformer<ScalarParam>::getParameterDisplay(int parameterIndex)
     return "";
 }
 
-template <typename ScalarParam>
-std::string Transformer<ScalarParam>::getParameterDisplay(std::string parameterName)
+template <typename ScalarParam, typename VectorParam>
+std::string Transformer<ScalarParam, VectorParam>::getParameterDisplay(std::string parameterName)
 {
     typename ParameterClass<double>::IntParameters iparams = this->getIntParams();
     int paramIndex = this->getIntParamIndex(parameterName);
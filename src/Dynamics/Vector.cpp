@@ -1,3 +0,0 @@
-#include "Vector.h"
-
-unsigned int DTS::Vector::allocations = 0;
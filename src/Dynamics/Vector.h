@@ -5,6 +5,7 @@
 #include <vector>
 #include <iostream>
 
+#include "Counters.h"
 
 
 namespace DTS {
@@ -14,7 +15,6 @@ class Vector
 {
     public:
     typedef ScalarParam Scalar;
-    static unsigned int allocations;
 
     protected:
     /**
@@ -192,11 +192,6 @@ inline Vector<ScalarParam> operator/(const Vector<ScalarParam>& v, ScalarParam s
  * Implementations *
  *******************/
  
-/* Static members */
-
-template <typename ScalarParam>
-unsigned int Vector<ScalarParam>::allocations = 0;
-
 /* Constructors and destructors */
 
 template <typename ScalarParam>
@@ -204,8 +199,6 @@ Vector<ScalarParam>::Vector(void)
 : dimension(0)
 {
 	components.resize(dimension);
-	allocations += 1;
-	std::cout << "default Allocations " << allocations << std::endl;
 }
 
 template <typename ScalarParam>
@@ -217,8 +210,10 @@ Vector<ScalarParam>::Vector(int const dimension, ScalarParam const& value)
     {
         components[i] = value;
     }
-    allocations += 1;
-	//std::cout << "standard Allocations " << allocations << std::endl;    
+    if (dimension > 0)
+    {
+        Counters::add(Counters::ALLOCATIONS);
+    }
 }
 
 template <typename ScalarParam>
@@ -230,8 +225,10 @@ Vector<ScalarParam>::Vector(Vector<ScalarParam> const& v)
     {
         components[i] = v[i];
     }
-    allocations += 1;
-	//std::cout << "copyVector Allocations " << allocations << std::endl;    
+    if (dimension > 0)
+    {
+        Counters::add(Counters::ALLOCATIONS);
+    }
 }
 
 template <typename ScalarParam>
@@ -243,8 +240,10 @@ Vector<ScalarParam>::Vector(std::vector<ScalarParam> const& v)
     {
         components[i] = v[i];
     }
-    allocations += 1;
-	std::cout << "copyvector Allocations " << allocations << std::endl;    
+    if (dimension > 0)
+    {
+        Counters::add(Counters::ALLOCATIONS);
+    }
 }
 
 template <typename ScalarParam>
@@ -2,9 +2,11 @@
 #include <algorithm>
 
 #include "ExperimentDialog.h"
+#include "FieldViewer.h"
 #include "GLMotif/WidgetFactory.h"
 #include "VruiStreamManip.h"
 #include "Dynamics/Coordinate.h"
+#include "Dynamics/Trace.h"
 
 GLMotif::PopupWindow* ExperimentDialog::createDialog()
 {
@@ -134,6 +136,8 @@ GLMotif::PopupWindow* ExperimentDialog::createDialog()
     
 void ExperimentDialog::sliderModelCallback(GLMotif::Slider::ValueChangedCallbackData* cbData)
 {
+    DTS_TRACE_SCOPE("ExperimentDialog::sliderModelCallback");
+
     double value = cbData->value;
 
     char buff[10];
@@ -145,6 +149,7 @@ void ExperimentDialog::sliderModelCallback(GLMotif::Slider::ValueChangedCallback
         if ( strcmp( cbData->slider->getName(), (*itr)->getName() ) == 0 )
         {
             (*itr)->setString(buff);
+            viewer->finishSimulationStep();
             experiment->model->setRealParamValue(cbData->slider->getName(), value);
             break;
         }
@@ -153,6 +158,8 @@ void ExperimentDialog::sliderModelCallback(GLMotif::Slider::ValueChangedCallback
 
 void ExperimentDialog::sliderIntegratorCallback(GLMotif::Slider::ValueChangedCallbackData* cbData)
 {
+    DTS_TRACE_SCOPE("ExperimentDialog::sliderIntegratorCallback");
+
     double value = cbData->value;
 
     char buff[10];
@@ -165,6 +172,7 @@ void ExperimentDialog::sliderIntegratorCallback(GLMotif::Slider::ValueChangedCal
         {
             (*itr)->setString(buff);
             // need to try catch here...round off errors cause failure
+            viewer->finishSimulationStep();
             experiment->integrator->setRealParamValue(cbData->slider->getName(), value);
             break;
         }
@@ -173,6 +181,8 @@ void ExperimentDialog::sliderIntegratorCallback(GLMotif::Slider::ValueChangedCal
 
 void ExperimentDialog::sliderTransformerCallback(GLMotif::Slider::ValueChangedCallbackData* cbData)
 {
+    DTS_TRACE_SCOPE("ExperimentDialog::sliderTransformerCallback");
+
     int value = static_cast<int>(cbData->value);
     
     char buff[10];
@@ -184,6 +194,7 @@ void ExperimentDialog::sliderTransformerCallback(GLMotif::Slider::ValueChangedCa
         if ( strcmp( cbData->slider->getName(), (*itr)->getName() ) == 0 )
         {   
             std::string displayParamName = cbData->slider->getName();
+            viewer->finishSimulationStep();
             experiment->transformer->setIntParamValue(displayParamName, value);
             (*itr)->setString( experiment->transformer->getParameterDisplay(displayParamName).c_str() );
             break;
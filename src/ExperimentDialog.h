@@ -9,10 +9,13 @@
 #include "Dynamics/Experiment.h"
 #include "CaveDialog.h"
 
+class Viewer;
+
 class ExperimentDialog : public CaveDialog
 {
 private:
     Experiment<double>* experiment;
+    Viewer* viewer; ///< Owns the simulation thread that the parameter changes wait for.
 
     std::vector<GLMotif::Slider *> sliders;
     std::vector<GLMotif::TextField *> textFields;  
@@ -31,8 +34,8 @@ public:
     typedef ParameterClass<double>::RealParameters RealParameters;
     typedef ParameterClass<double>::IntParameters IntParameters;    
 
-    ExperimentDialog(GLMotif::PopupMenu *parentMenu, Experiment<double>* e)
-    : CaveDialog(parentMenu), experiment(e)
+    ExperimentDialog(GLMotif::PopupMenu *parentMenu, Experiment<double>* e, Viewer* v)
+    : CaveDialog(parentMenu), experiment(e), viewer(v)
     {
         dialogWindow = createDialog();
     }
@@ -1,20 +1,25 @@
 #ifndef FLOW_BOUALIZEXPERIMENT
 #define FLOW_BOUALIZEXPERIMENT
 
-#include "Experiment.h"
+#include "FixedExperiment.h"
 #include "Models/Bouali.h"
 
-#include "RungeKutta4.h"
+#include "SimdRungeKutta4.h"
+#include "FusedRungeKutta4.h"
+#include "DormandPrince45.h"
+#include "AdamsBashforthMoulton4.h"
 #include "ProjectionTransformer.h"
 
-class BoualiExperiment : public Experiment<double>
+class BoualiExperiment : public FixedExperiment<BoualiModel, 4>
 {
 public:
-    BoualiExperiment() : Experiment<double>()
+    BoualiExperiment() : FixedExperiment<BoualiModel, 4>()
     {
-        model = new Bouali();
-
-        addIntegrator( new RungeKutta4(*model, .01) );
+        RungeKutta4* rk4 = new SimdRungeKutta4<Bouali, 4>(*model, .01);
+        addIntegrator( rk4 );
+        addStepper( rk4, new FusedRungeKutta4<Bouali, 4>(*model, *rk4) );
+        addIntegrator( new DormandPrince45(*model, .01) );
+        addIntegrator( new AdamsBashforthMoulton4(*model, .01) );
         setIntegrator("rk4");
 
         addTransformer( new ProjectionTransformer<double>(*model) );
@@ -1,20 +1,25 @@
 #ifndef DTS_LORENZEXPERIMENT
 #define DTS_LORENZEXPERIMENT
 
-#include "Experiment.h"
+#include "FixedExperiment.h"
 #include "Models/Lorenz.h"
 
-#include "RungeKutta4.h"
+#include "SimdRungeKutta4.h"
+#include "FusedRungeKutta4.h"
+#include "DormandPrince45.h"
+#include "AdamsBashforthMoulton4.h"
 #include "ProjectionTransformer.h"
 
-class LorenzExperiment : public Experiment<double>
+class LorenzExperiment : public FixedExperiment<LorenzModel, 4>
 {
 public:
-    LorenzExperiment() : Experiment<double>()
+    LorenzExperiment() : FixedExperiment<LorenzModel, 4>()
     {
-        model = new Lorenz();
-
-        addIntegrator( new RungeKutta4(*model, .01) );
+        RungeKutta4* rk4 = new SimdRungeKutta4<Lorenz, 4>(*model, .01);
+        addIntegrator( rk4 );
+        addStepper( rk4, new FusedRungeKutta4<Lorenz, 4>(*model, *rk4) );
+        addIntegrator( new DormandPrince45(*model, .01) );
+        addIntegrator( new AdamsBashforthMoulton4(*model, .01) );
         setIntegrator("rk4");
         
         addTransformer( new ProjectionTransformer<double>(*model) );
@@ -1,20 +1,25 @@
 #ifndef DTS_OWLEXPERIMENT
 #define DTS_OWLEXPERIMENT
 
-#include "Experiment.h"
+#include "FixedExperiment.h"
 #include "Models/Owl.h"
 
-#include "RungeKutta4.h"
+#include "SimdRungeKutta4.h"
+#include "FusedRungeKutta4.h"
+#include "DormandPrince45.h"
+#include "AdamsBashforthMoulton4.h"
 #include "ProjectionTransformer.h"
 
-class OwlExperiment : public Experiment<double>
+class OwlExperiment : public FixedExperiment<OwlModel, 4>
 {
 public:
-    OwlExperiment() : Experiment<double>()
+    OwlExperiment() : FixedExperiment<OwlModel, 4>()
     {
-        model = new Owl();
-
-        addIntegrator( new RungeKutta4(*model, .01) );
+        RungeKutta4* rk4 = new SimdRungeKutta4<Owl, 4>(*model, .01);
+        addIntegrator( rk4 );
+        addStepper( rk4, new FusedRungeKutta4<Owl, 4>(*model, *rk4) );
+        addIntegrator( new DormandPrince45(*model, .01) );
+        addIntegrator( new AdamsBashforthMoulton4(*model, .01) );
         setIntegrator("rk4");
         
         addTransformer( new ProjectionTransformer<double>(*model) );
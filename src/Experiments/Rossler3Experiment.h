@@ -1,20 +1,25 @@
 #ifndef DTS_ROSSLER3EXPERIMENT
 #define DTS_ROSSLER3EXPERIMENT
 
-#include "Experiment.h"
+#include "FixedExperiment.h"
 #include "Models/Rossler3.h"
 
-#include "RungeKutta4.h"
+#include "SimdRungeKutta4.h"
+#include "FusedRungeKutta4.h"
+#include "DormandPrince45.h"
+#include "AdamsBashforthMoulton4.h"
 #include "ProjectionTransformer.h"
 
-class Rossler3Experiment : public Experiment<double>
+class Rossler3Experiment : public FixedExperiment<Rossler3Model, 4>
 {
 public:
-    Rossler3Experiment() : Experiment<double>()
+    Rossler3Experiment() : FixedExperiment<Rossler3Model, 4>()
     {
-        model = new Rossler3();
-
-        addIntegrator( new RungeKutta4(*model, .1) );
+        RungeKutta4* rk4 = new SimdRungeKutta4<Rossler3, 4>(*model, .1);
+        addIntegrator( rk4 );
+        addStepper( rk4, new FusedRungeKutta4<Rossler3, 4>(*model, *rk4) );
+        addIntegrator( new DormandPrince45(*model, .1) );
+        addIntegrator( new AdamsBashforthMoulton4(*model, .1) );
         setIntegrator("rk4");
         
         addTransformer( new ProjectionTransformer<double>(*model) );
@@ -1,20 +1,25 @@
 #ifndef DTS_ROSSLER4EXPERIMENT
 #define DTS_ROSSLER4EXPERIMENT
 
-#include "Experiment.h"
+#include "FixedExperiment.h"
 #include "Models/Rossler4.h"
 
-#include "RungeKutta4.h"
+#include "SimdRungeKutta4.h"
+#include "FusedRungeKutta4.h"
+#include "DormandPrince45.h"
+#include "AdamsBashforthMoulton4.h"
 #include "ProjectionTransformer.h"
 
-class Rossler4Experiment : public Experiment<double>
+class Rossler4Experiment : public FixedExperiment<Rossler4Model, 5>
 {
 public:
-    Rossler4Experiment() : Experiment<double>()
+    Rossler4Experiment() : FixedExperiment<Rossler4Model, 5>()
     {
-        model = new Rossler4();
-
-        addIntegrator( new RungeKutta4(*model, .02) );
+        RungeKutta4* rk4 = new SimdRungeKutta4<Rossler4, 5>(*model, .02);
+        addIntegrator( rk4 );
+        addStepper( rk4, new FusedRungeKutta4<Rossler4, 5>(*model, *rk4) );
+        addIntegrator( new DormandPrince45(*model, .02) );
+        addIntegrator( new AdamsBashforthMoulton4(*model, .02) );
         setIntegrator("rk4");
         
         ProjectionTransformer<double> *t;
@@ -20,7 +20,9 @@
 
 #include <algorithm>
 #include <iostream>
+#include <sstream>
 #include <cmath>
+#include <unistd.h>
 
 #include <Vrui/Vrui.h>
 #include <Vrui/Geometry.h>
@@ -46,9 +48,13 @@
 #include "Tools/DotSpreaderTool.h"
 #include "Tools/DynamicSolverTool.h"
 #include "Tools/ParticleSprayerTool.h"
+#include "Tools/PoincareSectionTool.h"
 #include "Tools/StaticSolverTool.h"
+#include "Tools/SweepViewerTool.h"
 
 #include "Directory.h"
+#include "ModelCompiler.h"
+#include "Dynamics/Trace.h"
 
 ExperimentFactory Factory;
 
@@ -100,11 +106,31 @@ Viewer::Viewer(int &argc, char** argv, char** appDefaults) :
    toolbox(0),
    elapsedTime(0.0),
    absoluteTime(0.0),
+   simulationStepDue(false),
+   simulationStepping(false),
+   simulationThreadRunning(false),
+   threadPool(DTS::ThreadPool::getNumProcessors()),
+   traceFilePrefix("flow-trace"),
    masterout(std::cout), nodeout(std::cout), debugout(std::cerr),
    showingLogo(false),
    firstTime(true),
    startLogo(true)
 {
+    DTS::Trace::setThreadName("main");
+
+    // parse the arguments left over by Vrui
+    for (int i=1; i < argc; i++)
+    {
+        if (std::string(argv[i]) == "-trace")
+        {
+            // trace from startup, the optional argument is the file prefix
+            if (i + 1 < argc and argv[i + 1][0] != '-')
+            {
+                traceFilePrefix=argv[++i];
+            }
+            DTS::Trace::setEnabled(true);
+        }
+    }
 
     // load ToolBox
     ToolBox::ToolBoxFactory::instance();
@@ -142,6 +168,14 @@ Viewer::Viewer(int &argc, char** argv, char** appDefaults) :
 
 Viewer::~Viewer()
 {
+    stopSimulationThread();
+
+    if (DTS::Trace::isEnabled())
+    {
+        DTS::Trace::setEnabled(false);
+        writeTrace();
+    }
+
     delete mainMenu;
 
     if (experimentDialog != NULL) delete experimentDialog;
@@ -270,6 +304,7 @@ void Viewer::stepLogo()
     if (firstTime)
     {
         /* Spread some particles */
+        finishSimulationStep();
         experiment->integrator->setRealParamValue("stepSize", .01);
         std::map<std::string, AbstractDynamicsTool*>::iterator it = toolmap.find("DotSpreaderTool");
         if (it != toolmap.end())
@@ -294,6 +329,9 @@ void Viewer::stepLogo()
 
     }
 
+	// the simulation thread may be stepping with the step size
+	finishSimulationStep();
+
 	double oldValue = experiment->integrator->getRealParamValue("stepSize");
 	double newValue = .9999 * oldValue;
 	if (newValue < .0001)
@@ -316,6 +354,8 @@ void Viewer::setRadioToggles(ToggleArray& toggles, const std::string& name)
 
 std::vector<std::string> Viewer::loadPlugins() throw(std::runtime_error)
 {
+    DTS_TRACE_SCOPE("Viewer::loadPlugins");
+
     std::string directory( getResourceDir() );
     directory += "/plugins";
 
@@ -347,6 +387,32 @@ std::vector<std::string> Viewer::loadPlugins() throw(std::runtime_error)
         dl_list.insert(dl_list.end(), dlib);
     }
 
+    // Compile the model description files, plugins built for an unchanged
+    // description are reused from the cache.
+    ModelCompiler compiler(ModelCompiler::writableCacheDirectory(directory + "/models"));
+    std::string includeDirectory( getResourceDir() + "/include" );
+    if (access(includeDirectory.c_str(), R_OK) != 0)
+    {
+        // running from the source tree
+        includeDirectory = "src";
+    }
+    compiler.addIncludeDirectory(includeDirectory);
+
+    std::vector<std::string> models = compiler.compileDirectory(getResourceDir() + "/models");
+    for (lib=models.begin(); lib != models.end(); ++lib)
+    {
+        std::cout << "\tOpening " << *lib << "..." << std::endl;
+
+        dlib=dlopen(lib->c_str(), RTLD_NOW);
+
+        if (dlib == NULL)
+        {
+            throw std::runtime_error(dlerror());
+        }
+
+        dl_list.insert(dl_list.end(), dlib);
+    }
+
     // create an array of model names
     std::vector<std::string> experiment_names;
     ExperimentFactory::iterator itr;
@@ -392,6 +458,8 @@ void Viewer::initContext(GLContextData& contextData) const
 
 void Viewer::display(GLContextData& contextData) const
 {
+    DTS_TRACE_SCOPE("Viewer::display");
+
     if(showingLogo)
     {
         drawLogo(contextData);
@@ -416,6 +484,8 @@ void Viewer::renderTools(DTS::DataItem* dataItem) const
       }
       else
       {
+         DTS_TRACE_SCOPE((*tool)->getRenderTraceName());
+         DTS::Counters::ScopedTimer timer((*tool)->getRenderCounter());
          (*tool)->render(dataItem);
       }
    }
@@ -423,10 +493,13 @@ void Viewer::renderTools(DTS::DataItem* dataItem) const
 
 void Viewer::frame()
 {
+   DTS_TRACE_SCOPE("Viewer::frame");
+
    // frame rate
    double frameTime = Vrui::getCurrentFrameTime();
    double throttledFrameRate = frameRateDialog->getThrottledFrameRate();
    frameRateDialog->setFrameRate(1.0/frameTime);
+   frameRateDialog->updateCounters(frameTime);
    elapsedTime += frameTime;
    absoluteTime += frameTime;
 
@@ -475,6 +548,13 @@ void Viewer::frame()
        experiment->updateVersion();
    }
 
+   // the tools below use the integrator on this thread, which must wait
+   // for the simulation thread if they cannot share it
+   if (!experiment->integrator->isReentrant())
+   {
+       finishSimulationStep();
+   }
+
    // iterate over all tools and do required processing
    for (ToolList::iterator tool=tools.begin(); tool != tools.end(); ++tool)
    {
@@ -497,16 +577,39 @@ void Viewer::frame()
         {
             if (updatedExperiment)
             {
+              DTS_TRACE_SCOPE((*tool)->getUpdateTraceName());
               (*tool)->updatedExperiment();
             }
 
             if (stepTools)
             {
-             (*tool)->step();
+                if (simulationThreadRunning && (*tool)->stepsAsynchronously())
+                {
+                    pendingSimulationTools.push_back(*tool);
+                }
+                else
+                {
+                    Threads::Mutex::Lock lock((*tool)->getDataMutex());
+                    DTS_TRACE_SCOPE((*tool)->getStepTraceName());
+                    DTS::Counters::ScopedTimer timer((*tool)->getStepCounter());
+                    (*tool)->step();
+                }
             }
+
+            (*tool)->frame();
         }
     }
 
+    // hand the remaining tools to the simulation thread
+    if (simulationThreadRunning && stepTools)
+    {
+        Threads::Mutex::Lock lock(simulationMutex);
+        simulationTools.swap(pendingSimulationTools);
+        simulationStepDue = true;
+        simulationCond.signal();
+    }
+    pendingSimulationTools.clear();
+
     if (startLogo && !showingLogo)
     {
         /* Need to figure this out. We cannot start spreading dots until
@@ -552,6 +655,105 @@ void Viewer::endLogo()
    }
 }
 
+/*
+   The simulation thread runs the step() calls of tools that publish their
+   particles through a TripleBuffer, so a slow step no longer holds up
+   rendering. Steps are still requested by frame() at the throttled frame
+   rate; if a step takes longer than a frame, requests are merged and the
+   renderer keeps drawing the last published particles.
+
+   Since steps are no longer tied to frames, cluster nodes may draw
+   slightly different simulation states, so the thread is off by default.
+*/
+void Viewer::startSimulationThread()
+{
+    if (simulationThreadRunning)
+    {
+        return;
+    }
+
+    simulationStepDue = false;
+    simulationThreadRunning = true;
+    simulationThread.start(this, &Viewer::simulationThreadMethod);
+}
+
+void Viewer::stopSimulationThread()
+{
+    if (!simulationThreadRunning)
+    {
+        return;
+    }
+
+    {
+        Threads::Mutex::Lock lock(simulationMutex);
+        simulationThreadRunning = false;
+        simulationCond.signal();
+    }
+
+    // wait for the current step to finish
+    simulationThread.join();
+    simulationTools.clear();
+}
+
+void* Viewer::simulationThreadMethod()
+{
+    DTS::Trace::setThreadName("simulation");
+
+    ToolList stepping;
+
+    while (true)
+    {
+        {
+            Threads::Mutex::Lock lock(simulationMutex);
+            while (!simulationStepDue && simulationThreadRunning)
+            {
+                simulationCond.wait(simulationMutex);
+            }
+
+            if (!simulationThreadRunning)
+            {
+                break;
+            }
+
+            simulationStepDue = false;
+            simulationStepping = true;
+            stepping.swap(simulationTools);
+        }
+
+        for (ToolList::iterator tool=stepping.begin(); tool != stepping.end(); ++tool)
+        {
+            Threads::Mutex::Lock lock((*tool)->getDataMutex());
+            DTS_TRACE_SCOPE((*tool)->getStepTraceName());
+            DTS::Counters::ScopedTimer timer((*tool)->getStepCounter());
+            (*tool)->step();
+        }
+
+        {
+            Threads::Mutex::Lock lock(simulationMutex);
+            simulationStepping = false;
+            simulationIdleCond.signal();
+        }
+    }
+
+    return 0;
+}
+
+void Viewer::finishSimulationStep()
+{
+    if (!simulationThreadRunning)
+    {
+        return;
+    }
+
+    DTS_TRACE_SCOPE("Viewer::finishSimulationStep");
+
+    Threads::Mutex::Lock lock(simulationMutex);
+    while (simulationStepDue || simulationStepping)
+    {
+        simulationIdleCond.wait(simulationMutex);
+    }
+}
+
 void Viewer::updateToolToggles()
 {
    // loop over toggle buttons
@@ -701,6 +903,34 @@ void Viewer::toolCreationCallback(Vrui::ToolManager::ToolCreationCallbackData* c
 
       toolmap["DynamicSolverTool"]=tool;
 
+      masterout() << "\tAdding Poincare Section..." << std::endl;
+
+      tool=new PoincareSectionTool(toolBox, this);
+      if (experiment != NULL) tool->setExperiment(experiment);
+      tools.push_back(tool);
+      // create associated options dialog and add to dialog array
+      optionsDialogs.push_back(tool->createOptionsDialog(mainMenu));
+
+      toolmap["PoincareSectionTool"]=tool;
+
+      masterout() << "\tAdding Sweep Viewer..." << std::endl;
+
+      tool=new SweepViewerTool(toolBox, this);
+      if (experiment != NULL) tool->setExperiment(experiment);
+      tools.push_back(tool);
+      // create associated options dialog and add to dialog array
+      optionsDialogs.push_back(tool->createOptionsDialog(mainMenu));
+
+      toolmap["SweepViewerTool"]=tool;
+
+      // time each tool under its name in the frame rate dialog, and seed
+      // its random numbers from the name
+      for (std::map<std::string, AbstractDynamicsTool*>::iterator it=toolmap.begin(); it != toolmap.end(); ++it)
+      {
+         it->second->setProfilingName(it->first);
+         it->second->setRandomSeed(DTS::Random::hash(it->first));
+      }
+
       // automatically load the first tool and set options dialog
       AbstractDynamicsTool* currentTool = static_cast<AbstractDynamicsTool*>(tools.front());
       currentTool->grab();
@@ -728,6 +958,9 @@ void Viewer::toolDestructionCallback(Vrui::ToolManager::ToolDestructionCallbackD
    ToolBox::ToolBox* toolBox=dynamic_cast<ToolBox::ToolBox*> (cbData->tool);
    if (toolBox != 0 && toolBox == toolbox)
    {
+      // the simulation thread must not step the tools any longer
+      stopSimulationThread();
+
       // need to fix this to handle multiple users each with their own toolbox
       tools.clear();
       toolmap.clear();
@@ -739,6 +972,8 @@ void Viewer::toolDestructionCallback(Vrui::ToolManager::ToolDestructionCallbackD
 
 void Viewer::resetNavigationCallback(Misc::CallbackData* cbData)
 {
+    DTS_TRACE_SCOPE("Viewer::resetNavigationCallback");
+
     if (showingLogo)
     {
         // ignore this request
@@ -766,6 +1001,8 @@ void Viewer::resetView()
 
 void Viewer::mainMenuTogglesCallback(GLMotif::ToggleButton::ValueChangedCallbackData *cbData)
 {
+   DTS_TRACE_SCOPE("Viewer::mainMenuTogglesCallback");
+
    std::string name=cbData->toggle->getName();
 
    if (name == "ShowParameterDialogToggle")
@@ -832,13 +1069,60 @@ void Viewer::mainMenuTogglesCallback(GLMotif::ToggleButton::ValueChangedCallback
          positionDialog->hide();
       }
    }
+   else if (name == "SimulationThreadToggle")
+   {
+      // if toggle is set step the particle tools on the simulation thread
+      if (cbData->toggle->getToggle())
+      {
+         startSimulationThread();
+      }
+      else
+      {
+         stopSimulationThread();
+      }
+   }
+   else if (name == "TraceToggle")
+   {
+      // if toggle is set start a new trace, otherwise write the trace to disk
+      if (cbData->toggle->getToggle())
+      {
+         DTS::Trace::setEnabled(true);
+      }
+      else
+      {
+         DTS::Trace::setEnabled(false);
+         writeTrace();
+      }
+   }
+   else
+   {
+   }
+}
+
+void Viewer::writeTrace() const
+{
+   // every cluster node writes its own file, with the node index as process id
+   int node=Vrui::getNodeIndex();
+   std::ostringstream fileName;
+   fileName << traceFilePrefix << "-node" << node << ".json";
+
+   std::ostringstream processName;
+   processName << "flow node " << node;
+
+   if (DTS::Trace::write(fileName.str(), node, processName.str()))
+   {
+      std::cout << "Wrote trace " << fileName.str() << std::endl;
+   }
    else
    {
+      std::cerr << "ERROR: Could not write trace " << fileName.str() << std::endl;
    }
 }
 
 void Viewer::dynamicsMenuCallback(GLMotif::ToggleButton::ValueChangedCallbackData *cbData)
 {
+   DTS_TRACE_SCOPE("Viewer::dynamicsMenuCallback");
+
 	std::string name = cbData->toggle->getName();
 	std::string key(name);
 	key.erase( key.find("toggle") );
@@ -880,8 +1164,14 @@ void Viewer::dynamicsMenuCallback(GLMotif::ToggleButton::ValueChangedCallbackDat
 
 void Viewer::setExperiment(std::string name, bool updateToggle)
 {
+   DTS_TRACE_SCOPE("Viewer::setExperiment");
+
    bool popup=false;
 
+   // the tools may not step while the experiment is replaced
+   bool restartSimulationThread=simulationThreadRunning;
+   stopSimulationThread();
+
    // delete current dynamical model
    if (experiment != NULL)
       delete experiment;
@@ -910,9 +1200,10 @@ void Viewer::setExperiment(std::string name, bool updateToggle)
 
    // create the dynamical model
    experiment = Factory[name]();
+   experiment->setMaker(Factory[name]);
 
    // create/assign parameter dialog
-   experimentDialog = new ExperimentDialog(mainMenu, experiment);
+   experimentDialog = new ExperimentDialog(mainMenu, experiment, this);
    if (dialogExisted)
    {
         experimentDialog->setTransformation(oldTrans);
@@ -928,6 +1219,9 @@ void Viewer::setExperiment(std::string name, bool updateToggle)
       (*toolItr)->setExperiment(experiment);
    }
 
+   if (restartSimulationThread)
+      startSimulationThread();
+
    // fake radio-button behavior
    if (updateToggle)
        setRadioToggles(dynamicsToggleButtons, name + "toggle");
@@ -935,6 +1229,8 @@ void Viewer::setExperiment(std::string name, bool updateToggle)
 
 void Viewer::toolsMenuCallback(GLMotif::ToggleButton::ValueChangedCallbackData *cbData)
 {
+   DTS_TRACE_SCOPE("Viewer::toolsMenuCallback");
+
    AbstractDynamicsTool* tool;
 
    // If we are showing the logo, we ignore their request and revert the toggle.
@@ -999,6 +1295,32 @@ void Viewer::toolsMenuCallback(GLMotif::ToggleButton::ValueChangedCallbackData *
          tool->setDisabled(!state);
      }
   }
+  else if (name == "PoincareSectionToggle")
+  {
+     if (showingLogo || toolbox == 0)
+     {
+        cbData->toggle->setToggle( !cbData->toggle->getToggle() );
+     }
+     else
+     {
+         tool=toolmap["PoincareSectionTool"];
+         bool state=tool->isDisabled();
+         tool->setDisabled(!state);
+     }
+  }
+  else if (name == "SweepViewerToggle")
+  {
+     if (showingLogo || toolbox == 0)
+     {
+        cbData->toggle->setToggle( !cbData->toggle->getToggle() );
+     }
+     else
+     {
+         tool=toolmap["SweepViewerTool"];
+         bool state=tool->isDisabled();
+         tool->setDisabled(!state);
+     }
+  }
   else
   {
   }
@@ -25,6 +25,9 @@
 #include <Vrui/Application.h>
 #include <GL/GLObject.h>
 #include <IO/OpenFile.h>
+#include <Threads/Thread.h>
+#include <Threads/Mutex.h>
+#include <Threads/Cond.h>
 
 // STL includes
 //
@@ -36,6 +39,7 @@
 
 #include "Experiment.h"
 #include "Factory.h"
+#include "Dynamics/ThreadPool.h"
 #include "Tools/AbstractDynamicsTool.h"
 #include "PositionDialog.h"
 #include "FrameRateDialog.h"
@@ -84,6 +88,26 @@ class Viewer: public Vrui::Application, public GLObject
        */
       void updateCurrentOptionsDialog();
 
+      /** Wait until the simulation thread has no step in progress or due.
+       *
+       *  Steps are only handed to the simulation thread by frame(), so
+       *  until the next frame() the main thread may change the parameters
+       *  of the experiment, which the steps read. Returns at once if the
+       *  thread is not running.
+       */
+      void finishSimulationStep();
+
+      /** The worker threads of the tools' data-parallel loops.
+       *
+       *  One pool for all tools, so that tools stepping at the same time
+       *  do not each start a thread per processor. Each tool may cap the
+       *  threads it uses with its Threads slider.
+       */
+      DTS::ThreadPool& getThreadPool()
+      {
+         return threadPool;
+      }
+
       /* Callbacks */
       virtual void toolCreationCallback(Vrui::ToolManager::ToolCreationCallbackData* cbData);
       virtual void toolDestructionCallback(Vrui::ToolManager::ToolDestructionCallbackData* cbData);
@@ -125,6 +149,23 @@ class Viewer: public Vrui::Application, public GLObject
       double elapsedTime; // Cummulative time between frames (that is reset frequently)
       double absoluteTime;
 
+      /* Optional thread that steps tools which support it (see AbstractDynamicsTool::stepsAsynchronously) */
+      Threads::Thread simulationThread;
+      Threads::Mutex simulationMutex; ///< Guards simulationTools, simulationStepDue and simulationStepping.
+      Threads::Cond simulationCond; ///< Signaled when a step is due or the thread should exit.
+      Threads::Cond simulationIdleCond; ///< Signaled when the simulation thread finished a step.
+      ToolList simulationTools; ///< Tools to step when simulationStepDue is set.
+      ToolList pendingSimulationTools; ///< Collected by frame() before handing them over.
+      bool simulationStepDue;
+      bool simulationStepping; ///< Set while the simulation thread steps tools.
+      bool simulationThreadRunning; ///< Only changed by the main thread.
+
+      DTS::ThreadPool threadPool; ///< Shared by all tools, see getThreadPool().
+
+      /* Timeline tracing (see DTS::Trace), toggled from the main menu or -trace */
+      std::string traceFilePrefix; ///< Trace of node n is written to <prefix>-node<n>.json.
+      void writeTrace() const;
+
       /* Output streams */
       master::filter masterout;
       node::filter nodeout;
@@ -149,8 +190,10 @@ class Viewer: public Vrui::Application, public GLObject
       /** Internal method for loading plugins (dlls).
        *
        * Searches the plugins directory for dynamic libraries. Each library
-       * that is found is then loaded into memory. An exception is thrown
-       * if a library fails to load.
+       * that is found is then loaded into memory. The model description
+       * files in the models directory are compiled into plugins (see
+       * ModelCompiler) and loaded as well. An exception is thrown if a
+       * library fails to load.
        *
        * \return An array of the names of all plugins.
        */
@@ -163,6 +206,10 @@ class Viewer: public Vrui::Application, public GLObject
       virtual bool loadViewpointFile(IO::Directory& directory,const char* viewpointFileName);
       void beginLogo();
       void endLogo();
+
+      void startSimulationThread();
+      void stopSimulationThread();
+      void* simulationThreadMethod();
 };
 
 #endif
@@ -60,6 +60,15 @@ GLMotif::PopupMenu* Viewer::createMainMenu()
 
    showOptionsDialogs->getSelectCallbacks().add(this, &Viewer::mainMenuTogglesCallback);
 
+   // create a toggle for stepping particle tools on a separate thread
+   GLMotif::ToggleButton* simulationThreadToggle=factory.createToggleButton("SimulationThreadToggle", "Simulation Thread");
+   simulationThreadToggle->getSelectCallbacks().add(this, &Viewer::mainMenuTogglesCallback);
+
+   // create a toggle for recording a timeline trace, written when switched off
+   GLMotif::ToggleButton* traceToggle=factory.createToggleButton("TraceToggle", "Record Trace");
+   traceToggle->setToggle(DTS::Trace::isEnabled());
+   traceToggle->getSelectCallbacks().add(this, &Viewer::mainMenuTogglesCallback);
+
    // create a push button for reseting the view
    GLMotif::Button* resetNavigationButton=factory.createButton("ResetNavigationButton", "Reset Navigation");
    resetNavigationButton->getSelectCallbacks().add(this, &Viewer::resetNavigationCallback);
@@ -122,18 +131,24 @@ GLMotif::Popup* Viewer::createToolsTogglesMenu()
    GLMotif::ToggleButton* dotSpreaderToggle=factory.createToggleButton("DotSpreaderToggle", "Dot Spreader", true);
    GLMotif::ToggleButton* staticSolverToggle=factory.createToggleButton("StaticSolverToggle", "Static Solver", true);
    GLMotif::ToggleButton* dynamicSolverToggle=factory.createToggleButton("DynamicSolverToggle", "Dynamic Solver", true);
+   GLMotif::ToggleButton* poincareSectionToggle=factory.createToggleButton("PoincareSectionToggle", "Poincare Section", true);
+   GLMotif::ToggleButton* sweepViewerToggle=factory.createToggleButton("SweepViewerToggle", "Sweep Viewer", true);
 
    // assign callbacks for each toggle button
    particleSprayerToggle->getValueChangedCallbacks().add(this, &Viewer::toolsMenuCallback);
    dotSpreaderToggle->getValueChangedCallbacks().add(this, &Viewer::toolsMenuCallback);
    staticSolverToggle->getValueChangedCallbacks().add(this, &Viewer::toolsMenuCallback);
    dynamicSolverToggle->getValueChangedCallbacks().add(this, &Viewer::toolsMenuCallback);
+   poincareSectionToggle->getValueChangedCallbacks().add(this, &Viewer::toolsMenuCallback);
+   sweepViewerToggle->getValueChangedCallbacks().add(this, &Viewer::toolsMenuCallback);
 
    // add toggle button pointers to vector for radio-button behavior
    toolsToggleButtons.push_back(particleSprayerToggle);
    toolsToggleButtons.push_back(dotSpreaderToggle);
    toolsToggleButtons.push_back(staticSolverToggle);
    toolsToggleButtons.push_back(dynamicSolverToggle);
+   toolsToggleButtons.push_back(poincareSectionToggle);
+   toolsToggleButtons.push_back(sweepViewerToggle);
 
    toolsTogglesMenu->manageChild();
 
@@ -1,3 +1,4 @@
+
 #include <sstream>
 #include <iostream>
 
@@ -7,12 +8,16 @@
 
 #include "GLMotif/WidgetFactory.h"
 #include "VruiStreamManip.h"
+#include "Dynamics/Trace.h"
 
 GLMotif::PopupWindow* FrameRateDialog::createDialog()
 {
   WidgetFactory factory;
   GLMotif::PopupWindow* frameRateDialogPopup = factory.createPopupWindow("FrameRateDialogPopup", "Frame Rate Dialog");
 
+  GLMotif::RowColumn* frameRateDialogLayout = factory.createRowColumn("FrameRateDialogLayout", 1);
+  factory.setLayout(frameRateDialogLayout);
+
   GLMotif::RowColumn* frameRateDialog = factory.createRowColumn("FrameRateDialog", 3);
   factory.setLayout(frameRateDialog);
 
@@ -29,12 +34,55 @@ GLMotif::PopupWindow* FrameRateDialog::createDialog()
   throttledFrameRateSlider->setValue(120.0);
   throttledFrameRateSlider->getValueChangedCallbacks().add(this, &FrameRateDialog::sliderCallback);
 
+  factory.createLabel("RecordLabel", "Counters CSV");
+  GLMotif::TextField* csvFileField = factory.createTextField("CsvFileName", 10);
+  csvFileField->setString(csvFileName.c_str());
+  recordToggle = factory.createCheckBox("RecordToggle", "Record", false);
+  recordToggle->getValueChangedCallbacks().add(this, &FrameRateDialog::recordCallback);
+
   frameRateDialog->manageChild();
+
+  // one row per counter: name, growth in the last frame, total
+  factory.setLayout(frameRateDialogLayout);
+  countersLayout = factory.createRowColumn("CountersLayout", 3);
+  factory.setLayout(countersLayout);
+
+  factory.createLabel("CounterHeader", "Counter");
+  factory.createLabel("FrameHeader", "Frame");
+  factory.createLabel("TotalHeader", "Total");
+  addCounterRows();
+
+  countersLayout->manageChild();
+  frameRateDialogLayout->manageChild();
   return frameRateDialogPopup;
 }
 
+void FrameRateDialog::addCounterRows()
+{
+  WidgetFactory factory;
+  factory.setLayout(countersLayout);
+
+  for (int counter = frameFields.size(); counter < DTS::Counters::getNumCounters(); ++counter)
+  {
+    std::ostringstream name;
+    name << "Counter" << counter;
+
+    std::string label = DTS::Counters::getName(counter);
+    if (DTS::Counters::getUnit(counter) == DTS::Counters::BYTES)
+      label += " (KB)";
+    else if (DTS::Counters::getUnit(counter) == DTS::Counters::NANOSECONDS)
+      label += " (ms)";
+
+    factory.createLabel((name.str() + "Label").c_str(), label.c_str());
+    frameFields.push_back(factory.createTextField((name.str() + "Frame").c_str(), 10));
+    totalFields.push_back(factory.createTextField((name.str() + "Total").c_str(), 12));
+  }
+}
+
 void FrameRateDialog::sliderCallback(GLMotif::Slider::ValueChangedCallbackData* cbData)
 {
+  DTS_TRACE_SCOPE("FrameRateDialog::sliderCallback");
+
   throttledFrameRate = cbData->value;
 
   char buff[10];
@@ -46,6 +94,13 @@ void FrameRateDialog::sliderCallback(GLMotif::Slider::ValueChangedCallbackData*
   }
 }
 
+void FrameRateDialog::recordCallback(GLMotif::ToggleButton::ValueChangedCallbackData* cbData)
+{
+  DTS_TRACE_SCOPE("FrameRateDialog::recordCallback");
+
+  setRecording(cbData->set);
+}
+
 void FrameRateDialog::setFrameRate(double frameRate)
 {
   char buff[10];
@@ -59,4 +114,91 @@ double FrameRateDialog::getThrottledFrameRate()
   return throttledFrameRate;
 }
 
+void FrameRateDialog::updateCounters(double frameTime)
+{
+  DTS::Counters::read(totals);
+  lastTotals.resize(totals.size(), 0);
+  ++frameNumber;
+
+  if (frameFields.size() < totals.size())
+    addCounterRows();
+
+  for (size_t counter = 0; counter < frameFields.size() && counter < totals.size(); ++counter)
+  {
+    DTS::Counters::Value frame = totals[counter] - lastTotals[counter];
+
+    // bytes in KB and nanoseconds in milliseconds
+    char frameBuff[32];
+    char totalBuff[32];
+    switch (DTS::Counters::getUnit(counter))
+    {
+      case DTS::Counters::BYTES:
+        snprintf(frameBuff, sizeof(frameBuff), "%.1f", frame / 1024.0);
+        snprintf(totalBuff, sizeof(totalBuff), "%.0f", totals[counter] / 1024.0);
+        break;
+      case DTS::Counters::NANOSECONDS:
+        snprintf(frameBuff, sizeof(frameBuff), "%.2f", frame * 1e-6);
+        snprintf(totalBuff, sizeof(totalBuff), "%.0f", totals[counter] * 1e-6);
+        break;
+      default:
+        snprintf(frameBuff, sizeof(frameBuff), "%llu", frame);
+        snprintf(totalBuff, sizeof(totalBuff), "%llu", totals[counter]);
+        break;
+    }
+    frameFields[counter]->setString(frameBuff);
+    totalFields[counter]->setString(totalBuff);
+  }
+
+  if (csvFile.is_open())
+    writeCsvRow(frameTime);
+
+  lastTotals.swap(totals);
+}
+
+void FrameRateDialog::setRecording(bool record)
+{
+  if (csvFile.is_open())
+    csvFile.close();
+
+  recordToggle->setToggle(record);
+
+  // only the master node writes, the slaves count the same frames
+  if (!record || !Vrui::isMaster())
+    return;
+
+  csvFile.open(csvFileName.c_str(), std::ios::out | std::ios::app);
+  if (!csvFile)
+  {
+    std::cerr << "Cannot write counters to " << csvFileName << std::endl;
+    recordToggle->setToggle(false);
+    return;
+  }
+
+  // start with a header
+  csvColumns = 0;
+}
+
+void FrameRateDialog::writeCsvRow(double frameTime)
+{
+  // a new header whenever counters were added
+  if (csvColumns != totals.size())
+  {
+    csvFile << "frame,frame time (ms)";
+    for (size_t counter = 0; counter < totals.size(); ++counter)
+    {
+      csvFile << ",\"" << DTS::Counters::getName(counter);
+      if (DTS::Counters::getUnit(counter) == DTS::Counters::BYTES)
+        csvFile << " (bytes)";
+      else if (DTS::Counters::getUnit(counter) == DTS::Counters::NANOSECONDS)
+        csvFile << " (ns)";
+      csvFile << "\"";
+    }
+    csvFile << "\n";
+    csvColumns = totals.size();
+  }
 
+  csvFile << frameNumber << "," << frameTime * 1000.0;
+  for (size_t counter = 0; counter < totals.size(); ++counter)
+    csvFile << "," << (totals[counter] - lastTotals[counter]);
+  csvFile << "\n";
+}
@@ -1,26 +1,59 @@
 #ifndef FRAMERATEDIALOG_H_
 #define FRAMERATEDIALOG_H_
 
+#include <fstream>
+#include <string>
+#include <vector>
+
 #include <GLMotif/GLMotif>
 #include "CaveDialog.h"
+#include "Dynamics/Counters.h"
 
+/** Frame rate, frame rate throttle and the hot-path counters.
+ *
+ * updateCounters() is called once per frame and shows how much each
+ * DTS::Counters counter grew during the frame, next to its total. Rows for
+ * counters registered later, such as the timers of new tools, are added as
+ * they appear. While "Record" is set, the per-frame values are appended to
+ * a CSV file on the master node.
+ */
 class FrameRateDialog : public CaveDialog
 {
   GLMotif::Slider *throttledFrameRateSlider;
   GLMotif::TextField *currentThrottledFrameRate;
   GLMotif::TextField *currentFrameRate;
+  GLMotif::ToggleButton *recordToggle;
+
+  GLMotif::RowColumn *countersLayout;
+  std::vector<GLMotif::TextField*> frameFields;
+  std::vector<GLMotif::TextField*> totalFields;
 
   double throttledFrameRate;
 
+  std::vector<DTS::Counters::Value> lastTotals;
+  std::vector<DTS::Counters::Value> totals;
+  unsigned long frameNumber;
+
+  std::string csvFileName;
+  std::ofstream csvFile;
+  size_t csvColumns; ///< Counters in the last CSV header.
+
   void sliderCallback(GLMotif::Slider::ValueChangedCallbackData* cbData);
+  void recordCallback(GLMotif::ToggleButton::ValueChangedCallbackData* cbData);
+
+  void addCounterRows();
+  void writeCsvRow(double frameTime);
 
 protected:
   GLMotif::PopupWindow* createDialog();
 
 public:
-  FrameRateDialog(GLMotif::PopupMenu *parentMenu)
+  FrameRateDialog(GLMotif::PopupMenu *parentMenu, const std::string& csvFileName="counters.csv")
      : CaveDialog(parentMenu),
-       throttledFrameRate(60.0)
+       throttledFrameRate(60.0),
+       frameNumber(0),
+       csvFileName(csvFileName),
+       csvColumns(0)
   {
     dialogWindow=createDialog();
   }
@@ -29,7 +62,12 @@ public:
 
   void setFrameRate(double frameRate);
   double getThrottledFrameRate();
+
+  /** Show the counter values of the frame that took frameTime seconds. */
+  void updateCounters(double frameTime);
+
+  /** Start or stop appending the per-frame counter values to the CSV file. */
+  void setRecording(bool record);
 };
 
 #endif
-
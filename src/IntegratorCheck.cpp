@@ -0,0 +1,351 @@
+/*******************************************************************************
+ IntegratorCheck: Headless correctness check of the integrators.
+
+ This file is part of the Dynamics Toolset.
+
+ The Dynamics Toolset is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by the Free
+ Software Foundation, either version 3 of the License, or (at your option) any
+ later version.
+
+ The Dynamics Toolset is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ details.
+
+ You should have received a copy of the GNU General Public License
+ along with the Dynamics Toolset. If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+
+/*
+ Integrates the Lorenz model from (1, 1, 1) over a short time, before the
+ orbits of nearby states separate, and compares the points of
+
+   dopri5  DormandPrince45::integrate() and step()
+   abm4    AdamsBashforthMoulton4::step() with a History
+
+ with "rk4" at a step far smaller than theirs. Each must stay within a
+ tolerance of the reference, and integrating the same state again, after
+ the integrator has computed another orbit, must give the same points.
+
+ For each built-in model, it also compares a batch of states near the
+ default point evaluated and stepped by
+
+   evaluateBatch     DynamicalModel::evaluateBatch()
+   SimdRungeKutta4   the SIMD kernel selected for this CPU
+   FusedRungeKutta4  the stepper of the experiments
+
+ with the scalar operator() and RungeKutta4::step(), and checks DTS::Random
+ against the known-answer vectors of Philox4x32-10 from Random123. Exits
+ with a non-zero status if a check fails:
+
+   integrator_check
+ */
+
+// STL includes
+//
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Project includes
+//
+#include "AdamsBashforthMoulton4.h"
+#include "DormandPrince45.h"
+#include "FusedRungeKutta4.h"
+#include "Random.h"
+#include "RungeKutta4.h"
+#include "SimdRungeKutta4.h"
+#include "Models/Bouali.h"
+#include "Models/Lorenz.h"
+#include "Models/Owl.h"
+#include "Models/Rossler3.h"
+#include "Models/Rossler4.h"
+
+namespace
+{
+
+typedef DTS::Vector<double> Vector;
+typedef LorenzModel<Vector> Model;
+typedef std::vector<Vector> Trajectory;
+
+/// Spacing of the compared points and their number, 2 time units in all.
+const double Interval=0.01;
+const unsigned int NumPoints=201;
+
+/// Steps of the reference per interval.
+const unsigned int ReferenceSteps=100;
+
+/// States of the model batches, not a multiple of any SIMD width, and their stride.
+const size_t BatchSize=13;
+const size_t BatchStride=16;
+
+int failures=0;
+
+Vector startState(double x)
+{
+   Vector state(4);
+   state[0]=x;
+   state[1]=1.0;
+   state[2]=1.0;
+   state[3]=0.0;
+   return state;
+}
+
+/** The reference trajectory, "rk4" at Interval / ReferenceSteps.
+ */
+Trajectory reference(const Model& model, const Vector& start)
+{
+   RungeKutta4 rk4(model, Interval / ReferenceSteps);
+   Trajectory points(NumPoints, start);
+   Vector state=start;
+   Vector step(4);
+   for (unsigned int i=1; i < NumPoints; i++)
+   {
+      for (unsigned int s=0; s < ReferenceSteps; s++)
+      {
+         rk4.step(state, step);
+         state+=step;
+      }
+      points[i]=state;
+   }
+   return points;
+}
+
+/** The trajectory of repeated steps of 'integrator'.
+ */
+Trajectory stepped(Integrator<double>& integrator, const Vector& start, unsigned int stepsPerPoint)
+{
+   AdamsBashforthMoulton4* multistep=dynamic_cast<AdamsBashforthMoulton4*> (&integrator);
+   AdamsBashforthMoulton4::History history;
+
+   Trajectory points(NumPoints, start);
+   Vector state=start;
+   Vector step(4);
+   for (unsigned int i=1; i < NumPoints; i++)
+   {
+      for (unsigned int s=0; s < stepsPerPoint; s++)
+      {
+         if (multistep != NULL)
+            multistep->step(history, state, step);
+         else
+            integrator.step(state, step);
+         state+=step;
+      }
+      points[i]=state;
+   }
+   return points;
+}
+
+Trajectory integrated(DormandPrince45& integrator, const Vector& start)
+{
+   Trajectory points(NumPoints, start);
+   integrator.integrate(points.begin(), points.end());
+   return points;
+}
+
+/** Largest difference of any coordinate of any point.
+ */
+double difference(const Trajectory& a, const Trajectory& b)
+{
+   double largest=0.0;
+   for (unsigned int i=0; i < NumPoints; i++)
+   {
+      for (int k=0; k < 4; k++)
+      {
+         double d=std::fabs(a[i][k] - b[i][k]);
+         if (!(d <= largest))
+            largest=d;
+      }
+   }
+   return largest;
+}
+
+void check(const char* name, double value, double tolerance)
+{
+   bool passed=value <= tolerance;
+   std::printf("   %-34s %12.4g (tolerance %g) %s\n", name, value, tolerance,
+         passed ? "ok" : "FAILED");
+   if (!passed)
+      failures++;
+}
+
+/** Largest difference of any component of the first BatchSize states,
+    relative to the magnitude of 'expected'.
+ */
+double relativeDifference(const std::vector<double>& a, const std::vector<double>& expected, int dimension)
+{
+   double largest=0.0;
+   for (int k=0; k < dimension; k++)
+   {
+      for (size_t i=0; i < BatchSize; i++)
+      {
+         double e=expected[k * BatchStride + i];
+         double d=std::fabs(a[k * BatchStride + i] - e) / (1.0 + std::fabs(e));
+         if (!(d <= largest))
+            largest=d;
+      }
+   }
+   return largest;
+}
+
+void check(const std::string& model, const char* name, double value, double tolerance)
+{
+   std::string label=model + " " + name;
+   check(label.c_str(), value, tolerance);
+}
+
+/** Compares the batch and compiled paths of ModelParam with its scalar
+    operator() and RungeKutta4::step().
+ */
+template <typename ModelParam, int DimensionParam>
+void checkModel()
+{
+   ModelParam model;
+   RungeKutta4 rk4(model, 0.01);
+   SimdRungeKutta4<ModelParam, DimensionParam> simd(model, 0.01);
+   FusedRungeKutta4<ModelParam, DimensionParam> fused(model, rk4);
+
+   // states spread around the default point, structure-of-arrays
+   Vector point=model.getDefaultPoint();
+   std::vector<double> states(DimensionParam * BatchStride, 0.0);
+   for (int k=0; k < DimensionParam; k++)
+   {
+      for (size_t i=0; i < BatchSize; i++)
+         states[k * BatchStride + i]=point[k] + 0.05 * i * (k + 1);
+   }
+
+   // the scalar values and the states after one step
+   std::vector<double> values(states.size(), 0.0);
+   std::vector<double> stepped(states.size(), 0.0);
+   Vector state(DimensionParam);
+   Vector value(DimensionParam);
+   for (size_t i=0; i < BatchSize; i++)
+   {
+      for (int k=0; k < DimensionParam; k++)
+         state[k]=states[k * BatchStride + i];
+      model(state, value);
+      for (int k=0; k < DimensionParam; k++)
+         values[k * BatchStride + i]=value[k];
+      rk4.step(state, value);
+      for (int k=0; k < DimensionParam; k++)
+         stepped[k * BatchStride + i]=state[k] + value[k];
+   }
+
+   std::vector<double> out(states.size(), 0.0);
+   model.evaluateBatch(&states[0], &out[0], BatchSize, BatchStride);
+   check(model.getName(), "evaluateBatch", relativeDifference(out, values, DimensionParam), 1e-14);
+
+   simd.stepBatch(&states[0], &out[0], BatchSize, BatchStride);
+   for (size_t j=0; j < out.size(); j++)
+      out[j]+=states[j];
+   check(model.getName(), "SimdRungeKutta4", relativeDifference(out, stepped, DimensionParam), 1e-14);
+
+   double s[DimensionParam];
+   for (size_t i=0; i < BatchSize; i++)
+   {
+      for (int k=0; k < DimensionParam; k++)
+         s[k]=states[k * BatchStride + i];
+      fused(s);
+      for (int k=0; k < DimensionParam; k++)
+         out[k * BatchStride + i]=s[k];
+   }
+   check(model.getName(), "FusedRungeKutta4", relativeDifference(out, stepped, DimensionParam), 1e-14);
+}
+
+/** Number of words that differ from the Random123 known answers, for a
+    whole counter and key and, where the last counter word is 0, through
+    generate().
+ */
+double philoxMismatches()
+{
+   typedef DTS::Random::Word Word;
+   static const Word vectors[][10]=
+   {
+      // counter[4], key[2], expected output[4]
+      { 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+        0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8 },
+      { 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff,
+        0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd },
+      { 0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344, 0xa4093822, 0x299f31d0,
+        0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1 }
+   };
+
+   int mismatches=0;
+   for (unsigned int v=0; v < sizeof(vectors) / sizeof(vectors[0]); v++)
+   {
+      const Word* vector=vectors[v];
+      Word out[4];
+      DTS::Random::philox(vector, vector + 4, out);
+      for (int i=0; i < 4; i++)
+         if (out[i] != vector[6 + i])
+            mismatches++;
+
+      if (vector[3] == 0)
+      {
+         DTS::Random random(vector[4], vector[5]);
+         random.generate(vector[0] | (uint64_t(vector[1]) << 32), vector[2], out);
+         for (int i=0; i < 4; i++)
+            if (out[i] != vector[6 + i])
+               mismatches++;
+      }
+   }
+   return mismatches;
+}
+
+}
+
+int main()
+{
+   Model model;
+   Vector start=startState(1.0);
+   Vector other=startState(-7.0);
+   Trajectory expected=reference(model, start);
+
+   std::printf("Integrator check, Lorenz from (1, 1, 1) over %g time units\n",
+         Interval * (NumPoints - 1));
+
+   // dense output, the states of the points are interpolated
+   {
+      DormandPrince45 dopri5(model, Interval);
+      Trajectory first=integrated(dopri5, start);
+      check("dopri5 integrate() vs rk4", difference(first, expected), 1e-3);
+
+      integrated(dopri5, other);
+      check("dopri5 integrate() repeated", difference(integrated(dopri5, start), first), 0.0);
+
+      Trajectory steps=stepped(dopri5, start, 1);
+      check("dopri5 step() vs rk4", difference(steps, expected), 1e-3);
+
+      stepped(dopri5, other, 1);
+      check("dopri5 step() repeated", difference(stepped(dopri5, start, 1), steps), 0.0);
+   }
+
+   // multistep, at a tenth of the spacing of the points
+   {
+      AdamsBashforthMoulton4 abm4(model, Interval / 10);
+      Trajectory first=stepped(abm4, start, 10);
+      check("abm4 step() vs rk4", difference(first, expected), 1e-3);
+
+      stepped(abm4, other, 10);
+      check("abm4 step() repeated", difference(stepped(abm4, start, 10), first), 0.0);
+   }
+
+   std::printf("Model check, batch and compiled paths vs the scalar ones\n");
+   checkModel<Bouali, 4>();
+   checkModel<Lorenz, 4>();
+   checkModel<Owl, 4>();
+   checkModel<Rossler3, 4>();
+   checkModel<Rossler4, 5>();
+
+   std::printf("Random check, Philox4x32-10 known answers\n");
+   check("Random philox() words", philoxMismatches(), 0.0);
+
+   if (failures > 0)
+   {
+      std::printf("%d check(s) FAILED\n", failures);
+      return 1;
+   }
+   return 0;
+}
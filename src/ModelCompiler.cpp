@@ -0,0 +1,693 @@
+/*******************************************************************************
+ ModelCompiler: Builds experiment plugins from model description files.
+
+ This file is part of the Dynamics Toolset.
+
+ The Dynamics Toolset is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by the Free
+ Software Foundation, either version 3 of the License, or (at your option) any
+ later version.
+
+ The Dynamics Toolset is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ details.
+
+ You should have received a copy of the GNU General Public License
+ along with the Dynamics Toolset. If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#include "ModelCompiler.h"
+
+// STL includes
+//
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+
+// System includes
+//
+#include <dirent.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+// Flags for the Vrui headers the generated code includes, set by the Makefile
+#ifndef MODEL_CFLAGS
+#define MODEL_CFLAGS ""
+#endif
+
+namespace
+{
+   struct Parameter
+   {
+         std::string name;
+         double value, minValue, maxValue, increment;
+   };
+
+   struct Coordinate
+   {
+         std::string name;
+         double defaultValue, minValue, maxValue;
+   };
+
+   struct Description
+   {
+         std::string name;
+         double stepSize;
+         std::vector<Parameter> parameters;
+         std::vector<Coordinate> coordinates;
+         std::vector<double> center;
+         std::map<std::string, std::string> equations; ///< Translated right-hand sides.
+         std::map<std::string, std::string> sources; ///< Right-hand sides as written.
+         bool usesFunctions;
+   };
+
+   const char* functions[]=
+   {
+      "sin", "cos", "tan", "asin", "acos", "atan", "atan2",
+      "sinh", "cosh", "tanh", "exp", "log", "log10", "sqrt", "pow", "fabs"
+   };
+
+   bool isFunction(const std::string& name)
+   {
+      const size_t count=sizeof(functions) / sizeof(functions[0]);
+      return std::find(functions, functions + count, name) != functions + count;
+   }
+
+   bool isIdentifier(const std::string& word)
+   {
+      if (word.empty() || !(std::isalpha(word[0]) || word[0] == '_'))
+         return false;
+      for (size_t i=0; i < word.size(); i++)
+      {
+         if (!(std::isalnum(word[i]) || word[i] == '_'))
+            return false;
+      }
+      return true;
+   }
+
+   std::string error(const std::string& fileName, int line, const std::string& message)
+   {
+      std::ostringstream out;
+      out << fileName << ":" << line << ": " << message;
+      return out.str();
+   }
+
+   std::string toString(double value)
+   {
+      std::ostringstream out;
+      out.precision(17);
+      out << value;
+      std::string result=out.str();
+      if (result.find_first_of(".einf") == std::string::npos)
+         result+=".0";
+      return result;
+   }
+
+   /* FNV-1a, 64 bit */
+   unsigned long long hash(const std::string& text, unsigned long long value=14695981039346656037ULL)
+   {
+      for (size_t i=0; i < text.size(); i++)
+      {
+         value^=static_cast<unsigned char> (text[i]);
+         value*=1099511628211ULL;
+      }
+      return value;
+   }
+
+   /** Hash the names and contents of the headers in a directory, in the
+    * order of their names. The generated code includes only headers of
+    * the Dynamics directories, so this covers all that it depends on
+    * within the project.
+    */
+   unsigned long long hashHeaders(const std::string& directory, unsigned long long value)
+   {
+      DIR* dir=opendir(directory.c_str());
+      if (dir == NULL)
+         return value;
+
+      std::vector<std::string> headers;
+      struct dirent* entry;
+      while ((entry=readdir(dir)) != NULL)
+      {
+         std::string name=entry->d_name;
+         if (name.size() > 2 && name.compare(name.size() - 2, 2, ".h") == 0)
+            headers.push_back(name);
+      }
+      closedir(dir);
+
+      std::sort(headers.begin(), headers.end());
+
+      for (size_t i=0; i < headers.size(); i++)
+      {
+         std::ifstream in((directory + "/" + headers[i]).c_str());
+         std::string contents;
+         std::getline(in, contents, '\0');
+         value=hash(headers[i], value);
+         value=hash(contents, value);
+      }
+      return value;
+   }
+
+   /** Translate a right-hand side into an expression over p[] and
+    * realParamValues[]. Integer literals become double literals so that
+    * 8/3 means what it says.
+    */
+   std::string translate(const std::string& expression, const Description& d,
+         const std::string& fileName, int line, bool& usesFunctions)
+   {
+      std::ostringstream out;
+      size_t i=0;
+      int depth=0;
+      while (i < expression.size())
+      {
+         char c=expression[i];
+         if (std::isspace(c))
+         {
+            out << c;
+            i++;
+         }
+         else if (std::isalpha(c) || c == '_')
+         {
+            size_t begin=i;
+            while (i < expression.size() && (std::isalnum(expression[i]) || expression[i] == '_'))
+               i++;
+            std::string word=expression.substr(begin, i - begin);
+
+            size_t next=expression.find_first_not_of(" \t", i);
+            bool call=next != std::string::npos && expression[next] == '(';
+
+            if (call)
+            {
+               if (!isFunction(word))
+                  throw ModelCompiler::ParseError(error(fileName, line, "unknown function '" + word + "'"));
+               out << "std::" << word;
+               usesFunctions=true;
+               continue;
+            }
+
+            bool found=false;
+            for (size_t k=0; k < d.coordinates.size() && !found; k++)
+            {
+               if (d.coordinates[k].name == word)
+               {
+                  out << "p[" << k << "]";
+                  found=true;
+               }
+            }
+            for (size_t k=0; k < d.parameters.size() && !found; k++)
+            {
+               if (d.parameters[k].name == word)
+               {
+                  out << "realParamValues[" << k << "]";
+                  found=true;
+               }
+            }
+            if (!found && word == "t")
+            {
+               out << "p[" << d.coordinates.size() << "]";
+               found=true;
+            }
+            if (!found)
+               throw ModelCompiler::ParseError(error(fileName, line, "unknown name '" + word + "'"));
+         }
+         else if (std::isdigit(c) || c == '.')
+         {
+            size_t begin=i;
+            bool real=false;
+            while (i < expression.size() && (std::isdigit(expression[i]) || expression[i] == '.'))
+            {
+               real|=expression[i] == '.';
+               i++;
+            }
+            if (i < expression.size() && (expression[i] == 'e' || expression[i] == 'E'))
+            {
+               real=true;
+               i++;
+               if (i < expression.size() && (expression[i] == '+' || expression[i] == '-'))
+                  i++;
+               while (i < expression.size() && std::isdigit(expression[i]))
+                  i++;
+            }
+            out << expression.substr(begin, i - begin);
+            if (!real)
+               out << ".0";
+         }
+         else if (std::string("+-*/,").find(c) != std::string::npos)
+         {
+            out << c;
+            i++;
+         }
+         else if (c == '(' || c == ')')
+         {
+            depth+=c == '(' ? 1 : -1;
+            if (depth < 0)
+               throw ModelCompiler::ParseError(error(fileName, line, "unbalanced ')'"));
+            out << c;
+            i++;
+         }
+         else
+         {
+            throw ModelCompiler::ParseError(error(fileName, line, std::string("unexpected character '") + c + "'"));
+         }
+      }
+      if (depth != 0)
+         throw ModelCompiler::ParseError(error(fileName, line, "unbalanced '('"));
+
+      return out.str();
+   }
+
+   Description parse(std::istream& in, const std::string& fileName)
+   {
+      Description d;
+      d.stepSize=.01;
+      d.usesFunctions=false;
+
+      // Equations are translated once all names are known.
+      std::vector<std::pair<std::string, std::string> > equations;
+      std::vector<int> lines;
+
+      std::string text;
+      int line=0;
+      while (std::getline(in, text))
+      {
+         line++;
+         size_t comment=text.find('#');
+         if (comment != std::string::npos)
+            text.erase(comment);
+
+         size_t prime=text.find("'");
+         if (prime != std::string::npos)
+         {
+            std::string name=text.substr(0, prime);
+            name.erase(0, name.find_first_not_of(" \t"));
+            size_t equals=text.find('=', prime);
+            if (!isIdentifier(name) || equals == std::string::npos ||
+                  text.find_first_not_of(" \t", prime + 1) != equals)
+               throw ModelCompiler::ParseError(error(fileName, line, "expected \"name' = expression\""));
+
+            equations.push_back(std::make_pair(name, text.substr(equals + 1)));
+            lines.push_back(line);
+            continue;
+         }
+
+         std::istringstream words(text);
+         std::string keyword;
+         if (!(words >> keyword))
+            continue;
+
+         if (keyword == "name")
+         {
+            std::getline(words, d.name);
+            d.name.erase(0, d.name.find_first_not_of(" \t"));
+            d.name.erase(d.name.find_last_not_of(" \t\r") + 1);
+            if (d.name.empty())
+               throw ModelCompiler::ParseError(error(fileName, line, "missing name"));
+            // the name goes into string literals of the generated code
+            for (size_t i=0; i < d.name.size(); i++)
+            {
+               if (d.name[i] == '"' || d.name[i] == '\\' || !std::isprint(static_cast<unsigned char> (d.name[i])))
+                  throw ModelCompiler::ParseError(error(fileName, line, "name must not contain quotes, backslashes or control characters"));
+            }
+         }
+         else if (keyword == "stepsize")
+         {
+            if (!(words >> d.stepSize) || d.stepSize <= 0)
+               throw ModelCompiler::ParseError(error(fileName, line, "expected a positive step size"));
+         }
+         else if (keyword == "parameter")
+         {
+            Parameter p;
+            if (!(words >> p.name >> p.value >> p.minValue >> p.maxValue) || !isIdentifier(p.name))
+               throw ModelCompiler::ParseError(error(fileName, line, "expected \"parameter name value min max [increment]\""));
+            if (!(words >> p.increment))
+               p.increment=(p.maxValue - p.minValue) / 100;
+            d.parameters.push_back(p);
+         }
+         else if (keyword == "coordinate")
+         {
+            Coordinate c;
+            if (!(words >> c.name >> c.defaultValue >> c.minValue >> c.maxValue) || !isIdentifier(c.name))
+               throw ModelCompiler::ParseError(error(fileName, line, "expected \"coordinate name default min max\""));
+            if (c.name == "t")
+               throw ModelCompiler::ParseError(error(fileName, line, "'t' is the time coordinate"));
+            d.coordinates.push_back(c);
+         }
+         else if (keyword == "center")
+         {
+            double value;
+            while (words >> value)
+               d.center.push_back(value);
+         }
+         else
+         {
+            throw ModelCompiler::ParseError(error(fileName, line, "unknown keyword '" + keyword + "'"));
+         }
+      }
+
+      if (d.name.empty())
+         throw ModelCompiler::ParseError(fileName + ": missing \"name\"");
+      if (d.coordinates.empty())
+         throw ModelCompiler::ParseError(fileName + ": no coordinates");
+      if (!d.center.empty() && d.center.size() != d.coordinates.size())
+         throw ModelCompiler::ParseError(fileName + ": \"center\" needs one value per coordinate");
+      d.center.resize(d.coordinates.size(), 0.0);
+
+      std::set<std::string> names;
+      for (size_t i=0; i < d.coordinates.size(); i++)
+      {
+         if (!names.insert(d.coordinates[i].name).second)
+            throw ModelCompiler::ParseError(fileName + ": '" + d.coordinates[i].name + "' is defined twice");
+      }
+      for (size_t i=0; i < d.parameters.size(); i++)
+      {
+         if (!names.insert(d.parameters[i].name).second)
+            throw ModelCompiler::ParseError(fileName + ": '" + d.parameters[i].name + "' is defined twice");
+      }
+
+      for (size_t i=0; i < equations.size(); i++)
+      {
+         const std::string& name=equations[i].first;
+         bool known=false;
+         for (size_t k=0; k < d.coordinates.size(); k++)
+            known|=d.coordinates[k].name == name;
+         if (!known)
+            throw ModelCompiler::ParseError(error(fileName, lines[i], "'" + name + "' is not a coordinate"));
+         if (d.equations.count(name))
+            throw ModelCompiler::ParseError(error(fileName, lines[i], "second equation for '" + name + "'"));
+
+         d.equations[name]=translate(equations[i].second, d, fileName, lines[i], d.usesFunctions);
+         d.sources[name]=equations[i].second;
+      }
+
+      for (size_t k=0; k < d.coordinates.size(); k++)
+      {
+         if (!d.equations.count(d.coordinates[k].name))
+            throw ModelCompiler::ParseError(fileName + ": no equation for '" + d.coordinates[k].name + "'");
+      }
+
+      return d;
+   }
+
+   bool isDirectory(const std::string& path)
+   {
+      struct stat info;
+      return stat(path.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+   }
+
+   std::string quote(const std::string& text)
+   {
+      std::string result="'";
+      for (size_t i=0; i < text.size(); i++)
+      {
+         if (text[i] == '\'')
+            result+="'\\''";
+         else
+            result+=text[i];
+      }
+      return result + "'";
+   }
+
+   /** Create a directory and its missing parents.
+    */
+   bool makeDirectories(const std::string& path)
+   {
+      if (path.empty() || isDirectory(path))
+         return true;
+      size_t slash=path.find_last_of('/');
+      if (slash != std::string::npos && slash > 0 && !makeDirectories(path.substr(0, slash)))
+         return false;
+      return mkdir(path.c_str(), 0755) == 0 || errno == EEXIST;
+   }
+}
+
+ModelCompiler::ModelCompiler(const std::string& cacheDir) :
+   cacheDirectory(cacheDir)
+{
+}
+
+std::string ModelCompiler::writableCacheDirectory(const std::string& preferred)
+{
+   // the preferred directory, if it or its parent can be written to
+   std::string existing=preferred;
+   if (!isDirectory(existing))
+      existing=existing.substr(0, existing.find_last_of('/'));
+   if (!existing.empty() && isDirectory(existing) && access(existing.c_str(), W_OK) == 0)
+      return preferred;
+
+   const char* cache=std::getenv("XDG_CACHE_HOME");
+   if (cache != NULL && *cache == '/')
+      return std::string(cache) + "/flow/models";
+   const char* home=std::getenv("HOME");
+   if (home != NULL && *home != '\0')
+      return std::string(home) + "/.cache/flow/models";
+   return preferred;
+}
+
+void ModelCompiler::addIncludeDirectory(const std::string& directory)
+{
+   includeDirectories.push_back(directory);
+}
+
+std::string ModelCompiler::generate(std::istream& in, const std::string& fileName)
+{
+   Description d=parse(in, fileName);
+
+   // Class names are built from the model name.
+   std::string ident="Runtime";
+   for (size_t i=0; i < d.name.size(); i++)
+      ident+=std::isalnum(d.name[i]) ? d.name[i] : '_';
+
+   const size_t dimension=d.coordinates.size() + 1;
+
+   // std:: functions and empty parameter lists do not work with the packs
+   bool simd=!d.usesFunctions && !d.parameters.empty();
+
+   std::ostringstream out;
+   out << "// Generated from " << fileName << " by ModelCompiler, do not edit.\n\n"
+       << "#include <cmath>\n"
+       << "#include <limits>\n\n"
+       << "#include \"FixedExperiment.h\"\n"
+       << (simd ? "#include \"SimdRungeKutta4.h\"\n" : "#include \"RungeKutta4.h\"\n")
+       << "#include \"FusedRungeKutta4.h\"\n"
+       << "#include \"DormandPrince45.h\"\n"
+       << "#include \"AdamsBashforthMoulton4.h\"\n"
+       << "#include \"ProjectionTransformer.h\"\n"
+       << "#include \"Factory.h\"\n\n";
+
+   /* Model */
+   out << "template <typename VectorParam>\n"
+       << "class " << ident << "Model : public EquationModel<" << ident << "Model<VectorParam>, double, VectorParam>\n"
+       << "{\n"
+       << "public:\n"
+       << "    typedef EquationModel<" << ident << "Model<VectorParam>, double, VectorParam> Base;\n"
+       << "    typedef typename Base::Scalar Scalar;\n"
+       << "    typedef typename Base::Vector Vector;\n"
+       << "    typedef typename Base::Coordinate Coordinate;\n"
+       << "    typedef typename Base::RealParameter RealParameter;\n\n"
+       << "    " << ident << "Model()\n"
+       << "    : Base()\n"
+       << "    {\n"
+       << "        this->name = \"" << d.name << "\";\n\n"
+       << "        double inf = std::numeric_limits<Scalar>::infinity();\n";
+   for (size_t k=0; k < d.coordinates.size(); k++)
+   {
+      const Coordinate& c=d.coordinates[k];
+      out << "        this->addCoordinate( Coordinate(\"" << c.name << "\", " << toString(c.defaultValue)
+          << ", " << toString(c.minValue) << ", " << toString(c.maxValue) << ") );\n";
+   }
+   out << "        this->addCoordinate( Coordinate(\"t\", 0, 0, inf) );\n\n";
+   for (size_t k=0; k < d.parameters.size(); k++)
+   {
+      const Parameter& p=d.parameters[k];
+      out << "        this->addRealParameter( RealParameter(\"" << p.name << "\", " << toString(p.value)
+          << ", " << toString(p.minValue) << ", " << toString(p.maxValue) << ", " << toString(p.value)
+          << ", " << toString(p.increment) << ") );\n";
+   }
+   out << "\n        this->centerPoint.setDimension(" << dimension << ");\n";
+   for (size_t k=0; k < d.center.size(); k++)
+      out << "        this->centerPoint[" << k << "] = " << toString(d.center[k]) << ";\n";
+   out << "        this->centerPoint[" << d.center.size() << "] = 0;\n"
+       << "    }\n\n"
+       << "    virtual ~" << ident << "Model() { }\n\n"
+       << "    template <typename In, typename Out>\n"
+       << "    static void evaluate(In const& p, Out& out, double const* realParamValues)\n"
+       << "    {\n";
+   for (size_t k=0; k < d.coordinates.size(); k++)
+   {
+      const std::string& name=d.coordinates[k].name;
+      out << "        // " << name << "' =" << d.sources[name] << "\n"
+          << "        out[" << k << "] =" << d.equations[name] << ";\n";
+   }
+   out << "        out[" << d.coordinates.size() << "] = 1;\n"
+       << "    }\n"
+       << "};\n\n";
+
+   /* Experiment */
+   std::string step=toString(d.stepSize);
+   out << "class " << ident << "Experiment : public FixedExperiment<" << ident << "Model, " << dimension << ">\n"
+       << "{\n"
+       << "public:\n"
+       << "    " << ident << "Experiment() : FixedExperiment<" << ident << "Model, " << dimension << ">()\n"
+       << "    {\n";
+   if (simd)
+      out << "        RungeKutta4* rk4 = new SimdRungeKutta4<" << ident << "Model<DTS::Vector<double> >, "
+          << dimension << ">(*model, " << step << ");\n";
+   else
+      out << "        RungeKutta4* rk4 = new RungeKutta4(*model, " << step << ");\n";
+   out << "        addIntegrator( rk4 );\n"
+       << "        addStepper( rk4, new FusedRungeKutta4<" << ident << "Model<DTS::Vector<double> >, "
+       << dimension << ">(*model, *rk4) );\n";
+   out << "        addIntegrator( new DormandPrince45(*model, " << step << ") );\n"
+       << "        addIntegrator( new AdamsBashforthMoulton4(*model, " << step << ") );\n"
+       << "        setIntegrator(\"rk4\");\n\n"
+       << "        addTransformer( new ProjectionTransformer<double>(*model) );\n"
+       << "        setTransformer(\"projection\");\n"
+       << "    }\n"
+       << "};\n\n";
+
+   /* Registration, as in src/Experiments */
+   out << "extern \"C\"\n"
+       << "{\n"
+       << "    Experiment<double>* maker()\n"
+       << "    {\n"
+       << "        return new " << ident << "Experiment;\n"
+       << "    }\n\n"
+       << "    class Proxy\n"
+       << "    {\n"
+       << "        public:\n"
+       << "        Proxy()\n"
+       << "        {\n"
+       << "            Factory[\"" << d.name << "\"] = maker;\n"
+       << "        }\n"
+       << "    };\n\n"
+       << "    Proxy p;\n"
+       << "}\n";
+
+   return out.str();
+}
+
+std::string ModelCompiler::compileCommand(const std::string& source, const std::string& library) const
+{
+   const char* compiler=std::getenv("CXX");
+
+   std::string command=compiler != NULL && *compiler != '\0' ? compiler : "g++";
+   command+=" -O3 -DNDEBUG -fPIC -shared " MODEL_CFLAGS;
+   for (size_t i=0; i < includeDirectories.size(); i++)
+   {
+      command+=" -I" + quote(includeDirectories[i]);
+      command+=" -I" + quote(includeDirectories[i] + "/Dynamics");
+   }
+   command+=" -o " + quote(library) + " " + quote(source);
+   return command;
+}
+
+std::string ModelCompiler::compile(const std::string& modelFile)
+{
+   std::ifstream in(modelFile.c_str());
+   if (!in)
+      throw std::runtime_error("Could not open " + modelFile);
+
+   std::string source=generate(in, modelFile);
+
+   // Name the plugin after the file and key it by everything that goes into it
+   std::string base=modelFile.substr(modelFile.find_last_of('/') + 1);
+   base=base.substr(0, base.find_last_of('.'));
+   for (size_t i=0; i < base.size(); i++)
+   {
+      if (!(std::isalnum(base[i]) || base[i] == '_' || base[i] == '-'))
+         base[i]='_';
+   }
+
+   unsigned long long key=hash(source);
+   key=hash(compileCommand("", ""), key);
+   for (size_t i=0; i < includeDirectories.size(); i++)
+      key=hashHeaders(includeDirectories[i] + "/Dynamics", key);
+
+   char keyText[17];
+   std::snprintf(keyText, sizeof(keyText), "%016llx", key);
+
+   std::string library=cacheDirectory + "/lib" + base + "-" + keyText + ".so";
+
+   if (access(library.c_str(), R_OK) == 0)
+      return library;
+
+   if (!makeDirectories(cacheDirectory))
+      throw std::runtime_error("Could not create " + cacheDirectory);
+
+   // Build under temporary names and rename, so that other processes (e.g.
+   // on other cluster nodes) never load a half-written plugin.
+   std::ostringstream temp;
+   temp << cacheDirectory << "/lib" << base << "-" << keyText << "." << getpid();
+   std::string sourceFile=temp.str() + ".cpp";
+   std::string tempLibrary=temp.str() + ".so";
+   std::string logFile=temp.str() + ".log";
+
+   {
+      std::ofstream file(sourceFile.c_str());
+      file << source;
+      if (!file)
+         throw std::runtime_error("Could not write " + sourceFile);
+   }
+
+   std::cout << "\tCompiling " << modelFile << "..." << std::endl;
+   std::string command=compileCommand(sourceFile, tempLibrary) + " > " + quote(logFile) + " 2>&1";
+   int status=std::system(command.c_str());
+
+   if (status != 0 || rename(tempLibrary.c_str(), library.c_str()) != 0)
+   {
+      std::string log;
+      std::ifstream logStream(logFile.c_str());
+      std::getline(logStream, log, '\0');
+      std::remove(tempLibrary.c_str());
+      std::remove(logFile.c_str());
+      throw std::runtime_error("Compiling " + modelFile + " failed (source kept in " + sourceFile + "):\n" + log);
+   }
+
+   std::remove(sourceFile.c_str());
+   std::remove(logFile.c_str());
+
+   return library;
+}
+
+std::vector<std::string> ModelCompiler::compileDirectory(const std::string& directory)
+{
+   std::vector<std::string> libraries;
+
+   DIR* dir=opendir(directory.c_str());
+   if (dir == NULL)
+      return libraries;
+
+   std::vector<std::string> files;
+   struct dirent* entry;
+   while ((entry=readdir(dir)) != NULL)
+   {
+      std::string name=entry->d_name;
+      if (name.size() > 6 && name.compare(name.size() - 6, 6, ".model") == 0)
+         files.push_back(directory + "/" + name);
+   }
+   closedir(dir);
+
+   std::sort(files.begin(), files.end());
+
+   for (std::vector<std::string>::const_iterator file=files.begin(); file != files.end(); ++file)
+   {
+      try
+      {
+         libraries.push_back(compile(*file));
+      }
+      catch (std::runtime_error& e)
+      {
+         std::cerr << "ERROR: " << e.what() << std::endl;
+      }
+   }
+
+   return libraries;
+}
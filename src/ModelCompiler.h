@@ -0,0 +1,116 @@
+/*******************************************************************************
+ ModelCompiler: Builds experiment plugins from model description files.
+
+ This file is part of the Dynamics Toolset.
+
+ The Dynamics Toolset is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by the Free
+ Software Foundation, either version 3 of the License, or (at your option) any
+ later version.
+
+ The Dynamics Toolset is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ details.
+
+ You should have received a copy of the GNU General Public License
+ along with the Dynamics Toolset. If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#ifndef MODEL_COMPILER_H
+#define MODEL_COMPILER_H
+
+#include <istream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/** Turns a model description file into a native experiment plugin.
+ *
+ * A description lists the equations, parameters and coordinates of a
+ * dynamical system:
+ * \code
+# Halvorsen's cyclically symmetric attractor
+name Halvorsen
+stepsize 0.005
+
+parameter a 1.89 0 3 0.01
+
+coordinate x -1.5 -15 10
+coordinate y 0 -15 10
+coordinate z 0 -15 10
+center -3 -3 -3
+
+x' = -a * x - 4 * y - 4 * z - y * y
+y' = -a * y - 4 * z - 4 * x - z * z
+z' = -a * z - 4 * x - 4 * y - x * x
+ * \endcode
+ * "parameter" takes the name, value, minimum, maximum and optionally the
+ * slider increment, "coordinate" the name, default, minimum and maximum.
+ * The right-hand sides are C++ expressions over the coordinates, the
+ * parameters, the time "t" and the functions of <cmath>. As in the built-in
+ * models a time coordinate "t" is appended to the state.
+ *
+ * The compiler generates the model and experiment classes in the form of
+ * the hand-written ones in src/Models and src/Experiments, including the
+ * Factory registration, and compiles them at -O3 with the system compiler
+ * ($CXX, or g++) into the cache directory. The plugin file name contains a
+ * hash of the generated source, the compiler command and the contents of
+ * the Dynamics headers in the include directories, so a plugin is only
+ * rebuilt when the description, the generator, the flags or the headers
+ * it includes changed.
+ * Models using only arithmetic get the SIMD Runge-Kutta kernels, and all
+ * models a fused Runge-Kutta stepper (see Experiment::Stepper).
+ */
+class ModelCompiler
+{
+   public:
+      /** Error in a description file, with the file name and line number.
+       */
+      class ParseError: public std::runtime_error
+      {
+         public:
+            ParseError(const std::string& what) :
+               std::runtime_error(what)
+            {
+            }
+      };
+
+      ModelCompiler(const std::string& cacheDirectory);
+
+      /** The preferred cache directory if it can be created or written to,
+       * otherwise flow/models in the user's cache directory
+       * ($XDG_CACHE_HOME, or $HOME/.cache), e.g. for an installed viewer
+       * whose resource directory is read-only.
+       */
+      static std::string writableCacheDirectory(const std::string& preferred);
+
+      /** Directory searched for the headers included by the generated code.
+       */
+      void addIncludeDirectory(const std::string& directory);
+
+      /** Plugin for a description file, compiled unless already cached.
+       *
+       * \return Path of the plugin library.
+       * \throw ParseError or std::runtime_error if compiling failed.
+       */
+      std::string compile(const std::string& modelFile);
+
+      /** Plugins for all *.model files in a directory.
+       *
+       * Files that fail to compile are reported on std::cerr and skipped.
+       * A missing directory yields no plugins.
+       */
+      std::vector<std::string> compileDirectory(const std::string& directory);
+
+      /** C++ source of the plugin for a description.
+       */
+      static std::string generate(std::istream& description, const std::string& fileName);
+
+   private:
+      std::string cacheDirectory;
+      std::vector<std::string> includeDirectories;
+
+      std::string compileCommand(const std::string& source, const std::string& library) const;
+};
+
+#endif
@@ -8,34 +8,42 @@
 #include <Parameter.h>
 
 // http://arxiv.org/abs/1204.0045
-class Bouali : public DynamicalModel<double>
+template <typename VectorParam>
+class BoualiModel : public EquationModel<BoualiModel<VectorParam>, double, VectorParam>
 {
 public:
-    Bouali(Scalar alpha=0.3, Scalar s=1)
-    : DynamicalModel<double>()
+    typedef EquationModel<BoualiModel<VectorParam>, double, VectorParam> Base;
+    typedef typename Base::Scalar Scalar;
+    typedef typename Base::Vector Vector;
+    typedef typename Base::Coordinate Coordinate;
+    typedef typename Base::RealParameter RealParameter;
+
+    BoualiModel(Scalar alpha=0.3, Scalar s=1)
+    : Base()
     {
-        name = "Bouali";
+        this->name = "Bouali";
 
         double inf = std::numeric_limits<Scalar>::infinity();
-        addCoordinate( Coordinate("x", -3, -5, 5) );
-        addCoordinate( Coordinate("y", .6, 0, 20) );
-        addCoordinate( Coordinate("z", 1.2, -5, 5) );
-        addCoordinate( Coordinate("t", 0, 0, inf) );
+        this->addCoordinate( Coordinate("x", -3, -5, 5) );
+        this->addCoordinate( Coordinate("y", .6, 0, 20) );
+        this->addCoordinate( Coordinate("z", 1.2, -5, 5) );
+        this->addCoordinate( Coordinate("t", 0, 0, inf) );
 
-        addRealParameter( RealParameter("alpha", alpha, 0, 10,  .3,    0.01) );
-        addRealParameter( RealParameter("s",   s,   0, 8, 1, 0.01) );
+        this->addRealParameter( RealParameter("alpha", alpha, 0, 10,  .3,    0.01) );
+        this->addRealParameter( RealParameter("s",   s,   0, 8, 1, 0.01) );
 
-        centerPoint.setDimension(4);
-        centerPoint[0] = -1;
-        centerPoint[1] = 0;
-        centerPoint[2] = -5;
-        centerPoint[3] = 0;
+        this->centerPoint.setDimension(4);
+        this->centerPoint[0] = -1;
+        this->centerPoint[1] = 0;
+        this->centerPoint[2] = -5;
+        this->centerPoint[3] = 0;
 
     }
 
-    virtual ~Bouali() { }
+    virtual ~BoualiModel() { }
 
-    virtual void operator()(Vector const& p, Vector & out) const
+    template <typename In, typename Out>
+    static void evaluate(In const& p, Out& out, double const* realParamValues)
     {
         out[0] = p[0] * (4 - p[1]) + realParamValues[0] * p[2];
         out[1] = -p[1] * (1 - p[0] * p[0]);
@@ -44,4 +52,6 @@ public:
     }
 };
 
+typedef BoualiModel<DTS::Vector<double> > Bouali;
+
 #endif
@@ -7,35 +7,43 @@
 #include <Coordinate.h>
 #include <Parameter.h>
 
-class Lorenz : public DynamicalModel<double>
+template <typename VectorParam>
+class LorenzModel : public EquationModel<LorenzModel<VectorParam>, double, VectorParam>
 {
 public:
-    Lorenz(Scalar sigma=10, Scalar rho=28, Scalar beta=8/3.0)
-    : DynamicalModel<double>()
+    typedef EquationModel<LorenzModel<VectorParam>, double, VectorParam> Base;
+    typedef typename Base::Scalar Scalar;
+    typedef typename Base::Vector Vector;
+    typedef typename Base::Coordinate Coordinate;
+    typedef typename Base::RealParameter RealParameter;
+
+    LorenzModel(Scalar sigma=10, Scalar rho=28, Scalar beta=8/3.0)
+    : Base()
     {
-        name = "Lorenz";
+        this->name = "Lorenz";
 
         double inf = std::numeric_limits<Scalar>::infinity();
-        addCoordinate( Coordinate("x", 1, -30, 30) );
-        addCoordinate( Coordinate("y", 1, -30, 30) );
-        addCoordinate( Coordinate("z", 1, 0, 50) );
-        addCoordinate( Coordinate("t", 0, 0, inf) ); 
-
-        addRealParameter( RealParameter("sigma", sigma, 0, 20,  10,    0.1) );
-        addRealParameter( RealParameter("rho",   rho,   0, 100, 28,    0.1) );
-        addRealParameter( RealParameter("beta",  beta,  0, 10,  8/3.0, 0.1) );
+        this->addCoordinate( Coordinate("x", 1, -30, 30) );
+        this->addCoordinate( Coordinate("y", 1, -30, 30) );
+        this->addCoordinate( Coordinate("z", 1, 0, 50) );
+        this->addCoordinate( Coordinate("t", 0, 0, inf) ); 
+
+        this->addRealParameter( RealParameter("sigma", sigma, 0, 20,  10,    0.1) );
+        this->addRealParameter( RealParameter("rho",   rho,   0, 100, 28,    0.1) );
+        this->addRealParameter( RealParameter("beta",  beta,  0, 10,  8/3.0, 0.1) );
         
-        centerPoint.setDimension(4);
-        centerPoint[0] = 0;
-        centerPoint[1] = 0;
-        centerPoint[2] = 25;
-        centerPoint[3] = 0;
+        this->centerPoint.setDimension(4);
+        this->centerPoint[0] = 0;
+        this->centerPoint[1] = 0;
+        this->centerPoint[2] = 25;
+        this->centerPoint[3] = 0;
 
     }
 
-    virtual ~Lorenz() { }
+    virtual ~LorenzModel() { }
 
-    virtual void operator()(Vector const& p, Vector & out) const
+    template <typename In, typename Out>
+    static void evaluate(In const& p, Out& out, double const* realParamValues)
     {
         out[0] = realParamValues[0] * (p[1] - p[0]);
         out[1] = realParamValues[1] * p[0] - p[1] - p[0] * p[2];
@@ -44,4 +52,6 @@ public:
     }
 };
 
+typedef LorenzModel<DTS::Vector<double> > Lorenz;
+
 #endif
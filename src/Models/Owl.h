@@ -7,34 +7,42 @@
 #include <Coordinate.h>
 #include <Parameter.h>
 
-class Owl : public DynamicalModel<double>
+template <typename VectorParam>
+class OwlModel : public EquationModel<OwlModel<VectorParam>, double, VectorParam>
 {
 public:
-    Owl(Scalar a=10, Scalar b=10, Scalar c=13)
-    : DynamicalModel<double>()
+    typedef EquationModel<OwlModel<VectorParam>, double, VectorParam> Base;
+    typedef typename Base::Scalar Scalar;
+    typedef typename Base::Vector Vector;
+    typedef typename Base::Coordinate Coordinate;
+    typedef typename Base::RealParameter RealParameter;
+
+    OwlModel(Scalar a=10, Scalar b=10, Scalar c=13)
+    : Base()
     {
-        name = "Owl";
+        this->name = "Owl";
 
         double inf = std::numeric_limits<Scalar>::infinity();
-        addCoordinate( Coordinate("x", .5, -15, 15) );
-        addCoordinate( Coordinate("y", .5, -15, 15) );
-        addCoordinate( Coordinate("z", .5, 0, 20) );
-        addCoordinate( Coordinate("t", 0, 0, inf) );        
-
-        addRealParameter( RealParameter("a", a, -20, 20,  10, .01) );
-        addRealParameter( RealParameter("b", b, -20, 20,  10, .01) );
-        addRealParameter( RealParameter("c", c, -20, 20,  13, .01) );
+        this->addCoordinate( Coordinate("x", .5, -15, 15) );
+        this->addCoordinate( Coordinate("y", .5, -15, 15) );
+        this->addCoordinate( Coordinate("z", .5, 0, 20) );
+        this->addCoordinate( Coordinate("t", 0, 0, inf) );        
+
+        this->addRealParameter( RealParameter("a", a, -20, 20,  10, .01) );
+        this->addRealParameter( RealParameter("b", b, -20, 20,  10, .01) );
+        this->addRealParameter( RealParameter("c", c, -20, 20,  13, .01) );
         
-        centerPoint.setDimension(4);
-        centerPoint[0] = 0;
-        centerPoint[1] = 0;
-        centerPoint[2] = 0;
-        centerPoint[3] = 0;
+        this->centerPoint.setDimension(4);
+        this->centerPoint[0] = 0;
+        this->centerPoint[1] = 0;
+        this->centerPoint[2] = 0;
+        this->centerPoint[3] = 0;
     }
 
-    virtual ~Owl() { }
+    virtual ~OwlModel() { }
 
-    virtual void operator()(Vector const& p, Vector & out) const
+    template <typename In, typename Out>
+    static void evaluate(In const& p, Out& out, double const* realParamValues)
     {
         out[0] = -realParamValues[0] * (p[0] + p[1]);
         out[1] = -p[1] - realParamValues[1] * p[0] * p[2];
@@ -43,4 +51,6 @@ public:
     }
 };
 
+typedef OwlModel<DTS::Vector<double> > Owl;
+
 #endif
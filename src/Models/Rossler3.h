@@ -7,35 +7,43 @@
 #include <Coordinate.h>
 #include <Parameter.h>
 
-class Rossler3 : public DynamicalModel<double>
+template <typename VectorParam>
+class Rossler3Model : public EquationModel<Rossler3Model<VectorParam>, double, VectorParam>
 {
 public:
-    Rossler3(Scalar a=.2,  Scalar b=.2, Scalar c=5.7)
-    : DynamicalModel<double>()
+    typedef EquationModel<Rossler3Model<VectorParam>, double, VectorParam> Base;
+    typedef typename Base::Scalar Scalar;
+    typedef typename Base::Vector Vector;
+    typedef typename Base::Coordinate Coordinate;
+    typedef typename Base::RealParameter RealParameter;
+
+    Rossler3Model(Scalar a=.2,  Scalar b=.2, Scalar c=5.7)
+    : Base()
     {
-        name = "Rossler";
+        this->name = "Rossler";
 
         double inf = std::numeric_limits<Scalar>::infinity();
-        addCoordinate( Coordinate("x", 5, -20, 20) );
-        addCoordinate( Coordinate("y", 5, -15, 10) );
-        addCoordinate( Coordinate("z", 5, 0, 20) );
-        addCoordinate( Coordinate("t", 0, 0, inf) );   
-
-        addRealParameter( RealParameter("a", a, -.5,    .5,  0.2, 0.01) );
-        addRealParameter( RealParameter("b", b, -.5,    .5,  0.2, 0.01) );
-        addRealParameter( RealParameter("c", c, 0,    10.0,  5.7, 0.01) );
+        this->addCoordinate( Coordinate("x", 5, -20, 20) );
+        this->addCoordinate( Coordinate("y", 5, -15, 10) );
+        this->addCoordinate( Coordinate("z", 5, 0, 20) );
+        this->addCoordinate( Coordinate("t", 0, 0, inf) );   
+
+        this->addRealParameter( RealParameter("a", a, -.5,    .5,  0.2, 0.01) );
+        this->addRealParameter( RealParameter("b", b, -.5,    .5,  0.2, 0.01) );
+        this->addRealParameter( RealParameter("c", c, 0,    10.0,  5.7, 0.01) );
         
-        centerPoint.setDimension(4);
-        centerPoint[0] = 0;
-        centerPoint[1] = 0;
-        centerPoint[2] = 10;
-        centerPoint[3] = 0;
+        this->centerPoint.setDimension(4);
+        this->centerPoint[0] = 0;
+        this->centerPoint[1] = 0;
+        this->centerPoint[2] = 10;
+        this->centerPoint[3] = 0;
         
     }
 
-    virtual ~Rossler3() { }
+    virtual ~Rossler3Model() { }
 
-    virtual void operator()(Vector const& p, Vector & out) const
+    template <typename In, typename Out>
+    static void evaluate(In const& p, Out& out, double const* realParamValues)
     {
         out[0] = -p[1] - p[2];
         out[1] = p[0] + realParamValues[0] * p[1];
@@ -44,4 +52,6 @@ public:
     }
 };
 
+typedef Rossler3Model<DTS::Vector<double> > Rossler3;
+
 #endif
@@ -7,38 +7,46 @@
 #include <Coordinate.h>
 #include <Parameter.h>
 
-class Rossler4 : public DynamicalModel<double>
+template <typename VectorParam>
+class Rossler4Model : public EquationModel<Rossler4Model<VectorParam>, double, VectorParam>
 {
 public:
-    Rossler4(Scalar a=.25,  Scalar b=-.5, Scalar c=2.2, Scalar d=.05)
-    : DynamicalModel<double>()
+    typedef EquationModel<Rossler4Model<VectorParam>, double, VectorParam> Base;
+    typedef typename Base::Scalar Scalar;
+    typedef typename Base::Vector Vector;
+    typedef typename Base::Coordinate Coordinate;
+    typedef typename Base::RealParameter RealParameter;
+
+    Rossler4Model(Scalar a=.25,  Scalar b=-.5, Scalar c=2.2, Scalar d=.05)
+    : Base()
     {
-        name = "Hyperchaos";
+        this->name = "Hyperchaos";
 
         double inf = std::numeric_limits<Scalar>::infinity();
-        addCoordinate( Coordinate("x", -20, -130, 30) );
-        addCoordinate( Coordinate("y", 0, -80, 10) );
-        addCoordinate( Coordinate("z", 0, 0, 30) );
-        addCoordinate( Coordinate("w", 15, 0, 70) );        
-        addCoordinate( Coordinate("t", 0, 0, inf) );                
-
-        addRealParameter( RealParameter("a", a, 0,    2.0,  0.25, 0.01) );
-        addRealParameter( RealParameter("b", b, -2,   2.0, -0.50, 0.01) );
-        addRealParameter( RealParameter("c", c, 0,    5.0,  2.20, 0.01) );
-        addRealParameter( RealParameter("d", d, -0.5, 0.5,  0.05, 0.01) );      
-
-        centerPoint.setDimension(5);
-        centerPoint[0] = -50;
-        centerPoint[1] = -35;
-        centerPoint[2] = 40;
-        centerPoint[3] = 35;
-        centerPoint[4] = 0;
+        this->addCoordinate( Coordinate("x", -20, -130, 30) );
+        this->addCoordinate( Coordinate("y", 0, -80, 10) );
+        this->addCoordinate( Coordinate("z", 0, 0, 30) );
+        this->addCoordinate( Coordinate("w", 15, 0, 70) );        
+        this->addCoordinate( Coordinate("t", 0, 0, inf) );                
+
+        this->addRealParameter( RealParameter("a", a, 0,    2.0,  0.25, 0.01) );
+        this->addRealParameter( RealParameter("b", b, -2,   2.0, -0.50, 0.01) );
+        this->addRealParameter( RealParameter("c", c, 0,    5.0,  2.20, 0.01) );
+        this->addRealParameter( RealParameter("d", d, -0.5, 0.5,  0.05, 0.01) );      
+
+        this->centerPoint.setDimension(5);
+        this->centerPoint[0] = -50;
+        this->centerPoint[1] = -35;
+        this->centerPoint[2] = 40;
+        this->centerPoint[3] = 35;
+        this->centerPoint[4] = 0;
           
     }
 
-    virtual ~Rossler4() { }
+    virtual ~Rossler4Model() { }
 
-    virtual void operator()(Vector const& p, Vector & out) const
+    template <typename In, typename Out>
+    static void evaluate(In const& p, Out& out, double const* realParamValues)
     {
         out[0] = -p[1] - p[2];
         out[1] = p[0] + realParamValues[0] * p[1] + p[3];
@@ -48,4 +56,6 @@ public:
     }
 };
 
+typedef Rossler4Model<DTS::Vector<double> > Rossler4;
+
 #endif
@@ -0,0 +1,74 @@
+/*******************************************************************************
+ PluginLoader: Loads experiment plugins outside the application.
+
+ This file is part of the Dynamics Toolset.
+
+ The Dynamics Toolset is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by the Free
+ Software Foundation, either version 3 of the License, or (at your option) any
+ later version.
+
+ The Dynamics Toolset is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ details.
+
+ You should have received a copy of the GNU General Public License
+ along with the Dynamics Toolset. If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#include "PluginLoader.h"
+
+// STL includes
+//
+#include <cstdlib>
+#include <iostream>
+
+// System includes
+//
+#include <dlfcn.h>
+#include <unistd.h>
+
+// Project includes
+//
+#include "Directory.h"
+#include "ModelCompiler.h"
+
+// Source tree with the headers the compiled models include, set by the
+// Makefile so that it does not depend on the working directory
+#ifndef SOURCE_DIRECTORY
+#define SOURCE_DIRECTORY "src"
+#endif
+
+void loadPlugins(const std::string& pluginDirectory, const std::string& modelDirectory,
+      std::vector<void*>& libraries)
+{
+   std::vector<std::string> files;
+
+   if (access(pluginDirectory.c_str(), R_OK) == 0)
+   {
+      Directory dir;
+      dir.addExtensionFilter("so");
+      dir.read(pluginDirectory);
+      for (size_t i=0; i < dir.contents().size(); i++)
+         files.push_back(pluginDirectory + "/" + dir.contents()[i]);
+   }
+
+   if (!modelDirectory.empty())
+   {
+      ModelCompiler compiler(ModelCompiler::writableCacheDirectory(pluginDirectory + "/models"));
+      compiler.addIncludeDirectory(SOURCE_DIRECTORY);
+      std::vector<std::string> models=compiler.compileDirectory(modelDirectory);
+      files.insert(files.end(), models.begin(), models.end());
+   }
+
+   for (size_t i=0; i < files.size(); i++)
+   {
+      void* library=dlopen(files[i].c_str(), RTLD_NOW);
+      if (library == NULL)
+      {
+         std::cerr << "ERROR: " << dlerror() << std::endl;
+         continue;
+      }
+      libraries.push_back(library);
+   }
+}
@@ -0,0 +1,34 @@
+/*******************************************************************************
+ PluginLoader: Loads experiment plugins outside the application.
+
+ This file is part of the Dynamics Toolset.
+
+ The Dynamics Toolset is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by the Free
+ Software Foundation, either version 3 of the License, or (at your option) any
+ later version.
+
+ The Dynamics Toolset is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ details.
+
+ You should have received a copy of the GNU General Public License
+ along with the Dynamics Toolset. If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#ifndef PLUGIN_LOADER_H
+#define PLUGIN_LOADER_H
+
+#include <string>
+#include <vector>
+
+/** Loads the experiment plugins in 'pluginDirectory' and the models
+ * described in 'modelDirectory' (see ModelCompiler) into the Factory, as the
+ * application does at startup, for the headless programs. The handles of the
+ * loaded libraries are appended to 'libraries'; errors are reported on
+ * std::cerr and the other plugins still loaded.
+ */
+void loadPlugins(const std::string& pluginDirectory, const std::string& modelDirectory,
+      std::vector<void*>& libraries);
+
+#endif
@@ -0,0 +1,116 @@
+/*******************************************************************************
+ PolylineSimplifier: Streaming removal of points a polyline does not need.
+
+ This file is part of the Dynamics Toolset.
+
+ The Dynamics Toolset is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by the Free
+ Software Foundation, either version 3 of the License, or (at your option) any
+ later version.
+
+ The Dynamics Toolset is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ details.
+
+ You should have received a copy of the GNU General Public License
+ along with the Dynamics Toolset. If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#ifndef POLYLINE_SIMPLIFIER_H
+#define POLYLINE_SIMPLIFIER_H
+
+// STL includes
+//
+#include <vector>
+
+/** Selects the points of a polyline needed to draw it within a tolerance.
+ *
+ * The points are visited once, in order. Starting from the last point kept,
+ * the polyline is replaced by a single segment for as long as every point
+ * it skips lies within 'tolerance' of that segment; the point before the
+ * first one that does not fit is kept and starts the next segment. Where
+ * the polyline bends, the skipped points leave the segment after a short
+ * run, so points are kept in proportion to the curvature, while nearly
+ * straight stretches collapse into long segments.
+ *
+ * Unlike Douglas-Peucker, which needs the whole polyline and splits it
+ * recursively, this works on a stream of points. A segment skips at most
+ * 'maxRun' points, which bounds the work per point and keeps the time
+ * linear in the length of the polyline.
+ *
+ * The result holds the indices of the kept points, always including the
+ * first and the last, so data indexed by point, such as the position in a
+ * color gradient, stays attached to them.
+ */
+class PolylineSimplifier
+{
+   public:
+      PolylineSimplifier(double tolerance, unsigned int maxRun=256) :
+         squaredTolerance(tolerance * tolerance), maxRun(maxRun)
+      {
+      }
+
+      /** Writes the indices of the points to keep into 'kept'.
+       *
+       * \param points 3 coordinates per point.
+       */
+      void simplify(const double* points, unsigned int numPoints,
+            std::vector<unsigned int>& kept) const
+      {
+         kept.clear();
+         if (numPoints == 0)
+         {
+            return;
+         }
+
+         kept.push_back(0);
+         unsigned int anchor=0;
+         for (unsigned int i=2; i < numPoints; i++)
+         {
+            if (i - anchor > maxRun || not fits(points, anchor, i))
+            {
+               anchor=i - 1;
+               kept.push_back(anchor);
+            }
+         }
+
+         if (numPoints > 1)
+         {
+            kept.push_back(numPoints - 1);
+         }
+      }
+
+   private:
+      double squaredTolerance;
+      unsigned int maxRun;
+
+      /// Whether all points between 'first' and 'last' lie close to their segment.
+      bool fits(const double* points, unsigned int first, unsigned int last) const
+      {
+         const double* a=points + 3 * first;
+         const double* b=points + 3 * last;
+         double d[3]={ b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+         double length2=d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+
+         for (unsigned int m=first + 1; m < last; m++)
+         {
+            const double* p=points + 3 * m;
+            double v[3]={ p[0] - a[0], p[1] - a[1], p[2] - a[2] };
+
+            // closest point of the segment, a point coming back along the
+            // segment is measured from its end
+            double t=length2 > 0.0 ? (v[0] * d[0] + v[1] * d[1] + v[2] * d[2]) / length2 : 0.0;
+            t=t < 0.0 ? 0.0 : (t > 1.0 ? 1.0 : t);
+
+            double e[3]={ v[0] - t * d[0], v[1] - t * d[1], v[2] - t * d[2] };
+            if (e[0] * e[0] + e[1] * e[1] + e[2] * e[2] > squaredTolerance)
+            {
+               return false;
+            }
+         }
+
+         return true;
+      }
+};
+
+#endif
@@ -0,0 +1,184 @@
+/*******************************************************************************
+ SphereSampler: Points spread evenly on or in a unit sphere.
+
+ This file is part of the Dynamics Toolset.
+
+ The Dynamics Toolset is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by the Free
+ Software Foundation, either version 3 of the License, or (at your option) any
+ later version.
+
+ The Dynamics Toolset is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ details.
+
+ You should have received a copy of the GNU General Public License
+ along with the Dynamics Toolset. If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#ifndef SPHERE_SAMPLER_H
+#define SPHERE_SAMPLER_H
+
+// STL includes
+//
+#include <algorithm>
+#include <cmath>
+
+// Project includes
+//
+#include "Dynamics/Random.h"
+
+/** Places a set of points on the surface or throughout the volume of the
+ *  unit sphere.
+ *
+ * Every point is a function of its index, so sample() may be called for
+ * any index on any thread. Each pattern maps points of the unit square or
+ * cube onto the sphere with a map that preserves area or volume (height
+ * and angle for the surface, and the cube root of a uniform for the
+ * radius), so evenly spread inputs stay evenly spread and nothing is
+ * rejected.
+ *
+ * RANDOM draws the inputs independently from a DTS::Random stream.
+ * FIBONACCI places point i at height 1 - (2i+1)/count and turns it by the
+ * golden angle from point i-1, which spreads the surface points almost
+ * perfectly evenly; in the volume, the radius is the base 2 radical
+ * inverse of i, so that height and radius form a Hammersley set. HALTON
+ * uses the radical inverses of i in bases 2, 3 and 5 with their digits
+ * randomly permuted (scrambled), which removes the correlation between
+ * the bases that makes plain Halton points line up.
+ *
+ * The low-discrepancy patterns cover the sphere with a far smaller gap
+ * between neighbouring points than random ones of the same count. The
+ * stream passed to the constructor turns the Fibonacci points about the
+ * axis and scrambles the Halton digits, so each release differs.
+ */
+class SphereSampler
+{
+   public:
+      enum Pattern
+      {
+         RANDOM, FIBONACCI, HALTON
+      };
+
+      SphereSampler(Pattern pattern, bool volume, unsigned int count, const DTS::Random& random) :
+         pattern(pattern), volume(volume), count(count), random(random)
+      {
+         DTS::Random::Word words[4];
+         random.generate(0, Scrambles, words);
+         shift=DTS::Random::toUnit(words[0]);
+         scramble2=words[1];
+
+         // a random permutation of the digits for each digit position
+         makePermutations(3, Digits3, permutations3[0]);
+         makePermutations(5, Digits5, permutations5[0]);
+      }
+
+      /** Writes point i to 'p'.
+       */
+      void sample(unsigned int i, double p[3]) const
+      {
+         double z, phi, r;
+
+         if (pattern == FIBONACCI)
+         {
+            const double GoldenFraction=0.6180339887498949;
+
+            z=1.0 - (2.0 * i + 1.0) / count;
+            double turns=i * GoldenFraction + shift;
+            phi=2.0 * M_PI * (turns - std::floor(turns));
+            r=radicalInverse2(i);
+         }
+         else if (pattern == HALTON)
+         {
+            z=1.0 - 2.0 * radicalInverse2(i);
+            phi=2.0 * M_PI * radicalInverse(i, 3, Digits3, permutations3[0]);
+            r=radicalInverse(i, 5, Digits5, permutations5[0]);
+         }
+         else
+         {
+            double u[4];
+            random.uniform(i, 0, u);
+            z=1.0 - 2.0 * u[0];
+            phi=2.0 * M_PI * u[1];
+            r=u[2];
+         }
+
+         double s=std::sqrt(std::max(0.0, 1.0 - z * z));
+         double radius=volume ? std::pow(r, 1.0 / 3.0) : 1.0;
+         p[0]=radius * s * std::cos(phi);
+         p[1]=radius * s * std::sin(phi);
+         p[2]=radius * z;
+      }
+
+   private:
+      /// Digits of 32 bit indices in bases 3 and 5.
+      static const int Digits3=21;
+      static const int Digits5=14;
+
+      /// Counter block of the random numbers of the scrambles, the RANDOM
+      /// pattern uses block 0 of each index.
+      static const DTS::Random::Word Scrambles=1;
+
+      Pattern pattern;
+      bool volume;
+      unsigned int count;
+      DTS::Random random;
+
+      double shift; ///< Turn of the Fibonacci points.
+      DTS::Random::Word scramble2; ///< Flipped bits in base 2.
+      unsigned char permutations3[Digits3][3];
+      unsigned char permutations5[Digits5][5];
+
+      /// Fisher-Yates shuffles of the digits of 'base', one per position.
+      void makePermutations(int base, int digits, unsigned char* permutations) const
+      {
+         for (int d=0; d < digits; d++)
+         {
+            unsigned char* permutation=permutations + d * base;
+            for (int k=0; k < base; k++)
+            {
+               permutation[k]=k;
+            }
+
+            DTS::Random::Word words[4];
+            random.generate(base * 64 + d, Scrambles, words);
+            for (int k=base - 1; k > 0; k--)
+            {
+               int j=int(DTS::Random::toUnit(words[k % 4]) * (k + 1));
+               std::swap(permutation[k], permutation[j]);
+            }
+         }
+      }
+
+      /// Scrambled radical inverse in base 2, flipping a digit in base 2
+      /// is the only permutation there is.
+      double radicalInverse2(unsigned int i) const
+      {
+         DTS::Random::Word bits=i;
+         bits=(bits << 16) | (bits >> 16);
+         bits=((bits & 0x00ff00ffu) << 8) | ((bits & 0xff00ff00u) >> 8);
+         bits=((bits & 0x0f0f0f0fu) << 4) | ((bits & 0xf0f0f0f0u) >> 4);
+         bits=((bits & 0x33333333u) << 2) | ((bits & 0xccccccccu) >> 2);
+         bits=((bits & 0x55555555u) << 1) | ((bits & 0xaaaaaaaau) >> 1);
+         return DTS::Random::toUnit(bits ^ scramble2);
+      }
+
+      /// Scrambled radical inverse, all 'digits' digits are permuted
+      /// including the leading zeros of small indices.
+      static double radicalInverse(unsigned int i, int base, int digits,
+            const unsigned char* permutations)
+      {
+         double value=0.0;
+         double scale=1.0 / base;
+         for (int d=0; d < digits; d++)
+         {
+            value+=permutations[d * base + i % base] * scale;
+            i/=base;
+            scale/=base;
+         }
+         // the center of the interval of the last digit
+         return value + 0.5 * scale * base;
+      }
+};
+
+#endif
@@ -0,0 +1,323 @@
+/*******************************************************************************
+ Sweep: Headless parameter sweep for bifurcation diagrams.
+
+ This file is part of the Dynamics Toolset.
+
+ The Dynamics Toolset is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by the Free
+ Software Foundation, either version 3 of the License, or (at your option) any
+ later version.
+
+ The Dynamics Toolset is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ details.
+
+ You should have received a copy of the GNU General Public License
+ along with the Dynamics Toolset. If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+
+/*
+ Loads the experiment plugins the way the application does, without Vrui, and
+ integrates one experiment for evenly spaced values of one of its real model
+ parameters (see DTS::ParameterSweep). For each value it discards a transient
+ and then collects either the local maxima of a coordinate or, with -l, the
+ upward crossings of the coordinate through a level. The points are streamed
+ to a binary file (see DTS::SweepFile) that the SweepViewer tool displays:
+
+   sweep -e experiment -a parameter -r first:last:count [-o sweep.sweep]
+         [-p plugins] [-m models] [-i integrator] [-t transient steps]
+         [-s steps] [-c coordinate] [-l level] [-n points per value]
+         [-j threads] [-x initial state]
+ */
+
+// STL includes
+//
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// System includes
+//
+#include <dlfcn.h>
+#include <pthread.h>
+#include <sys/time.h>
+
+// Project includes
+//
+#include "Factory.h"
+#include "ParameterSweep.h"
+#include "PluginLoader.h"
+#include "ThreadPool.h"
+
+///< Filled in by the plugins
+ExperimentFactory Factory;
+
+namespace
+{
+
+typedef Experiment<Scalar> DTSExperiment;
+typedef DTS::ParameterSweep<Scalar> Sweep;
+
+double now()
+{
+   struct timeval tv;
+   gettimeofday(&tv, 0);
+   return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+template <typename T>
+std::vector<T> parseList(const char* text, char separator)
+{
+   std::vector<T> values;
+   std::istringstream in(text);
+   std::string item;
+   while (std::getline(in, item, separator))
+   {
+      std::istringstream value(item);
+      T v;
+      if (value >> v)
+         values.push_back(v);
+   }
+   return values;
+}
+
+/** Reports the finished parameter values while the sweep runs.
+ */
+class ProgressReporter
+{
+   public:
+      ProgressReporter(const Sweep& sweep, unsigned int count) :
+         sweep(sweep), count(count), stopping(false)
+      {
+         pthread_mutex_init(&mutex, 0);
+         pthread_cond_init(&cond, 0);
+         pthread_create(&thread, 0, reportThread, this);
+      }
+
+      ~ProgressReporter()
+      {
+         pthread_mutex_lock(&mutex);
+         stopping=true;
+         pthread_cond_signal(&cond);
+         pthread_mutex_unlock(&mutex);
+         pthread_join(thread, 0);
+         pthread_cond_destroy(&cond);
+         pthread_mutex_destroy(&mutex);
+         std::fprintf(stderr, "\r   %u of %u parameter values\n", sweep.getNumFinished(), count);
+      }
+
+   private:
+      const Sweep& sweep;
+      unsigned int count;
+      bool stopping;
+      pthread_t thread;
+      pthread_mutex_t mutex;
+      pthread_cond_t cond;
+
+      static void* reportThread(void* self)
+      {
+         static_cast<ProgressReporter*> (self)->report();
+         return 0;
+      }
+
+      void report()
+      {
+         pthread_mutex_lock(&mutex);
+         while (!stopping)
+         {
+            std::fprintf(stderr, "\r   %u of %u parameter values", sweep.getNumFinished(), count);
+            std::fflush(stderr);
+
+            struct timeval tv;
+            gettimeofday(&tv, 0);
+            struct timespec deadline;
+            deadline.tv_sec=tv.tv_sec + 1;
+            deadline.tv_nsec=tv.tv_usec * 1000;
+            pthread_cond_timedwait(&cond, &mutex, &deadline);
+         }
+         pthread_mutex_unlock(&mutex);
+      }
+};
+
+void usage(const char* program)
+{
+   std::cerr << "Usage: " << program << " -e experiment -a parameter -r first:last:count"
+         << " [-o output.sweep] [-p plugin directory] [-m model directory] [-i integrator]"
+         << " [-t transient steps] [-s steps] [-c coordinate] [-l level] [-n points per value]"
+         << " [-j threads] [-x initial state]" << std::endl;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+   std::string pluginDirectory="plugins";
+   std::string modelDirectory="models";
+   std::string output="sweep.sweep";
+   std::string experimentName;
+   std::string integratorName;
+   std::vector<double> range;
+   int threads=DTS::ThreadPool::getNumProcessors();
+   Sweep::Settings settings;
+
+   for (int i=1; i < argc; i++)
+   {
+      std::string option=argv[i];
+      if (i + 1 >= argc || option.size() != 2 || option[0] != '-')
+      {
+         usage(argv[0]);
+         return 1;
+      }
+
+      const char* value=argv[++i];
+      switch (option[1])
+      {
+         case 'p':
+            pluginDirectory=value;
+            break;
+         case 'm':
+            modelDirectory=value;
+            break;
+         case 'o':
+            output=value;
+            break;
+         case 'e':
+            experimentName=value;
+            break;
+         case 'i':
+            integratorName=value;
+            break;
+         case 'a':
+            settings.parameter=value;
+            break;
+         case 'r':
+            range=parseList<double> (value, ':');
+            break;
+         case 't':
+            settings.transient=std::strtoul(value, 0, 10);
+            break;
+         case 's':
+            settings.steps=std::strtoul(value, 0, 10);
+            break;
+         case 'c':
+            settings.coordinate=std::atoi(value);
+            break;
+         case 'l':
+            settings.mode=DTS::SweepFile::CROSSINGS;
+            settings.level=std::atof(value);
+            break;
+         case 'n':
+            settings.maxPoints=std::atoi(value);
+            break;
+         case 'j':
+            threads=std::atoi(value);
+            break;
+         case 'x':
+            settings.initial=parseList<double> (value, ',');
+            break;
+         default:
+            usage(argv[0]);
+            return 1;
+      }
+   }
+
+   if (experimentName.empty() || settings.parameter.empty() || range.size() != 3 || range[2] < 1)
+   {
+      usage(argv[0]);
+      return 1;
+   }
+   settings.first=range[0];
+   settings.last=range[1];
+   settings.count=(unsigned int) range[2];
+
+   std::vector<void*> libraries;
+   loadPlugins(pluginDirectory, modelDirectory, libraries);
+
+   ExperimentFactory::iterator it=Factory.find(experimentName);
+   if (it == Factory.end())
+   {
+      std::cerr << "ERROR: no experiment " << experimentName << " in " << pluginDirectory
+            << std::endl;
+      return 1;
+   }
+
+   DTSExperiment* experiment=it->second();
+   experiment->setMaker(it->second);
+
+   int status=0;
+   int dimension=experiment->model->getDimension();
+   if (experiment->model->getRealParamIndex(settings.parameter) < 0)
+   {
+      std::cerr << "ERROR: " << experimentName << " has no parameter " << settings.parameter
+            << std::endl;
+      status=1;
+   }
+   else if (settings.coordinate >= (unsigned int) dimension)
+   {
+      std::cerr << "ERROR: " << experimentName << " has " << dimension << " coordinates"
+            << std::endl;
+      status=1;
+   }
+   else if (!settings.initial.empty() && settings.initial.size() != (size_t) dimension)
+   {
+      std::cerr << "ERROR: the initial state needs " << dimension << " values" << std::endl;
+      status=1;
+   }
+   else if (!integratorName.empty() && experiment->getIntegrator(integratorName) == 0)
+   {
+      std::cerr << "ERROR: " << experimentName << " has no integrator " << integratorName
+            << std::endl;
+      status=1;
+   }
+   else
+   {
+      if (!integratorName.empty())
+         experiment->setIntegrator(integratorName);
+
+      Sweep sweep(*experiment, settings);
+      DTS::SweepFile::Writer writer;
+      if (!writer.open(output, sweep.getHeader(experimentName)))
+      {
+         std::cerr << "ERROR: cannot write " << output << std::endl;
+         status=1;
+      }
+      else
+      {
+         DTS::ThreadPool pool(threads);
+         std::cerr << "Sweeping " << experimentName << " " << settings.parameter << " from "
+               << settings.first << " to " << settings.last << " with "
+               << experiment->integrator->getName() << " on " << pool.getNumThreads()
+               << " threads" << std::endl;
+
+         double start=now();
+         {
+            ProgressReporter progress(sweep, settings.count);
+            sweep.run(pool, writer);
+         }
+         double seconds=now() - start;
+
+         unsigned long long records=writer.getNumRecords();
+         if (!writer.close())
+         {
+            std::cerr << "ERROR: cannot write " << output << std::endl;
+            status=1;
+         }
+         else
+         {
+            std::cerr << records << " points written to " << output << " in " << seconds
+                  << " s" << std::endl;
+         }
+      }
+   }
+
+   delete experiment;
+
+   for (size_t i=0; i < libraries.size(); i++)
+      dlclose(libraries[i]);
+
+   return status;
+}
@@ -32,6 +32,7 @@ along with the Tool Box Library. If not, see <http://www.gnu.org/licenses/>.
 #include <ToolBox/Events.h>
 #include <ToolBox/Tool.h>
 #include <ToolBox/Icon.h> // To show icons
+#include "Dynamics/Trace.h"
 
 namespace ToolBox {
 namespace Extensions {
@@ -282,6 +283,7 @@ void ToolRotator::removed ( const ToolRemoveEvent & toolRemoveEvent )
 
 void ToolRotator::frame ( )
 {
+	DTS_TRACE_SCOPE ( "ToolRotator::frame" ) ;
 	if ( mOpenState != CLOSED && mDetachedState != DETACHED )
 	{
 		float distance ( minimumDegreeDistance ( mRotationCurrent, mRotationGoal ) ) ;
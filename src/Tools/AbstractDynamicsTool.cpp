@@ -21,6 +21,19 @@
 
 #include "FieldViewer.h"
 
+DTS::ThreadPool& AbstractDynamicsTool::threadPool() const
+{
+   return application->getThreadPool();
+}
+
+void AbstractDynamicsTool::finishSimulationStep() const
+{
+   if (experiment != 0 && !experiment->integrator->isReentrant())
+   {
+      application->finishSimulationStep();
+   }
+}
+
 void AbstractDynamicsTool::grabbed(const ToolBox::ToolGrabEvent & toolGrabEvent)
 {
    setDisabled(false);
@@ -23,6 +23,7 @@
 // Vrui includes
 //
 #include <Vrui/Vrui>
+#include <Threads/Mutex.h>
 
 // External includes
 //
@@ -30,7 +31,10 @@
 
 // Project includes
 //
+#include "Dynamics/Counters.h"
 #include "Dynamics/Experiment.h"
+#include "Dynamics/Random.h"
+#include "Dynamics/Trace.h"
 #include "CaveDialog.h"
 
 // Haven't yet decided how/where to make this globally available
@@ -44,6 +48,7 @@ class Viewer;
 namespace DTS
 {
 class DataItem;
+class ThreadPool;
 }
 
 /** Abstract base class for dynamics tools.
@@ -62,13 +67,41 @@ class AbstractDynamicsTool: public ToolBox::Tool
       bool locked; // when locked all user input is ignored but tools continue to step
       bool _needsGLSL;
 
+      /// Held while step() runs and while user input changes the data that
+      /// step() works on (see stepsAsynchronously).
+      Threads::Mutex dataMutex;
+
+      /// Counters of the time spent in step() and render(), -1 if not counted.
+      int stepCounter;
+      int renderCounter;
+
+      /// Trace markers of step(), render() and updatedExperiment().
+      const char* stepTraceName;
+      const char* renderTraceName;
+      const char* updateTraceName;
+
+      /// Key of the tool's random numbers, together with a frame or release
+      /// number (see DTS::Random).
+      DTS::Random::Word randomSeed;
+
+      /** The application's worker threads, shared by all tools.
+       */
+      DTS::ThreadPool& threadPool() const;
+
+      /** Wait for the simulation thread before using the integrator outside
+       * of step() and frame(), unless the integrator is reentrant.
+       */
+      void finishSimulationStep() const;
+
    public:
 
       /* Interface */
 
       AbstractDynamicsTool(ToolBox::ToolBox* toolBox, Viewer* app) :
          Tool(toolBox), toolbox(toolBox), application(app), experiment(0),
-               disabled(false), locked(false), _needsGLSL(true)
+               disabled(false), locked(false), _needsGLSL(true), stepCounter(-1),
+               renderCounter(-1), stepTraceName("step"), renderTraceName("render"),
+               updateTraceName("updatedExperiment"), randomSeed(0)
       {
       }
 
@@ -80,6 +113,75 @@ class AbstractDynamicsTool: public ToolBox::Tool
       virtual void render(DTS::DataItem* dataItem) const = 0;
       virtual void step() = 0;
 
+      /** Called by the application once per frame, before rendering.
+       *
+       * Tools that step asynchronously pick up their latest published
+       * particle buffers here.
+       */
+      virtual void frame()
+      {
+      }
+
+      /** Return true if step() may run on the application's simulation thread.
+       *
+       * Such tools must not let render() read anything step() writes;
+       * instead step() publishes its results through a TripleBuffer that is
+       * consumed in frame(). Everything else that changes the data step()
+       * works on must hold dataMutex.
+       */
+      virtual bool stepsAsynchronously() const
+      {
+         return false;
+      }
+
+      Threads::Mutex& getDataMutex()
+      {
+         return dataMutex;
+      }
+
+      /** Register the timers and trace markers of the tool under its name.
+       */
+      void setProfilingName(const std::string& name)
+      {
+         stepCounter=DTS::Counters::getCounter(name + " step", DTS::Counters::NANOSECONDS);
+         renderCounter=DTS::Counters::getCounter(name + " render", DTS::Counters::NANOSECONDS);
+         stepTraceName=DTS::Trace::intern(name + "::step");
+         renderTraceName=DTS::Trace::intern(name + "::render");
+         updateTraceName=DTS::Trace::intern(name + "::updatedExperiment");
+      }
+
+      /** Set the seed of the tool's random numbers, the same on every node.
+       */
+      void setRandomSeed(DTS::Random::Word seed)
+      {
+         randomSeed=seed;
+      }
+
+      int getStepCounter() const
+      {
+         return stepCounter;
+      }
+
+      int getRenderCounter() const
+      {
+         return renderCounter;
+      }
+
+      const char* getStepTraceName() const
+      {
+         return stepTraceName;
+      }
+
+      const char* getRenderTraceName() const
+      {
+         return renderTraceName;
+      }
+
+      const char* getUpdateTraceName() const
+      {
+         return updateTraceName;
+      }
+
       /* ToolBox::Tool methods */
       virtual void moved(const ToolBox::MotionEvent & motionEvent) = 0;
       virtual void mainButtonPressed(const ToolBox::ButtonPressEvent & buttonPressEvent) = 0;
@@ -21,6 +21,7 @@
 
 #include "GLMotif/WidgetFactory.h"
 #include "DotSpreaderTool.h"
+#include "Dynamics/Trace.h"
 
 GLMotif::PopupWindow* DotSpreaderOptionsDialog::createDialog()
 {
@@ -41,7 +42,7 @@ GLMotif::PopupWindow* DotSpreaderOptionsDialog::createDialog()
 
    // create and initialize slider object
    numberOfParticlesSlider=factory.createSlider("NumberOfParticlesSlider", 15.0);
-   numberOfParticlesSlider->setValueRange(1000.0, 250000.0, 1000.0);
+   numberOfParticlesSlider->setValueRange(1000.0, 500000.0, 1000.0);
    numberOfParticlesSlider->setValue(10000.0);
 
    // set the slider callback
@@ -58,6 +59,22 @@ GLMotif::PopupWindow* DotSpreaderOptionsDialog::createDialog()
 
    pointSizeSlider->getValueChangedCallbacks().add(this, &DotSpreaderOptionsDialog::sliderCallback);
 
+   factory.createLabel("NumberOfThreadsLabel", "Threads");
+
+   // the tool starts with one thread per processor
+   int numThreads=static_cast<DotSpreaderTool*> (tool)->getNumberOfThreads();
+   char buff[10];
+   snprintf(buff, sizeof(buff), "%i", numThreads);
+
+   numberOfThreadsValue=factory.createTextField("NumberOfThreadsTextField", 10);
+   numberOfThreadsValue->setString(buff);
+
+   numberOfThreadsSlider=factory.createSlider("NumberOfThreadsSlider", 15.0);
+   numberOfThreadsSlider->setValueRange(1.0, DTS::ThreadPool::getNumProcessors(), 1.0);
+   numberOfThreadsSlider->setValue(numThreads);
+
+   numberOfThreadsSlider->getValueChangedCallbacks().add(this, &DotSpreaderOptionsDialog::sliderCallback);
+
    // create distribution check boxes
    GLMotif::ToggleButton* surfaceDistributionToggle=factory.createCheckBox("SurfaceDistributionToggle", "Surface", true);
    GLMotif::ToggleButton* volumeDistributionToggle=factory.createCheckBox("VolumeDistributionToggle", "Volume");
@@ -76,6 +93,19 @@ GLMotif::PopupWindow* DotSpreaderOptionsDialog::createDialog()
    // assign callbacks for buttons
    clearParticles->getSelectCallbacks().add(this, &DotSpreaderOptionsDialog::buttonCallback);
 
+   // create sampling check boxes
+   GLMotif::ToggleButton* randomSamplingToggle=factory.createCheckBox("RandomSamplingToggle", "Random");
+   GLMotif::ToggleButton* fibonacciSamplingToggle=factory.createCheckBox("FibonacciSamplingToggle", "Fibonacci", true);
+   GLMotif::ToggleButton* haltonSamplingToggle=factory.createCheckBox("HaltonSamplingToggle", "Halton");
+
+   randomSamplingToggle->getValueChangedCallbacks().add(this, &DotSpreaderOptionsDialog::samplingTogglesCallback);
+   fibonacciSamplingToggle->getValueChangedCallbacks().add(this, &DotSpreaderOptionsDialog::samplingTogglesCallback);
+   haltonSamplingToggle->getValueChangedCallbacks().add(this, &DotSpreaderOptionsDialog::samplingTogglesCallback);
+
+   samplingToggles.push_back(randomSamplingToggle);
+   samplingToggles.push_back(fibonacciSamplingToggle);
+   samplingToggles.push_back(haltonSamplingToggle);
+
    parameterDialog->manageChild();
 
    return parameterDialogPopup;
@@ -83,6 +113,8 @@ GLMotif::PopupWindow* DotSpreaderOptionsDialog::createDialog()
 
 void DotSpreaderOptionsDialog::sliderCallback(GLMotif::Slider::ValueChangedCallbackData* cbData)
 {
+   DTS_TRACE_SCOPE("DotSpreaderOptionsDialog::sliderCallback");
+
    // get slider value
    float value=cbData->value;
 
@@ -108,6 +140,13 @@ void DotSpreaderOptionsDialog::sliderCallback(GLMotif::Slider::ValueChangedCallb
       snprintf(buff, sizeof(buff), "%.2f", value);
       pointSizeValue->setString(buff);
    }
+   else if (name == "NumberOfThreadsSlider")
+   {
+      pTool->setNumberOfThreads((int) value);
+
+      snprintf(buff, sizeof(buff), "%i", (int) value);
+      numberOfThreadsValue->setString(buff);
+   }
    else
    {
    }
@@ -115,6 +154,8 @@ void DotSpreaderOptionsDialog::sliderCallback(GLMotif::Slider::ValueChangedCallb
 
 void DotSpreaderOptionsDialog::distributionTogglesCallback(GLMotif::ToggleButton::ValueChangedCallbackData* cbData)
 {
+   DTS_TRACE_SCOPE("DotSpreaderOptionsDialog::distributionTogglesCallback");
+
    // set the dot spreader distribution method
 
    std::string name=cbData->toggle->getName();
@@ -140,8 +181,43 @@ void DotSpreaderOptionsDialog::distributionTogglesCallback(GLMotif::ToggleButton
          (*button)->setToggle(true);
 }
 
+void DotSpreaderOptionsDialog::samplingTogglesCallback(GLMotif::ToggleButton::ValueChangedCallbackData* cbData)
+{
+   DTS_TRACE_SCOPE("DotSpreaderOptionsDialog::samplingTogglesCallback");
+
+   // set how the dot spreader places the particles of a release
+
+   std::string name=cbData->toggle->getName();
+
+   DotSpreaderTool* pTool=static_cast<DotSpreaderTool*> (tool);
+
+   if (name == "RandomSamplingToggle")
+   {
+      pTool->setSamplingPattern(SphereSampler::RANDOM);
+   }
+   else if (name == "FibonacciSamplingToggle")
+   {
+      pTool->setSamplingPattern(SphereSampler::FIBONACCI);
+   }
+   else if (name == "HaltonSamplingToggle")
+   {
+      pTool->setSamplingPattern(SphereSampler::HALTON);
+   }
+
+   // fake radio-button behavior
+   for (ToggleArray::iterator button=samplingToggles.begin(); button
+         != samplingToggles.end(); ++button)
+      if (strcmp((*button)->getName(), name.c_str()) != 0
+            and (*button)->getToggle())
+         (*button)->setToggle(false);
+      else if (strcmp((*button)->getName(), name.c_str()) == 0)
+         (*button)->setToggle(true);
+}
+
 void DotSpreaderOptionsDialog::buttonCallback(GLMotif::Button::SelectCallbackData* cbData)
 {
+   DTS_TRACE_SCOPE("DotSpreaderOptionsDialog::buttonCallback");
+
    std::string name = cbData->button->getName();
    DotSpreaderTool* pTool=static_cast<DotSpreaderTool*> (tool);
    if (name == "ClearParticles")
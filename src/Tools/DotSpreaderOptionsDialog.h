@@ -39,14 +39,18 @@ class DotSpreaderOptionsDialog: public CaveDialog
 
       GLMotif::TextField* numberOfParticlesValue;
       GLMotif::TextField* pointSizeValue;
+      GLMotif::Slider* numberOfThreadsSlider;
+      GLMotif::TextField* numberOfThreadsValue;
 
       GLMotif::Button* clearParticles;
 
       void sliderCallback(GLMotif::Slider::ValueChangedCallbackData* cbData);
       void distributionTogglesCallback(GLMotif::ToggleButton::ValueChangedCallbackData* cbData);
+      void samplingTogglesCallback(GLMotif::ToggleButton::ValueChangedCallbackData* cbData);
       void buttonCallback(GLMotif::Button::SelectCallbackData* cbData);
 
       ToggleArray distributionToggles;
+      ToggleArray samplingToggles;
 
    protected:
       GLMotif::PopupWindow* createDialog();
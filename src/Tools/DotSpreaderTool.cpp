@@ -34,6 +34,10 @@
 //
 #include "VruiStreamManip.h"
 
+// Project includes
+//
+#include "Dynamics/Counters.h"
+
 //
 // DotSpreaderTool::Icon methods
 //
@@ -70,12 +74,15 @@ void DotSpreaderTool::initContext(GLContextData& contextData) const
    const int SIZE=12;
    float points[SIZE][3];
 
-   srand(1234);
+   DTS::Random random(1234);
    for (int i=0; i < SIZE; i++)
    {
-      points[i][0]=0.8 - 1.6 * ((float) rand() / (float) RAND_MAX);
-      points[i][1]=0.8 - 1.6 * ((float) rand() / (float) RAND_MAX);
-      points[i][2]=0.8 - 1.6 * ((float) rand() / (float) RAND_MAX);
+      double u[4];
+      random.uniform(i, 0, u);
+
+      points[i][0]=0.8 - 1.6 * u[0];
+      points[i][1]=0.8 - 1.6 * u[1];
+      points[i][2]=0.8 - 1.6 * u[2];
    }
 
    // create a new display list
@@ -258,14 +265,22 @@ void DotSpreaderTool::render(DTS::DataItem* dataItem) const
       glEnableClientState(GL_VERTEX_ARRAY);
       glEnableClientState(GL_COLOR_ARRAY);
 
+      // step() may be running concurrently, so draw the last published particles
+      const DotSpreaderData::Snapshot& snapshot=data.snapshots.getFront();
+
       // If data has been modified, send to graphics card
-      if (dataItem->versionDS != data.currentVersion)
+      if (dataItem->versionDS != snapshot.version)
       {
-         dataItem->numParticlesDS = data.numPoints;
-         glBufferDataARB(GL_ARRAY_BUFFER_ARB, dataItem->numParticlesDS
-               * sizeof(ColorPoint), &data.particles[0], GL_DYNAMIC_DRAW_ARB);
+         dataItem->numParticlesDS = snapshot.particles.size();
+         if (dataItem->numParticlesDS > 0)
+         {
+            glBufferDataARB(GL_ARRAY_BUFFER_ARB, dataItem->numParticlesDS
+                  * sizeof(ColorPoint), &snapshot.particles[0], GL_DYNAMIC_DRAW_ARB);
+            DTS::Counters::add(DTS::Counters::UPLOAD_BYTES, dataItem->numParticlesDS
+                  * sizeof(ColorPoint));
+         }
 
-         dataItem->versionDS = data.currentVersion;
+         dataItem->versionDS = snapshot.version;
       }
 
       glInterleavedArrays(GL_C4UB_V3F, sizeof(ColorPoint), 0);
@@ -293,23 +308,119 @@ void DotSpreaderTool::render(DTS::DataItem* dataItem) const
    }
 }
 
+namespace
+{
+
+/** Advances a range of particles, see DotSpreaderTool::step().
+ */
+class StepTask: public DTS::ThreadPool::Task
+{
+   public:
+      DTSExperiment* experiment;
+      int dimension;
+      size_t stride; ///< Length of each row of states.
+      double* states;
+      double* steps;
+      double* displays;
+      ColorPoint* particles;
+      Integrator<Scalar>::Workspace* workspaces; ///< Indexed by thread.
+
+      void run(size_t begin, size_t end, int thread)
+      {
+         size_t count=end - begin;
+
+         // a range of all rows has the same stride
+         experiment->integrator->stepBatch(states + begin, steps + begin,
+               count, stride, workspaces[thread]);
+         for (int k=0; k < dimension; k++)
+         {
+            double* state=states + k * stride;
+            const double* step=steps + k * stride;
+            for (size_t i=begin; i < end; i++)
+            {
+               state[i]+=step[i];
+            }
+         }
+
+         experiment->transformer->transformBatch(states + begin,
+               displays + 3 * begin, count, stride);
+         for (size_t i=begin; i < end; i++)
+         {
+            particles[i].pos[0] = displays[3 * i + 0];
+            particles[i].pos[1] = displays[3 * i + 1];
+            particles[i].pos[2] = displays[3 * i + 2];
+         }
+      }
+};
+
+/** Places a range of particles of a release, see
+ *  DotSpreaderTool::releaseParticles().
+ */
+class ReleaseTask: public DTS::ThreadPool::Task
+{
+   public:
+      const SphereSampler* sampler;
+      double center[3];
+      double radius;
+      double* displays;
+      ColorPoint* particles;
+
+      void run(size_t begin, size_t end, int thread)
+      {
+         for (size_t i=begin; i < end; i++)
+         {
+            double p[3];
+            sampler->sample(i, p);
+
+            ColorPoint& particle=particles[i];
+            for (int k=0; k < 3; k++)
+            {
+               displays[3 * i + k]=center[k] + radius * p[k];
+               particle.pos[k]=displays[3 * i + k];
+
+               // color by position in the bounding box of the sphere
+               particle.color[k]=(unsigned int) ((0.5 + 0.5 * p[k]) * 255.0);
+            }
+            particle.color[3]=255;
+         }
+      }
+};
+
+}
+
 void DotSpreaderTool::step()
 {
    // exit if simulation is paused (dragging release sphere)
-   if (!data.running)
+   if (!data.running || data.numPoints == 0)
       return;
 
-   for (int i=0; i < data.numPoints; i++)
+   // at most the tool's share of the application's threads
+   DTS::ThreadPool& pool=threadPool();
+   int numThreads=std::min(data.numThreads, pool.getNumThreads());
+   data.workspaces.resize(numThreads);
+
+   StepTask task;
+   task.experiment=experiment;
+   task.dimension=data.dimension;
+   task.stride=data.numPoints;
+   task.states=&data.states[0];
+   task.steps=&data.steps[0];
+   task.displays=&data.displays[0];
+   task.particles=&data.particles[0];
+   task.workspaces=&data.workspaces[0];
+
+   // split the particles across cores if the integrator allows it
+   if (experiment->integrator->isReentrant())
    {
-      experiment->integrator->step(data.states[i], tempState);
-      data.states[i] += tempState;
-      experiment->transformer->transform(data.states[i], tempDisplay);
-      data.particles[i].pos[0] = tempDisplay[0];
-      data.particles[i].pos[1] = tempDisplay[1];
-      data.particles[i].pos[2] = tempDisplay[2];
+      pool.parallelFor(data.numPoints, 1024, task, numThreads);
+   }
+   else
+   {
+      task.run(0, data.numPoints, 0);
    }
 
    data.currentVersion++;
+   data.publish();
 }
 
 void DotSpreaderTool::moved(const ToolBox::MotionEvent & motionEvent)
@@ -333,6 +444,7 @@ void DotSpreaderTool::mainButtonPressed(const ToolBox::ButtonPressEvent & motion
    org=toolBox()->deviceTransformationInModel().getOrigin();
 
    // pause simulation (integration)
+   Threads::Mutex::Lock lock(dataMutex);
    data.running=false;
 
    // set active (dragging) flag
@@ -362,90 +474,40 @@ void DotSpreaderTool::mainButtonReleased(const ToolBox::ButtonReleaseEvent & but
 
 void DotSpreaderTool::releaseParticles(Vrui::Point pos, Vrui::Scalar radius)
 {
-   // release particles distributed within sphere
-   double x, y, z;
-
-   double xMin=pos[0] - radius;
-   double xMax=pos[0] + radius;
-   double yMin=pos[1] - radius;
-   double yMax=pos[1] + radius;
-   double zMin=pos[2] - radius;
-   double zMax=pos[2] + radius;
-   double deltaX=xMax - xMin;
-   double deltaY=yMax - yMin;
-   double deltaZ=zMax - zMin;
-
-   if (data.distribution == DotSpreaderData::SURFACE)
+   Threads::Mutex::Lock lock(dataMutex);
+
+   // one stream per release, the samplers draw point i from its own counters
+   DTS::Random random(randomSeed, data.releases++);
+   SphereSampler sampler(data.sampling, data.distribution == DotSpreaderData::VOLUME,
+         data.numPoints, random);
+
+   if (data.numPoints > 0)
    {
-      // distribute particles on surface of sphere
-      for (int i=0; i < data.numPoints; i++)
+      // place the particles in display coordinates in parallel
+      ReleaseTask task;
+      task.sampler=&sampler;
+      for (int k=0; k < 3; k++)
       {
-
-         double u=(double) rand() / (double) RAND_MAX * 2.0 * radius - radius;
-         double theta=(double) rand() / (double) RAND_MAX * 2.0 * M_PI;
-
-         x=Math::sqrt(radius * radius - u * u) * Math::cos(theta);
-         y=Math::sqrt(radius * radius - u * u) * Math::sin(theta);
-         z=u;
-
-         x+=pos[0];
-         y+=pos[1];
-         z+=pos[2];
-
-         data.particles[i].pos[0]=x;
-         data.particles[i].pos[1]=y;
-         data.particles[i].pos[2]=z;
-
-         tempDisplay[0] = x;
-         tempDisplay[1] = y;
-         tempDisplay[2] = z;
-         experiment->transformer->invTransform(tempDisplay, data.states[i]);
-
-         data.particles[i].color[0]=(unsigned int) (((x - xMin) / deltaX)
-               * 255.0);
-         data.particles[i].color[1]=(unsigned int) (((y - yMin) / deltaY)
-               * 255.0);
-         data.particles[i].color[2]=(unsigned int) (((z - zMin) / deltaZ)
-               * 255.0);
-         data.particles[i].color[3]=255;
+         task.center[k]=pos[k];
       }
+      task.radius=radius;
+      task.displays=&data.displays[0];
+      task.particles=&data.particles[0];
+      threadPool().parallelFor(data.numPoints, 4096, task, data.numThreads);
    }
-   else if (data.distribution == DotSpreaderData::VOLUME)
-   {
-      // distribute particles within the sphere
-      for (int i=0; i < data.numPoints; i++)
-      {
 
-         do
-         {
-            x=((double) rand() / (double) RAND_MAX) * 2.0 * radius - radius;
-            y=((double) rand() / (double) RAND_MAX) * 2.0 * radius - radius;
-            z=((double) rand() / (double) RAND_MAX) * 2.0 * radius - radius;
-         } while (x * x + y * y + z * z > radius * radius);
-
-         x+=pos[0];
-         y+=pos[1];
-         z+=pos[2];
-
-         data.particles[i].pos[0]=x;
-         data.particles[i].pos[1]=y;
-         data.particles[i].pos[2]=z;
-
-         tempDisplay[0] = x;
-         tempDisplay[1] = y;
-         tempDisplay[2] = z;
-         experiment->transformer->invTransform(tempDisplay, data.states[i]);
-
-         data.particles[i].color[0]=(unsigned int) (((x - xMin) / deltaX)
-               * 255.0);
-         data.particles[i].color[1]=(unsigned int) (((y - yMin) / deltaY)
-               * 255.0);
-         data.particles[i].color[2]=(unsigned int) (((z - zMin) / deltaZ)
-               * 255.0);
-         data.particles[i].color[3]=255;
-      }
+   // the inverse transformation is not reentrant
+   std::vector<double> state(data.dimension);
+   for (int i=0; i < data.numPoints; i++)
+   {
+      experiment->invTransformState(&data.displays[3 * i], &state[0]);
+      data.setState(i, &state[0]);
    }
 
+   // show the released particles before the first step
+   data.currentVersion++;
+   data.publish();
+
    // turn off active (dragging) flag
    active=false;
    // resume simulation (integration)
@@ -28,6 +28,7 @@
 // STL includes
 //
 #include <vector>
+#include <algorithm>
 #include <iostream>
 
 // GL includes
@@ -39,8 +40,11 @@
 #include "FieldViewer.h"
 #include "DataItem.h"
 #include "ColorPoint.h"
+#include "SphereSampler.h"
+#include "TripleBuffer.h"
 #include "AbstractDynamicsTool.h"
 #include "Dynamics/Vector.h"
+#include "Dynamics/ThreadPool.h"
 
 #include "DotSpreaderOptionsDialog.h"
 
@@ -66,25 +70,50 @@ class DotSpreaderData
       };
 
       typedef std::vector<ColorPoint> ParticleArray;
-      typedef std::vector<DTS::Vector<double> > StateArray;
+      /// Particle states as structure-of-arrays: component k of particle i
+      /// is at states[k * numPoints + i].
+      typedef std::vector<double> StateArray;
+
+      /// Particles as published for rendering.
+      struct Snapshot
+      {
+         ParticleArray particles;
+         unsigned int version; ///< Value of currentVersion when published.
+
+         Snapshot() :
+            version(0)
+         {
+         }
+      };
 
    private:
       ParticleArray particles;
       StateArray states;
+      StateArray steps; ///< Step vectors, same layout as states.
+      std::vector<double> displays; ///< Display coordinates, xyz per particle.
 
       bool running;
       int numPoints;
       float point_radius;
       Distribution distribution;
+      SphereSampler::Pattern sampling; ///< Placement of the particles of a release.
       int dimension;
+      unsigned int releases; ///< Releases so far, keys their random positions.
 
       unsigned int currentVersion;
 
+      /// Written while holding the tool's data mutex, consumed in frame().
+      TripleBuffer<Snapshot> snapshots;
+
+      int numThreads; ///< Most threads of the application's pool that step() uses.
+      std::vector<Integrator<Scalar>::Workspace> workspaces; ///< One per pool thread.
+
       // numPoints(50000), point_radius(0.1),
 
       DotSpreaderData() :
          running(false), numPoints(10000), point_radius(0.05),
-               distribution(SURFACE), dimension(0), currentVersion(0)
+               distribution(SURFACE), sampling(SphereSampler::FIBONACCI), dimension(0), releases(0), currentVersion(0),
+               numThreads(DTS::ThreadPool::getNumProcessors())
       {
       }
 
@@ -95,16 +124,20 @@ class DotSpreaderData
 
       void setNumberOfParticles(int num)
       {
-         particles.resize(num);
-
-         if (num > numPoints)
+         // the rows are numPoints long, so they have to be moved
+         StateArray resized(num * dimension);
+         int keep=std::min(num, numPoints);
+         for (int k=0; k < dimension; k++)
          {
-            for (int i=numPoints; i < num; i++)
-            {
-               particles.push_back(ColorPoint());
-               states.push_back(DTS::Vector<double>(dimension));
-            }
+            std::copy(states.begin() + k * numPoints,
+                  states.begin() + k * numPoints + keep,
+                  resized.begin() + k * num);
          }
+         states.swap(resized);
+
+         particles.resize(num);
+         steps.resize(num * dimension);
+         displays.resize(num * 3);
          numPoints=num;
       }
 
@@ -112,12 +145,31 @@ class DotSpreaderData
       {
          this->dimension = dimension;
 
-         for (int i=0; i < numPoints; i++)
+         particles.resize(numPoints);
+         states.assign(numPoints * dimension, 0.0);
+         steps.resize(numPoints * dimension);
+         displays.resize(numPoints * 3);
+      }
+
+      /** Set the state of particle i from 'dimension' consecutive scalars.
+       */
+      void setState(int i, const double* state)
+      {
+         for (int k=0; k < dimension; k++)
          {
-            particles.push_back(ColorPoint());
-            states.push_back(DTS::Vector<double>(dimension));
+            states[k * numPoints + i]=state[k];
          }
       }
+
+      /** Publish the current particles for rendering.
+       */
+      void publish()
+      {
+         Snapshot& snapshot=snapshots.getBack();
+         snapshot.particles.assign(particles.begin(), particles.end());
+         snapshot.version=currentVersion;
+         snapshots.publish();
+      }
 };
 
 /** Computes the trajectories of a large number of particles.
@@ -127,8 +179,8 @@ class DotSpreaderData
  * main button. The user selects varies the radius of the sphere by holding down the
  * button and moving the wand. When the button is released, the particles' positions
  * will be initialized based on the distribution method (see DotSpreaderData). There
- * are two ways particles can be distributed, on the surface or throughout the volume.
- * In either case, the particle's color is determined by its initial position. Each
+ * are two ways particles can be distributed, on the surface or throughout the volume,
+ * and the sampling pattern (see SphereSampler) decides how evenly. In either case, the particle's color is determined by its initial position. Each
  * particle is assigned a color similar to that of its neighbors. Thus, red and purple
  * particles were initially located close to one another. This coloring allows the
  * user to observe how much mixing there is in the system.
@@ -168,7 +220,7 @@ class DotSpreaderTool: public AbstractDynamicsTool, public GLObject
 
       DotSpreaderTool(ToolBox::ToolBox* toolBox, Viewer* app) :
          AbstractDynamicsTool(toolBox, app), dataInited(false),
-         active(false), tempDisplay(3)
+         active(false)
       {
          icon(new Icon(this));
 
@@ -184,10 +236,10 @@ class DotSpreaderTool: public AbstractDynamicsTool, public GLObject
 
       virtual void setExperiment(DTSExperiment* e)
       {
+         Threads::Mutex::Lock lock(dataMutex);
          experiment = e;
-         tempState.setDimension( experiment->model->getDimension() );
 
-         if (!dataInited)
+         if (!dataInited || data.dimension != experiment->model->getDimension())
          {
             data.init( experiment->model->getDimension() );
             dataInited = true;
@@ -212,6 +264,16 @@ class DotSpreaderTool: public AbstractDynamicsTool, public GLObject
       virtual void render(DTS::DataItem* dataItem) const;
       virtual void step();
 
+      virtual void frame()
+      {
+         data.snapshots.consume();
+      }
+
+      virtual bool stepsAsynchronously() const
+      {
+         return true;
+      }
+
       virtual CaveDialog* createOptionsDialog(GLMotif::PopupMenu *parent)
       {
          dialog=new DotSpreaderOptionsDialog(parent, this);
@@ -222,12 +284,14 @@ class DotSpreaderTool: public AbstractDynamicsTool, public GLObject
 
       void clearParticles()
       {
+         Threads::Mutex::Lock lock(dataMutex);
          data.running = false;
          data.currentVersion++;
       }
 
       void setNumberOfParticles(unsigned int num)
       {
+         Threads::Mutex::Lock lock(dataMutex);
          data.setNumberOfParticles(num);
       }
 
@@ -236,11 +300,27 @@ class DotSpreaderTool: public AbstractDynamicsTool, public GLObject
          data.distribution=dist;
       }
 
+      void setSamplingPattern(SphereSampler::Pattern pattern)
+      {
+         data.sampling=pattern;
+      }
+
       void setPointSize(float value)
       {
          data.point_radius=value;
       }
 
+      void setNumberOfThreads(int num)
+      {
+         Threads::Mutex::Lock lock(dataMutex);
+         data.numThreads=std::max(num, 1);
+      }
+
+      int getNumberOfThreads() const
+      {
+         return data.numThreads;
+      }
+
       void releaseParticles(Vrui::Point pos, Vrui::Scalar radius);
 
    private:
@@ -251,8 +331,6 @@ class DotSpreaderTool: public AbstractDynamicsTool, public GLObject
 
       Vrui::Point pos;
       Vrui::Point org;
-      DTS::Vector<double> tempDisplay;
-      DTS::Vector<double> tempState;
 };
 
 #endif 	    /* !DOTSPREADERTOOL_H_ */
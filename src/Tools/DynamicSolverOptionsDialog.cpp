@@ -21,6 +21,7 @@
 
 #include "GLMotif/WidgetFactory.h"
 #include "DynamicSolverTool.h"
+#include "Dynamics/Trace.h"
 
 GLMotif::PopupWindow* DynamicSolverOptionsDialog::createDialog()
 {
@@ -131,6 +132,8 @@ GLMotif::PopupWindow* DynamicSolverOptionsDialog::createDialog()
 
 void DynamicSolverOptionsDialog::lineStyleTogglesCallback(GLMotif::ToggleButton::ValueChangedCallbackData* cbData)
 {
+   DTS_TRACE_SCOPE("DynamicSolverOptionsDialog::lineStyleTogglesCallback");
+
    // set the line rendering style
 
    std::string name=cbData->toggle->getName();
@@ -168,6 +171,8 @@ void DynamicSolverOptionsDialog::lineStyleTogglesCallback(GLMotif::ToggleButton:
 
 void DynamicSolverOptionsDialog::headStyleTogglesCallback(GLMotif::ToggleButton::ValueChangedCallbackData* cbData)
 {
+   DTS_TRACE_SCOPE("DynamicSolverOptionsDialog::headStyleTogglesCallback");
+
    // set head rendering style
 
    std::string name=cbData->toggle->getName();
@@ -205,6 +210,8 @@ void DynamicSolverOptionsDialog::headStyleTogglesCallback(GLMotif::ToggleButton:
 
 void DynamicSolverOptionsDialog::colorStyleTogglesCallback(GLMotif::ToggleButton::ValueChangedCallbackData* cbData)
 {
+   DTS_TRACE_SCOPE("DynamicSolverOptionsDialog::colorStyleTogglesCallback");
+
    // set color style
 
    std::string name=cbData->toggle->getName();
@@ -238,12 +245,16 @@ void DynamicSolverOptionsDialog::colorStyleTogglesCallback(GLMotif::ToggleButton
 
 void DynamicSolverOptionsDialog::clearPointsCallback(GLMotif::Button::SelectCallbackData* cbData)
 {
+   DTS_TRACE_SCOPE("DynamicSolverOptionsDialog::clearPointsCallback");
+
    DynamicSolverTool* pTool=static_cast<DynamicSolverTool*> (tool);
    pTool->clearPoints();
 }
 
 void DynamicSolverOptionsDialog::sliderCallback(GLMotif::Slider::ValueChangedCallbackData* cbData)
 {
+   DTS_TRACE_SCOPE("DynamicSolverOptionsDialog::sliderCallback");
+
    // get slider value
    float value=cbData->value;
 
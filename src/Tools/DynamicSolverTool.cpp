@@ -34,6 +34,10 @@
 //
 #include <algorithm>
 
+// Project includes
+//
+#include "Dynamics/Counters.h"
+
 //
 // DynamicSolverTool::Icon methods
 //
@@ -101,6 +105,12 @@ void DynamicSolverTool::initContext(GLContextData& contextData) const
 
 void DynamicSolverTool::render(DTS::DataItem* dataItem) const
 {
+   if (data.points.empty())
+      return;
+
+   // transform and upload all trails once for the styles below
+   updateVertices(dataItem);
+
    // draw lines
    if (data.lineStyle == DynamicSolverData::BASIC)
       drawBasicLines(dataItem);
@@ -116,31 +126,37 @@ void DynamicSolverTool::render(DTS::DataItem* dataItem) const
 
 void DynamicSolverTool::step()
 {
-   // for each point array (line)
-   for (Data::MultiPointArray::iterator pointSet=data.points.begin(); pointSet
-         != data.points.end(); ++pointSet)
+   const int dimension=data.dimension;
+   const unsigned int numLines=data.points.size();
+
+   if (numLines == 0)
+      return;
+
+   data.heads.resize(numLines * dimension);
+   data.steps.resize(numLines * dimension);
+
+   // gather the heads for the integrator
+   for (unsigned int i=0; i < numLines; i++)
    {
-      // for each point in line
-      for (Data::PointArray::iterator point=(*pointSet).begin(); point
-             != (*pointSet).end(); ++point)
+      const double* head=data.getState(i, 0);
+      for (int k=0; k < dimension; k++)
       {
-         // if point is the first value (head)
-         if (point == (*pointSet).begin())
-         {
-            // save the position
-            prev=(*point);
-            // integrate and move point to next position
-            experiment->integrator->step(*point, temp);
-            (*point) += temp;
-         }
-         // for all other points (tail) simply set to previous point
-         else
-         {
-            // We avoid std::swap which uses the copy constructor.
-            temp = (*point);
-            (*point) = prev;
-            prev = temp;
-         }
+         data.heads[k * numLines + i]=head[k];
+      }
+   }
+
+   // integrate all heads with one call
+   experiment->integrator->stepBatch(&data.heads[0], &data.steps[0], numLines, numLines);
+
+   // the next slot holds the oldest state; overwrite it with the new head,
+   // so the tail stays in place however long it is
+   data.head=(data.head + 1) % data.history_size;
+   for (unsigned int i=0; i < numLines; i++)
+   {
+      double* head=&data.points[i][data.head * dimension];
+      for (int k=0; k < dimension; k++)
+      {
+         head[k]=data.heads[k * numLines + i] + data.steps[k * numLines + i];
       }
    }
 }
@@ -149,8 +165,8 @@ void DynamicSolverTool::setExperiment(DTSExperiment* e)
 {
    experiment = e;
    clearPoints();
-   prev.setDimension(e->model->getDimension());
-   temp.setDimension(e->model->getDimension());
+   data.dimension=e->model->getDimension();
+   temp.setDimension(data.dimension);
 }
 
 void DynamicSolverTool::moved(const ToolBox::MotionEvent & motionEvent)
@@ -182,12 +198,12 @@ void DynamicSolverTool::mainButtonReleased(const ToolBox::ButtonReleaseEvent & b
 
    // create a new point array
    DynamicSolverData::PointArray array;
+   array.reserve(data.history_size * data.dimension);
 
    // initialize the array (set values to locator position)
    for (unsigned int i=0; i < data.history_size; i++)
    {
-      // makes a copy using copy constructor
-      array.push_back(temp);
+      array.insert(array.end(), temp.getComponents().begin(), temp.getComponents().end());
    }
 
    // add to point array vector
@@ -195,16 +211,22 @@ void DynamicSolverTool::mainButtonReleased(const ToolBox::ButtonReleaseEvent & b
 
    if (data.cluster_size > 1)
    {
+      // one stream per release, numbered by line and ring slot
+      DTS::Random random(randomSeed, data.releases++);
+
       for (unsigned int i=1; i < data.cluster_size; i++)
       {
-         DynamicSolverData::PointArray a;
+         DynamicSolverData::PointArray a(array);
 
          for (unsigned int j=0; j < data.history_size; j++)
          {
-            a.push_back(temp);
-            a[j][0] += (float) rand() / (float) RAND_MAX * 0.1 - 0.05;
-            a[j][1] += (float) rand() / (float) RAND_MAX * 0.1 - 0.05;
-            a[j][2] += (float) rand() / (float) RAND_MAX * 0.1 - 0.05;
+            double u[4];
+            random.uniform(i, j, u);
+
+            double* state=&a[j * data.dimension];
+            state[0] += u[0] * 0.1 - 0.05;
+            state[1] += u[1] * 0.1 - 0.05;
+            state[2] += u[2] * 0.1 - 0.05;
          }
 
          data.points.push_back(a);
@@ -217,54 +239,153 @@ void DynamicSolverTool::mainButtonReleased(const ToolBox::ButtonReleaseEvent & b
 // DynamicSolverTool internal methods
 //
 
-void DynamicSolverTool::drawBasicLines(DTS::DataItem* dataItem) const
+void DynamicSolverTool::updateVertices(DTS::DataItem* dataItem) const
 {
-   // save the current attribute state
-   glPushAttrib(GL_LIGHTING_BIT);
-   glDisable(GL_LIGHTING);
-
-   if (data.colorStyle == DynamicSolverData::SOLID)
+   const int dimension=data.dimension;
+   const unsigned int numLines=data.points.size();
+   const unsigned int history=data.history_size;
+   const size_t count=size_t(numLines) * history;
+
+   std::vector<double>& states=dataItem->dynamicSolverStates;
+   std::vector<double>& displays=dataItem->dynamicSolverDisplays;
+   std::vector<ColorPoint>& vertices=dataItem->dynamicSolverVertices;
+
+   states.resize(count * dimension);
+   displays.resize(3 * count);
+   vertices.resize(count);
+
+   // gather the trails oldest-last, line after line, so every state is
+   // transformed exactly once and by a single call
+   for (unsigned int i=0; i < numLines; i++)
    {
-      glColor3f(1.0, 0.0, 0.0);
-
-      // for all lines
-      for (unsigned int i=0; i < data.points.size(); i++)
+      for (unsigned int j=0; j < history; j++)
       {
-         glBegin(GL_LINES);
-         // for all points in line
-         for (unsigned int j=1; j < data.points[i].size(); j++)
+         const double* state=data.getState(i, j);
+         for (int k=0; k < dimension; k++)
          {
-            experiment->transformer->transform(data.points[i][j-1], dataItem->tempDisplay);
-            glVertex3f(dataItem->tempDisplay[0], dataItem->tempDisplay[1], dataItem->tempDisplay[2]);
-            experiment->transformer->transform(data.points[i][j], dataItem->tempDisplay);
-            glVertex3f(dataItem->tempDisplay[0], dataItem->tempDisplay[1], dataItem->tempDisplay[2]);
+            states[k * count + i * history + j]=state[k];
          }
-         glEnd();
       }
    }
 
-   else if (data.colorStyle == DynamicSolverData::GRADIENT)
+   experiment->transformer->transformBatch(&states[0], &displays[0], count, count);
+
+   for (unsigned int j=0; j < history; j++)
    {
-      // for all lines
-      for (unsigned int i=0; i < data.points.size(); i++)
+      int index=(int) ((float) j / (float) history * 255.0);
+      const float* color=data.colorMap->getColor(index);
+
+      for (unsigned int i=0; i < numLines; i++)
       {
-         glBegin(GL_LINES);
-         // for all points in line
-         for (unsigned int j=1; j < data.points[i].size(); j++)
-         {
-            int index=(int) ((float) j / (float) data.points[i].size() * 255.0);
-            const float* color=data.colorMap->getColor(index);
+         size_t v=i * history + j;
+         vertices[v].color[0]=GLubyte(color[0] * 255.0f);
+         vertices[v].color[1]=GLubyte(color[1] * 255.0f);
+         vertices[v].color[2]=GLubyte(color[2] * 255.0f);
+
+         // implicit cast from double to float
+         vertices[v].pos[0]=displays[3 * v + 0];
+         vertices[v].pos[1]=displays[3 * v + 1];
+         vertices[v].pos[2]=displays[3 * v + 2];
+      }
+   }
 
-            glColor3fv(color);
+   // without VBOs the vertices are drawn from client memory
+   const bool useBuffers=dataItem->hasVertexBufferObjectExtension;
 
-            experiment->transformer->transform(data.points[i][j-1], dataItem->tempDisplay);
-            glVertex3f(dataItem->tempDisplay[0], dataItem->tempDisplay[1], dataItem->tempDisplay[2]);
-            experiment->transformer->transform(data.points[i][j], dataItem->tempDisplay);
-            glVertex3f(dataItem->tempDisplay[0], dataItem->tempDisplay[1], dataItem->tempDisplay[2]);
+   if (useBuffers)
+   {
+      // the buffer grows geometrically and is orphaned otherwise, as in
+      // ParticleSprayerTool::render()
+      glBindBufferARB(GL_ARRAY_BUFFER_ARB, dataItem->dynamicSolverBufferId);
+      if (count > dataItem->dynamicSolverBufferCapacity)
+      {
+         size_t capacity=std::max<size_t>(2 * dataItem->dynamicSolverBufferCapacity, 4096);
+         while (capacity < count)
+            capacity*=2;
+         dataItem->dynamicSolverBufferCapacity=capacity;
+      }
+      glBufferDataARB(GL_ARRAY_BUFFER_ARB, dataItem->dynamicSolverBufferCapacity * sizeof(ColorPoint), NULL, GL_STREAM_DRAW_ARB);
+      glBufferSubDataARB(GL_ARRAY_BUFFER_ARB, 0, count * sizeof(ColorPoint), &vertices[0]);
+      DTS::Counters::add(DTS::Counters::UPLOAD_BYTES, count * sizeof(ColorPoint));
+      glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+   }
+
+   // the indices only depend on the number and length of the lines
+   if (dataItem->dynamicSolverIndexedLines != numLines
+         || dataItem->dynamicSolverIndexedHistory != history)
+   {
+      std::vector<GLuint>& indices=dataItem->dynamicSolverIndices;
+      indices.clear();
+      indices.reserve(numLines * (2 * (history - 1) + 1));
 
+      // one segment per pair of consecutive trail states
+      for (unsigned int i=0; i < numLines; i++)
+      {
+         for (unsigned int j=1; j < history; j++)
+         {
+            indices.push_back(i * history + j - 1);
+            indices.push_back(i * history + j);
          }
-         glEnd();
       }
+
+      // the heads, the first state of every line
+      for (unsigned int i=0; i < numLines; i++)
+      {
+         indices.push_back(i * history);
+      }
+
+      if (useBuffers)
+      {
+         glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, dataItem->dynamicSolverIndexBufferId);
+         glBufferDataARB(GL_ELEMENT_ARRAY_BUFFER_ARB, indices.size() * sizeof(GLuint), &indices[0], GL_STATIC_DRAW_ARB);
+         DTS::Counters::add(DTS::Counters::UPLOAD_BYTES, indices.size() * sizeof(GLuint));
+         glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, 0);
+      }
+
+      dataItem->dynamicSolverIndexedLines=numLines;
+      dataItem->dynamicSolverIndexedHistory=history;
+   }
+}
+
+void DynamicSolverTool::drawBasicLines(DTS::DataItem* dataItem) const
+{
+   const unsigned int numLines=data.points.size();
+
+   // save the current attribute state
+   glPushAttrib(GL_LIGHTING_BIT);
+   glDisable(GL_LIGHTING);
+
+   // a segment takes the color of its provoking vertex, the second index
+   // i*history + j of the pair, which is the older of its two states
+   glShadeModel(GL_FLAT);
+
+   // offsets into the buffers, or the client arrays without VBOs
+   const bool useBuffers=dataItem->hasVertexBufferObjectExtension;
+   const GLvoid* vertices=useBuffers ? 0 : &dataItem->dynamicSolverVertices[0];
+   const GLvoid* indices=useBuffers ? 0 : &dataItem->dynamicSolverIndices[0];
+
+   if (useBuffers)
+   {
+      glBindBufferARB(GL_ARRAY_BUFFER_ARB, dataItem->dynamicSolverBufferId);
+      glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, dataItem->dynamicSolverIndexBufferId);
+   }
+   glInterleavedArrays(GL_C4UB_V3F, sizeof(ColorPoint), vertices);
+
+   if (data.colorStyle == DynamicSolverData::SOLID)
+   {
+      glDisableClientState(GL_COLOR_ARRAY);
+      glColor3f(1.0, 0.0, 0.0);
+   }
+
+   // all segments of all lines with one call
+   glDrawElements(GL_LINES, 2 * numLines * (data.history_size - 1), GL_UNSIGNED_INT, indices);
+
+   glDisableClientState(GL_COLOR_ARRAY);
+   glDisableClientState(GL_VERTEX_ARRAY);
+   if (useBuffers)
+   {
+      glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, 0);
+      glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
    }
 
    // restore the previous attribute state
@@ -273,9 +394,10 @@ void DynamicSolverTool::drawBasicLines(DTS::DataItem* dataItem) const
 
 void DynamicSolverTool::drawPolylines(DTS::DataItem* dataItem) const
 {
-   // allocate space for gle rendering
-   gleDouble pts[data.history_size][3];
-   float colors[data.history_size][3];
+   const unsigned int history=data.history_size;
+
+   // colors at the polyline vertices
+   std::vector<float> colors(3 * history);
 
    // save the current attribute state
    glPushAttrib(GL_LIGHTING_BIT);
@@ -294,36 +416,28 @@ void DynamicSolverTool::drawPolylines(DTS::DataItem* dataItem) const
    {
       glDisable(GL_LIGHTING);
 
-      for (unsigned int i=0; i < data.history_size; i++)
+      for (unsigned int i=0; i < history; i++)
       {
-         int index=(int) ((float) i / (float) data.history_size * 255.0);
+         int index=(int) ((float) i / (float) history * 255.0);
          const float* color=data.colorMap->getColor(index);
 
-         colors[i][0]=color[0];
-         colors[i][1]=color[1];
-         colors[i][2]=color[2];
+         colors[3 * i + 0]=color[0];
+         colors[3 * i + 1]=color[1];
+         colors[3 * i + 2]=color[2];
       }
 
    }
 
+   // the display positions of each line are consecutive triples already
+   std::vector<double>& displays=dataItem->dynamicSolverDisplays;
+
    // for all lines
    for (unsigned int i=0; i < data.points.size(); i++)
    {
-      // for all points in line
-      for (unsigned int j=0; j < data.history_size; j++)
-      {
-         // set up gle data
-         experiment->transformer->transform(data.points[i][j], dataItem->tempDisplay);
-
-         pts[j][0] = dataItem->tempDisplay[0];
-         pts[j][1] = dataItem->tempDisplay[1];
-         pts[j][2] = dataItem->tempDisplay[2];
-      }
-
       // render line as a generalized cylinder
-      glePolyCylinder(data.history_size, // num points in polyline
-      pts, // polyline vertices
-      colors, // colors at polyline vertices
+      glePolyCylinder(history, // num points in polyline
+      reinterpret_cast<gleDouble(*)[3]> (&displays[3 * i * history]), // polyline vertices
+      reinterpret_cast<float(*)[3]> (&colors[0]), // colors at polyline vertices
       data.point_radius); // radius of polycylinder
    }
 
@@ -399,17 +513,35 @@ void DynamicSolverTool::drawPointHeads(DTS::DataItem* dataItem) const
       glPointParameterfvARB(GL_POINT_DISTANCE_ATTENUATION_ARB, attenuation);
    }
 
+   // render points, the head indices follow the segment indices
+   const unsigned int numSegmentIndices=2 * data.points.size() * (data.history_size - 1);
+
+   // offsets into the buffers, or the client arrays without VBOs
+   const bool useBuffers=dataItem->hasVertexBufferObjectExtension;
+   const GLvoid* vertices=useBuffers ? 0 : &dataItem->dynamicSolverVertices[0];
+   const GLvoid* heads=useBuffers
+         ? reinterpret_cast<const GLvoid*> (numSegmentIndices * sizeof(GLuint))
+         : &dataItem->dynamicSolverIndices[numSegmentIndices];
+
+   if (useBuffers)
+   {
+      glBindBufferARB(GL_ARRAY_BUFFER_ARB, dataItem->dynamicSolverBufferId);
+      glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, dataItem->dynamicSolverIndexBufferId);
+   }
+   glInterleavedArrays(GL_C4UB_V3F, sizeof(ColorPoint), vertices);
+   glDisableClientState(GL_COLOR_ARRAY);
+
    // set point color
    glColor4f(1.0, 0.8, 0.0, 1.0);
 
-   // render points
-   glBegin(GL_POINTS);
-   for (unsigned int i=0; i < data.points.size(); i++)
+   glDrawElements(GL_POINTS, data.points.size(), GL_UNSIGNED_INT, heads);
+
+   glDisableClientState(GL_VERTEX_ARRAY);
+   if (useBuffers)
    {
-      experiment->transformer->transform(data.points[i][0], dataItem->tempDisplay);
-      glVertex3f(dataItem->tempDisplay[0], dataItem->tempDisplay[1], dataItem->tempDisplay[2]);
+      glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, 0);
+      glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
    }
-   glEnd();
 
    if (dataItem->hasShaders)
    {
@@ -436,13 +568,25 @@ void DynamicSolverTool::drawSphereHeads(DTS::DataItem* dataItem) const
 
    glMaterial(GLMaterialEnums::FRONT_AND_BACK, material);
 
+   // the sphere is tessellated once into a display list, every head only
+   // moves it into place
+   if (dataItem->dynamicSolverSphereRadius != data.point_radius)
+   {
+      glNewList(dataItem->dynamicSolverSphereListId, GL_COMPILE);
+      glDrawSphereIcosahedron(data.point_radius, 12);
+      glEndList();
+      dataItem->dynamicSolverSphereRadius=data.point_radius;
+   }
+
    // for all lines render the head as a sphere
+   const std::vector<double>& displays=dataItem->dynamicSolverDisplays;
    for (unsigned int i=0; i < data.points.size(); i++)
    {
+      const double* display=&displays[3 * i * data.history_size];
+
       glPushMatrix();
-      experiment->transformer->transform(data.points[i][0], dataItem->tempDisplay);
-      glTranslatef(dataItem->tempDisplay[0], dataItem->tempDisplay[1], dataItem->tempDisplay[2]);
-      glDrawSphereIcosahedron(data.point_radius, 12);
+      glTranslated(display[0], display[1], display[2]);
+      glCallList(dataItem->dynamicSolverSphereListId);
       glPopMatrix();
    }
 
@@ -72,10 +72,14 @@ class DynamicSolverData
       };
 
    private:
-      typedef std::vector<DTS::Vector<double> > PointArray;
+      /// One line: a ring of history_size states of 'dimension' scalars each.
+      typedef std::vector<double> PointArray;
       typedef std::vector<PointArray> MultiPointArray;
 
       MultiPointArray points; ///< Actual point data.
+      unsigned int head; ///< Ring slot of the newest state, the same in every line.
+      std::vector<double> heads; ///< Heads of all lines, structure-of-arrays.
+      std::vector<double> steps; ///< Step vectors for the heads.
 
       LineStyle lineStyle; ///< Style used in rendering tail.
       HeadStyle headStyle; ///< Style used in rendering head (particle).
@@ -84,16 +88,30 @@ class DynamicSolverData
       float point_radius; ///< Size of head (particle).
       unsigned int history_size; ///< Length of tail.
       unsigned int cluster_size; ///< Number of particles in simultaneous release mode.
+      int dimension; ///< Number of scalars per state.
+      unsigned int releases; ///< Clusters released, keys their random offsets.
 
       ColorMap* colorMap; ///< Color map for rendering color gradient.
 
       DynamicSolverData() :
          lineStyle(POLYLINE), headStyle(POINT), colorStyle(SOLID),
-               point_radius(0.25), history_size(50), cluster_size(1)
+               head(0), point_radius(0.25), history_size(50), cluster_size(1), dimension(0), releases(0)
       {
          colorMap=new BlueRedColorMap;
       }
 
+      /** Returns state j of a line, counting back from the head (j=0).
+       *
+       * All lines advance together, so they share the head slot. New lines
+       * fill every slot with their first state, which makes any head slot
+       * valid for them.
+       */
+      const double* getState(unsigned int line, unsigned int j) const
+      {
+         unsigned int slot=(head + history_size - j) % history_size;
+         return &points[line][slot * dimension];
+      }
+
       ~DynamicSolverData()
       {
          delete colorMap;
@@ -215,10 +233,10 @@ class DynamicSolverTool: public AbstractDynamicsTool, public GLObject
       DynamicSolverData data;
 
       DTS::Vector<double> temp;
-      DTS::Vector<double> prev;
       DTS::Vector<double> tempDisplay;
 
       /* Internal methods */
+      void updateVertices(DTS::DataItem* dataItem) const;
       void drawBasicLines(DTS::DataItem* dataItem) const;
       void drawPolylines(DTS::DataItem* dataItem) const;
 
@@ -22,6 +22,7 @@
 
 #include "GLMotif/WidgetFactory.h"
 #include "ParticleSprayerTool.h"
+#include "Dynamics/Trace.h"
 
 GLMotif::PopupWindow* ParticleSprayerOptionsDialog::createDialog()
 {
@@ -77,6 +78,22 @@ GLMotif::PopupWindow* ParticleSprayerOptionsDialog::createDialog()
 
    pointSizeSlider->getValueChangedCallbacks().add(this, &ParticleSprayerOptionsDialog::sliderCallback);
 
+   factory.createLabel("NumberOfThreadsLabel", "Threads");
+
+   // the tool starts with one thread per processor
+   int numThreads=static_cast<ParticleSprayerTool*> (tool)->getNumberOfThreads();
+   char buff[10];
+   snprintf(buff, sizeof(buff), "%i", numThreads);
+
+   numberOfThreadsValue=factory.createTextField("NumberOfThreadsTextField", 10);
+   numberOfThreadsValue->setString(buff);
+
+   numberOfThreadsSlider=factory.createSlider("NumberOfThreadsSlider", 15.0);
+   numberOfThreadsSlider->setValueRange(1.0, DTS::ThreadPool::getNumProcessors(), 1.0);
+   numberOfThreadsSlider->setValue(numThreads);
+
+   numberOfThreadsSlider->getValueChangedCallbacks().add(this, &ParticleSprayerOptionsDialog::sliderCallback);
+
    sliderLayout->manageChild();
 
    factory.setLayout(parameterDialog);
@@ -120,6 +137,8 @@ GLMotif::PopupWindow* ParticleSprayerOptionsDialog::createDialog()
 
 void ParticleSprayerOptionsDialog::sliderCallback(GLMotif::Slider::ValueChangedCallbackData* cbData)
 {
+   DTS_TRACE_SCOPE("ParticleSprayerOptionsDialog::sliderCallback");
+
    // get slider value
    float value=cbData->value;
 
@@ -154,6 +173,13 @@ void ParticleSprayerOptionsDialog::sliderCallback(GLMotif::Slider::ValueChangedC
       snprintf(buff, sizeof(buff), "%.2f", value);
       pointSizeValue->setString(buff);
    }
+   else if (name == "NumberOfThreadsSlider")
+   {
+      pTool->setNumberOfThreads((int) value);
+
+      snprintf(buff, sizeof(buff), "%i", (int) value);
+      numberOfThreadsValue->setString(buff);
+   }
    else
    {
    }
@@ -161,6 +187,8 @@ void ParticleSprayerOptionsDialog::sliderCallback(GLMotif::Slider::ValueChangedC
 
 void ParticleSprayerOptionsDialog::actionTogglesCallback(GLMotif::ToggleButton::ValueChangedCallbackData* cbData)
 {
+   DTS_TRACE_SCOPE("ParticleSprayerOptionsDialog::actionTogglesCallback");
+
    // set the particle sprayer action
 
    std::string name=cbData->toggle->getName();
@@ -196,6 +224,8 @@ void ParticleSprayerOptionsDialog::actionTogglesCallback(GLMotif::ToggleButton::
 
 void ParticleSprayerOptionsDialog::buttonCallback(GLMotif::Button::SelectCallbackData* cbData)
 {
+   DTS_TRACE_SCOPE("ParticleSprayerOptionsDialog::buttonCallback");
+
    std::string name = cbData->button->getName();
    ParticleSprayerTool* pTool=static_cast<ParticleSprayerTool*> (tool);
    if (name == "ClearParticles")
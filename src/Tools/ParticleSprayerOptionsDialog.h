@@ -43,6 +43,9 @@ class ParticleSprayerOptionsDialog: public CaveDialog
       GLMotif::Slider* pointSizeSlider;
       GLMotif::TextField* pointSizeValue;
 
+      GLMotif::Slider* numberOfThreadsSlider;
+      GLMotif::TextField* numberOfThreadsValue;
+
       GLMotif::Button* clearParticles;
       GLMotif::Button* clearEmitters;
 
@@ -19,11 +19,23 @@
  *******************************************************************************/
 #include "ParticleSprayerTool.h"
 
+#include <algorithm>
+
 // OpenGL includes
 //
 #include <GL/glu.h>
 #include <GL/GLMaterial.h>
 
+// Project includes
+//
+#include "Dynamics/Counters.h"
+
+//
+// ParticleSprayerData initialization
+//
+
+const unsigned int ParticleSprayerData::MaxParticles=262144;
+
 //
 // ParticleSprayerTool::Icon methods
 //
@@ -52,13 +64,17 @@ void ParticleSprayerTool::initContext(GLContextData& contextData) const
 
    const float ToRadians=M_PI / 180.0;
 
-   // randomly distribute points within volume of a cone
-   srand(10000);
+   // randomly distribute points within volume of a cone, the same in
+   // every context
+   DTS::Random random(10000);
    for (unsigned int i=0; i < SIZE; i++)
    {
-      float fi=(float) rand() / (float) RAND_MAX * 30.0;
-      float theta=(float) rand() / (float) RAND_MAX * 360.0;
-      float r=(float) rand() / (float) RAND_MAX * 2.0;
+      double u[4];
+      random.uniform(i, 0, u);
+
+      float fi=u[0] * 30.0;
+      float theta=u[1] * 360.0;
+      float r=u[2] * 2.0;
 
       pts[i][0]=r * sin(fi * ToRadians) * cos(theta * ToRadians);
       pts[i][1]=r * sin(fi * ToRadians) * sin(theta * ToRadians);
@@ -177,22 +193,45 @@ void ParticleSprayerTool::render(DTS::DataItem* dataItem) const
 
    }
 
-   glBindBufferARB(GL_ARRAY_BUFFER_ARB, dataItem->vertexBufferId);
+   glBindBufferARB(GL_ARRAY_BUFFER_ARB, dataItem->particleSprayerBufferId);
    glEnableClientState(GL_VERTEX_ARRAY);
    glEnableClientState(GL_COLOR_ARRAY);
 
-   if (dataItem->versionDS != data.currentVersion)
+   // step() may be running concurrently, so draw the last published particles
+   const Data::Snapshot& snapshot=data.snapshots.getFront();
+
+   if (dataItem->versionPS != snapshot.version)
    {
-      dataItem->numParticlesDS = data.particles.size();
-      glBufferDataARB(GL_ARRAY_BUFFER_ARB, dataItem->numParticlesDS * sizeof(PointParticle), &data.particles[0], GL_DYNAMIC_DRAW_ARB);
-      dataItem->versionDS = data.currentVersion;
+      dataItem->numParticlesPS = snapshot.vertices.size();
+      size_t bytes=dataItem->numParticlesPS * sizeof(ColorPoint);
+
+      // The buffer is over-allocated and grows geometrically, so it is only
+      // reallocated when the particles outgrow it. Otherwise it is orphaned:
+      // respecifying the same size lets the driver hand out fresh storage
+      // while the GPU may still be drawing from the old one, instead of
+      // stalling the upload until it is done.
+      if (dataItem->numParticlesPS > dataItem->particleSprayerBufferCapacity)
+      {
+         size_t capacity=std::max<size_t>(2 * dataItem->particleSprayerBufferCapacity, 65536);
+         while (capacity < size_t(dataItem->numParticlesPS))
+            capacity*=2;
+         dataItem->particleSprayerBufferCapacity=capacity;
+      }
+      glBufferDataARB(GL_ARRAY_BUFFER_ARB, dataItem->particleSprayerBufferCapacity * sizeof(ColorPoint), NULL, GL_STREAM_DRAW_ARB);
+
+      if (dataItem->numParticlesPS > 0)
+      {
+         glBufferSubDataARB(GL_ARRAY_BUFFER_ARB, 0, bytes, &snapshot.vertices[0]);
+         DTS::Counters::add(DTS::Counters::UPLOAD_BYTES, bytes);
+      }
+      dataItem->versionPS = snapshot.version;
    }
 
-   glInterleavedArrays(GL_C4UB_V3F, sizeof(PointParticle), 0);
+   glInterleavedArrays(GL_C4UB_V3F, sizeof(ColorPoint), 0);
 
+   glDrawArrays(GL_POINTS, 0, dataItem->numParticlesPS);
 
-   // Care needed if particle number has changed but we haven't updated buffer.
-   glDrawArrays(GL_POINTS, 0, dataItem->numParticlesDS);
+   glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
 
    glDisableClientState(GL_COLOR_ARRAY);
    glDisableClientState(GL_VERTEX_ARRAY);
@@ -216,40 +255,169 @@ void ParticleSprayerTool::render(DTS::DataItem* dataItem) const
 
 void ParticleSprayerTool::setExperiment(DTSExperiment* e)
 {
+   Threads::Mutex::Lock lock(dataMutex);
    experiment = e;
-   clearParticles();
-   clearEmitters();
-   temp.setDimension( e->model->getDimension() );
-   old.setDimension( e->model->getDimension() );
+   data.emitters.clear();
+   // removes all particles
+   data.setDimension( e->model->getDimension() );
+   tempState.resize( e->model->getDimension() );
+
+   data.currentVersion++;
+   data.publish();
 }
 
-void ParticleSprayerTool::step()
+void ParticleSprayerTool::emit(const Vrui::Point& center)
 {
-   int dimension = experiment->model->getDimension();
+   if (data.dimension == 0)
+   {
+      return;
+   }
 
-   // iterator over all emitters and add particles to the simulation
-   for (Data::PointArray::iterator emit=data.emitters.begin(); emit
-         != data.emitters.end(); ++emit)
+   float cluster_radius=data.cluster_radius; // amount of "spread"
+   unsigned int count=data.allocate(data.cluster_size);
+
+   // the offsets are numbered through the frame, so each is drawn from the
+   // tool's stream for the frame on its own
+   DTS::Random random(randomSeed, data.frame);
+
+   double display[3];
+   for (unsigned int i=0; i < count; i++)
    {
-      int cluster_size=data.cluster_size;
-      float cluster_radius=data.cluster_radius;
+      double u[4];
+      random.uniform(data.emissions++, 0, u);
+
+      float dx = cluster_radius * (u[0] * 2.0 - 1.0);
+      float dy = cluster_radius * (u[1] * 2.0 - 1.0);
+      float dz = cluster_radius * (u[2] * 2.0 - 1.0);
+
+      display[0] = center[0] + dx;
+      display[1] = center[1] + dy;
+      display[2] = center[2] + dz;
+
+      experiment->invTransformState(display, &tempState[0]);
+      data.spawn(data.emitted[i], &tempState[0], display, data.lifetime);
+   }
+}
+
+namespace
+{
+
+/** Advances and colors a range of particles, see ParticleSprayerTool::step().
+ */
+class StepTask: public DTS::ThreadPool::Task
+{
+   public:
+      DTSExperiment* experiment;
+      int dimension;
+      size_t stride; ///< Length of each row of states.
+      double* states;
+      double* steps;
+      double* displays;
+      ColorPoint* vertices;
+      unsigned int* frames;
+      const unsigned char* alive;
+      Integrator<Scalar>::Workspace* workspaces; ///< Indexed by thread.
+      const BlueRedColorMap* colorMap;
+      float max_vel; ///< Squared speed mapped to the end of the color map.
+      std::vector<float> next_max; ///< Largest squared speed, per thread.
+
+      void run(size_t begin, size_t end, int thread)
+      {
+         float range_max=0.0;
 
-      for (int i=0; i < cluster_size; i++)
+         // step the runs of live slots, free slots are skipped
+         size_t i=begin;
+         while (i < end)
+         {
+            while (i < end && not alive[i])
+               i++;
+            size_t first=i;
+            while (i < end && alive[i])
+               i++;
+            if (first < i)
+               advance(first, i, thread, range_max);
+         }
+
+         if (range_max > next_max[thread])
+            next_max[thread]=range_max;
+      }
+
+   private:
+      /// Advances the live particles in [begin, end).
+      void advance(size_t begin, size_t end, int thread, float& range_max)
       {
-         float dx=cluster_radius * ((float) rand() / (float) RAND_MAX * 2.0 - 1.0);
-         float dy=cluster_radius * ((float) rand() / (float) RAND_MAX * 2.0 - 1.0);
-         float dz=cluster_radius * ((float) rand() / (float) RAND_MAX * 2.0 - 1.0);
+         size_t count=end - begin;
+
+         // compute the step vectors of the range with one call
+         experiment->integrator->stepBatch(states + begin, steps + begin,
+               count, stride, workspaces[thread]);
+
+         for (int k=0; k < dimension; k++)
+         {
+            double* state=states + k * stride;
+            const double* step=steps + k * stride;
+            for (size_t i=begin; i < end; i++)
+            {
+               state[i]+=step[i];
+            }
+         }
+
+         experiment->transformer->transformBatch(states + begin,
+               displays + 3 * begin, count, stride);
+
+         for (size_t i=begin; i < end; i++)
+         {
+            ColorPoint& particle=vertices[i];
+
+            // implicit cast from double to float
+            particle.pos[0] = displays[3 * i + 0];
+            particle.pos[1] = displays[3 * i + 1];
+            particle.pos[2] = displays[3 * i + 2];
+
+            // compute the (squared) speed of the particle
+            float speed = 0.0;
+            for (int j = 0; j < dimension; j++)
+            {
+               speed += steps[j * stride + i] * steps[j * stride + i];
+            }
+
+            range_max=(speed > range_max ? speed : range_max);
+
+            int index=(int) (sqrt(speed) / sqrt(max_vel) * 255.0);
+
+            if (index > 255)
+               index=255;
+            if (index < 0)
+               index=0;
 
-         Geometry::Point<double,3> shift((*emit)[0] + dx, (*emit)[1] + dy, (*emit)[2] + dz);
-         data.addParticle(PointParticle(shift, data.lifetime));
+            const float* cv=colorMap->getColor(index);
 
-         tempDisplay[0] = (*emit)[0] + dx;
-         tempDisplay[1] = (*emit)[1] + dy;
-         tempDisplay[2] = (*emit)[2] + dz;
-         experiment->transformer->invTransform(tempDisplay, temp);
-         data.states.push_back( temp );
+            // update particle color
+            particle.color[0]=(unsigned char) (cv[0] * 255.0);
+            particle.color[1]=(unsigned char) (cv[1] * 255.0);
+            particle.color[2]=(unsigned char) (cv[2] * 255.0);
 
+            // increment frame count
+            frames[i]++;
+         }
       }
+};
+
+}
+
+void ParticleSprayerTool::step()
+{
+   int dimension = data.dimension;
+
+   // start the random numbers of a new frame
+   data.frame++;
+   data.emissions=0;
+
+   // iterator over all emitters and add particles to the simulation
+   for (Data::PointArray::iterator emitter=data.emitters.begin(); emitter
+         != data.emitters.end(); ++emitter)
+   {
+      emit(*emitter);
    }
 
    // calculate color based on ratio of velocity to max. velocity
@@ -270,79 +438,45 @@ void ParticleSprayerTool::step()
 
    check_max=true;
 
-   // iterate over all particles
+   // delete expired particles
+   data.expire();
 
-   int i = 0;
-   Data::ParticleArray::iterator particle=data.particles.begin();
-   while ( particle != data.particles.end() )
-   {
-      // if particle has expired delete it
-      if ((*particle).frame > (*particle).lifetime)
-      {
-         // if the particle is the last one in the array do simple pop
-         if (particle == (data.particles.end() - 1))
-         {
-            data.particles.pop_back();
-            data.states.pop_back();
-            break;
-         }
-         // otherwise swap particle with end of array and then pop
-         else
-         {
-            (*particle)=*(data.particles.end() - 1);
-            data.particles.pop_back();
+   // all slots up to the high water mark, the task skips the free ones
+   unsigned int numSlots=data.highWater;
 
-            data.states[i] = data.states[ data.states.size() - 1 ];
-            data.states.pop_back();
-         }
-      }
-
-      // save previous position of particle
-      old = data.states[i];
-
-      // compute new position and update particle
-      experiment->integrator->step(data.states[i], temp);
-      data.states[i] += temp;
-
-      experiment->transformer->transform(data.states[i], tempDisplay);
-      // implicit cast from double to float
-      (*particle).pos[0] = tempDisplay[0];
-      (*particle).pos[1] = tempDisplay[1];
-      (*particle).pos[2] = tempDisplay[2];
-
-      // compute the (squared) speed of the particle
-      float speed = 0.0;
-      for (int j = 0; j < dimension; j++)
+   if (numSlots > 0)
+   {
+      // at most the tool's share of the application's threads
+      DTS::ThreadPool& pool=threadPool();
+      int numThreads=std::min(data.numThreads, pool.getNumThreads());
+      data.workspaces.resize(numThreads);
+
+      StepTask task;
+      task.experiment=experiment;
+      task.dimension=dimension;
+      task.stride=Data::MaxParticles;
+      task.states=&data.states[0];
+      task.steps=&data.steps[0];
+      task.displays=&data.displays[0];
+      task.vertices=&data.vertices[0];
+      task.frames=&data.frames[0];
+      task.alive=&data.alive[0];
+      task.workspaces=&data.workspaces[0];
+      task.colorMap=&data.colorMap;
+      task.max_vel=max_vel;
+      task.next_max.assign(numThreads, 0.0f);
+
+      // split the particles across cores if the integrator allows it
+      if (experiment->integrator->isReentrant())
       {
-         speed += (data.states[i][j] - old[j]) * (data.states[i][j] - old[j]);
+         pool.parallelFor(numSlots, 1024, task, numThreads);
       }
-
-      if (check_max)
+      else
       {
-         next_max=(speed > next_max ? speed : next_max);
+         task.run(0, numSlots, 0);
       }
 
-      int index=(int) (sqrt(speed) / sqrt(max_vel) * 255.0);
-
-      if (index > 255)
-         index=255;
-      if (index < 0)
-         index=0;
-
-      const float* cv=data.colorMap.getColor(index);
-
-      // update particle color
-      (*particle).color[0]=(unsigned char) (cv[0] * 255.0);
-      (*particle).color[1]=(unsigned char) (cv[1] * 255.0);
-      (*particle).color[2]=(unsigned char) (cv[2] * 255.0);
-
-      // increment frame count
-      (*particle).frame++;
-
-
-      // Next loop
-      ++particle;
-      ++i;
+      next_max=*std::max_element(task.next_max.begin(), task.next_max.end());
    }
 
    if (check_max)
@@ -350,6 +484,7 @@ void ParticleSprayerTool::step()
 
    // update data version (now out of sync)
    data.currentVersion++;
+   data.publish();
 }
 
 void ParticleSprayerTool::moved(const ToolBox::MotionEvent & motionEvent)
@@ -362,31 +497,14 @@ void ParticleSprayerTool::moved(const ToolBox::MotionEvent & motionEvent)
    // get current locator position
    pos=toolBox()->deviceTransformationInModel().getOrigin();
 
+   // particles and emitters are also used by step()
+   Threads::Mutex::Lock lock(dataMutex);
+
    // if spraying particles
    if (data.action == ParticleSprayerData::SPRAY_PARTICLES and active)
    {
-      int cluster_size=data.cluster_size; // number of particles to emit
-      float cluster_radius=data.cluster_radius; // amount of "spread"
-
-      DTS::Vector<double> invPos( experiment->model->getDimension() );
-
       // add particles to the simulation
-      for (int i=0; i < cluster_size; i++)
-      {
-         float dx = cluster_radius * ((float) rand() / (float) RAND_MAX * 2.0 - 1.0);
-         float dy = cluster_radius * ((float) rand() / (float) RAND_MAX * 2.0 - 1.0);
-         float dz = cluster_radius * ((float) rand() / (float) RAND_MAX * 2.0 - 1.0);
-
-         Geometry::Point<double,3> shift(pos[0] + dx, pos[1] + dy, pos[2] + dz);
-         data.addParticle(PointParticle(shift, data.lifetime));
-
-         tempDisplay[0] = pos[0] + dx;
-         tempDisplay[1] = pos[1] + dy;
-         tempDisplay[2] = pos[2] + dz;
-
-         experiment->transformer->invTransform(tempDisplay, invPos);
-         data.states.push_back( invPos );
-      }
+      emit(pos);
    }
 
    // if moving an emitter
@@ -434,6 +552,9 @@ void ParticleSprayerTool::mainButtonPressed(const ToolBox::ButtonPressEvent & mo
    // get current locator position
    pos=toolBox()->deviceTransformationInModel().getOrigin();
 
+   // emitters are also used by step()
+   Threads::Mutex::Lock lock(dataMutex);
+
    if (data.action == ParticleSprayerData::CREATE_EMITTER)
       data.addEmitter(pos);
 
@@ -23,6 +23,7 @@
 // STL includes
 //
 #include <vector>
+#include <algorithm>
 #include <iostream>
 
 // Vrui includes
@@ -38,10 +39,12 @@
 
 // Project includes
 //
+#include "ColorPoint.h"
 #include "DataItem.h"
-#include "PointParticle.h"
+#include "TripleBuffer.h"
 #include "AbstractDynamicsTool.h"
 #include "Dynamics/Vector.h"
+#include "Dynamics/ThreadPool.h"
 
 #include "ParticleSprayerOptionsDialog.h"
 
@@ -53,14 +56,37 @@ class ParticleSprayerTool;
  * ParticleSprayerData contains all data relevant to the ParticleSprayerTool.
  * Specifically, it stores the positions of all the particles in the system
  * as well as the positions and types of emitter objects.
+ *
+ * The particles live in a pool of MaxParticles slots that is allocated
+ * once per dimension. Each attribute is a column indexed by slot: states
+ * and step vectors structure-of-arrays (component k of slot i is at
+ * states[k * MaxParticles + i]), display positions, colors, frame counts
+ * and lifetimes. Expired particles put their slots on a free list, which
+ * emission uses first, so spawning and retiring particles never allocates.
+ * Slots [0, highWater) hold particles or are free; the pool is compacted
+ * when more than half of them are free.
  */
 class ParticleSprayerData
 {
       friend class ParticleSprayerTool;
 
-      typedef std::vector<PointParticle> ParticleArray;
+      typedef std::vector<ColorPoint> VertexArray;
       typedef std::vector<Vrui::Point> PointArray;
-      typedef std::vector<DTS::Vector<double> > StateArray;
+      typedef std::vector<double> StateArray;
+      typedef std::vector<unsigned int> IndexArray;
+
+      /// Particles as published for rendering.
+      struct Snapshot
+      {
+         /// Color and position of each live particle, packed.
+         VertexArray vertices;
+         unsigned int version; ///< Value of currentVersion when published.
+
+         Snapshot() :
+            version(0)
+         {
+         }
+      };
 
    public:
       /// Various sprayer actions.
@@ -69,10 +95,24 @@ class ParticleSprayerData
          SPRAY_PARTICLES, CREATE_EMITTER, MOVE_EMITTER, DELETE_EMITTER
       };
 
+      static const unsigned int MaxParticles; ///< Slots in the pool.
+
    private:
-      ParticleArray particles; ///< Point particles.
       PointArray emitters; ///< Location of particle emitters.
-      StateArray states; ///< Particle state variables (in n-dimensions).
+      StateArray states; ///< Particle state variables, structure-of-arrays.
+      StateArray steps; ///< Integrator step vectors, same layout as states.
+      std::vector<double> displays; ///< Display coordinates, xyz per slot.
+      VertexArray vertices; ///< Color and display position per slot.
+      IndexArray frames; ///< Frames lived, per slot.
+      IndexArray lifetimes; ///< Frames to live, per slot.
+      std::vector<unsigned char> alive; ///< Whether a slot holds a particle.
+      IndexArray freeSlots; ///< Free slots below highWater.
+      IndexArray emitted; ///< Slots of the burst being emitted, see allocate().
+      unsigned int highWater; ///< Slots at and above are unused.
+      unsigned int numParticles; ///< Live particles.
+
+      unsigned int frame; ///< Steps taken, keys the random numbers of emit().
+      unsigned int emissions; ///< Particles emitted in the frame.
 
       Action action; ///< Current sprayer action (mode).
 
@@ -86,16 +126,22 @@ class ParticleSprayerData
       float point_radius; ///< Size of the particles.
 
       unsigned int currentVersion; ///< For syncing VOB rendering.
+      TripleBuffer<Snapshot> snapshots; ///< Written while holding the tool's data mutex, consumed in frame().
+      int dimension; ///< Number of scalars per state.
 
       BlueRedColorMap colorMap; ///< Color map for coloring by velocity.
 
+      int numThreads; ///< Most threads of the application's pool that step() uses.
+      std::vector<Integrator<Scalar>::Workspace> workspaces; ///< One per pool thread.
+
       ParticleSprayerData() :
+         highWater(0), numParticles(0), frame(0), emissions(0),
          action(SPRAY_PARTICLES), selectedEmitter(NULL), hoveringEmitter(NULL),
          cluster_size(15), cluster_radius(0.5), lifetime(750),
-         emitter_radius(0.1), point_radius(0.05), currentVersion(0)
+         emitter_radius(0.1), point_radius(0.05), currentVersion(0),
+         dimension(0), numThreads(DTS::ThreadPool::getNumProcessors())
 
       {
-         particles.reserve(200000);
       }
 
       ~ParticleSprayerData()
@@ -110,11 +156,163 @@ class ParticleSprayerData
          emitters.push_back(p);
       }
 
-      /** Add a particle at specified position.
+      /** Set the dimension of the particle states and allocate the pool.
+       *  Removes all particles.
+       */
+      void setDimension(int d)
+      {
+         dimension=d;
+         states.assign(d * MaxParticles, 0.0);
+         steps.assign(d * MaxParticles, 0.0);
+         displays.assign(3 * MaxParticles, 0.0);
+         vertices.assign(MaxParticles, ColorPoint());
+         frames.assign(MaxParticles, 0);
+         lifetimes.assign(MaxParticles, 0);
+         alive.assign(MaxParticles, 0);
+         freeSlots.reserve(MaxParticles);
+         emitted.reserve(MaxParticles);
+         clear();
+      }
+
+      /** Remove all particles.
+       */
+      void clear()
+      {
+         std::fill(alive.begin(), alive.begin() + highWater, 0);
+         freeSlots.clear();
+         highWater=0;
+         numParticles=0;
+      }
+
+      /** Reserve slots for a burst of 'count' particles.
+       *
+       * The slots are left in 'emitted', free ones first; fewer than
+       * 'count' if the pool is full. Each must be filled with spawn().
+       *
+       * \return The number of slots reserved.
        */
-      void addParticle(const PointParticle& p)
+      unsigned int allocate(unsigned int count)
       {
-         particles.push_back(p);
+         emitted.clear();
+         while (emitted.size() < count && not freeSlots.empty())
+         {
+            emitted.push_back(freeSlots.back());
+            freeSlots.pop_back();
+         }
+
+         unsigned int fresh=std::min<unsigned int>(count - emitted.size(),
+               MaxParticles - highWater);
+         for (unsigned int i=0; i < fresh; i++)
+         {
+            emitted.push_back(highWater++);
+         }
+
+         numParticles+=emitted.size();
+         return emitted.size();
+      }
+
+      /** Place a new particle in a reserved slot.
+       *
+       * \param state 'dimension' consecutive scalars.
+       * \param display The display position of the state.
+       */
+      void spawn(unsigned int slot, const double* state, const double* display,
+            unsigned int lifetime)
+      {
+         for (int k=0; k < dimension; k++)
+         {
+            states[k * MaxParticles + slot]=state[k];
+         }
+
+         ColorPoint& vertex=vertices[slot];
+         vertex.pos[0]=display[0];
+         vertex.pos[1]=display[1];
+         vertex.pos[2]=display[2];
+         vertex.color[3]=255; // opaque
+
+         frames[slot]=0;
+         lifetimes[slot]=lifetime;
+         alive[slot]=1;
+      }
+
+      /** Free the slots of the particles that have outlived their lifetime.
+       */
+      void expire()
+      {
+         for (unsigned int i=0; i < highWater; i++)
+         {
+            if (alive[i] && frames[i] > lifetimes[i])
+            {
+               alive[i]=0;
+               freeSlots.push_back(i);
+               numParticles--;
+            }
+         }
+
+         if (numParticles < highWater / 2)
+         {
+            compact();
+         }
+      }
+
+      /** Move the particles from the top of the pool into the free slots
+       *  below, so that they occupy slots [0, numParticles).
+       */
+      void compact()
+      {
+         unsigned int free=0;
+         unsigned int used=highWater;
+         while (true)
+         {
+            while (free < used && alive[free])
+               free++;
+            while (used > free && not alive[used - 1])
+               used--;
+            if (free >= used)
+               break;
+
+            // move the particle in slot used-1 to slot free
+            unsigned int from=used - 1;
+            for (int k=0; k < dimension; k++)
+            {
+               states[k * MaxParticles + free]=states[k * MaxParticles + from];
+            }
+            vertices[free]=vertices[from];
+            frames[free]=frames[from];
+            lifetimes[free]=lifetimes[from];
+            alive[free]=1;
+            alive[from]=0;
+         }
+
+         highWater=numParticles;
+         freeSlots.clear();
+      }
+
+      /** Publish the current particles for rendering.
+       */
+      void publish()
+      {
+         Snapshot& snapshot=snapshots.getBack();
+
+         // the slots keep their capacity, so this allocates only while the
+         // number of particles grows
+         snapshot.vertices.resize(numParticles);
+         if (freeSlots.empty())
+         {
+            std::copy(vertices.begin(), vertices.begin() + numParticles,
+                  snapshot.vertices.begin());
+         }
+         else
+         {
+            size_t n=0;
+            for (unsigned int i=0; i < highWater; i++)
+            {
+               if (alive[i])
+                  snapshot.vertices[n++]=vertices[i];
+            }
+         }
+         snapshot.version=currentVersion;
+         snapshots.publish();
       }
 };
 
@@ -165,7 +363,7 @@ class ParticleSprayerTool: public AbstractDynamicsTool, public GLObject
       /* Interface */
 
       ParticleSprayerTool(ToolBox::ToolBox* toolBox, Viewer* app) :
-         AbstractDynamicsTool(toolBox, app), active(false), tempDisplay(3)
+         AbstractDynamicsTool(toolBox, app), active(false)
       {
          icon(new Icon(this));
 
@@ -182,6 +380,16 @@ class ParticleSprayerTool: public AbstractDynamicsTool, public GLObject
       virtual void render(DTS::DataItem* dataItem) const;
       virtual void step();
 
+      virtual void frame()
+      {
+         data.snapshots.consume();
+      }
+
+      virtual bool stepsAsynchronously() const
+      {
+         return true;
+      }
+
       virtual void setExperiment(DTSExperiment* e);
 
       virtual void moved(const ToolBox::MotionEvent & motionEvent);
@@ -213,15 +421,17 @@ class ParticleSprayerTool: public AbstractDynamicsTool, public GLObject
        */
       void clearParticles()
       {
-         data.particles.clear();
-         data.states.clear();
+         Threads::Mutex::Lock lock(dataMutex);
+         data.clear();
          data.currentVersion++;
+         data.publish();
       }
 
       /** Delete all emitter objects.
        */
       void clearEmitters()
       {
+         Threads::Mutex::Lock lock(dataMutex);
          data.emitters.clear();
       }
 
@@ -244,19 +454,33 @@ class ParticleSprayerTool: public AbstractDynamicsTool, public GLObject
          data.point_radius=value;
       }
 
+      void setNumberOfThreads(int num)
+      {
+         Threads::Mutex::Lock lock(dataMutex);
+         data.numThreads=std::max(num, 1);
+      }
+
+      int getNumberOfThreads() const
+      {
+         return data.numThreads;
+      }
+
    private:
       typedef ParticleSprayerData Data;
 
       bool active;
       ParticleSprayerData data;
 
-      DTS::Vector<double> tempDisplay;
-      DTS::Vector<double> temp;
-      DTS::Vector<double> old; // prev position of particle
+      std::vector<double> tempState;
 
 
       /* Internal methods */
       void drawEmitters() const;
+
+      /** Emits a cluster of particles around 'center', in one burst from
+       *  the pool. The caller holds the data mutex.
+       */
+      void emit(const Vrui::Point& center);
 };
 
 #endif
@@ -0,0 +1,164 @@
+/*******************************************************************************
+ PoincareSectionOptionsDialog: User-interface dialog for the PoincareSectionTool.
+
+ This file is part of the Dynamics Toolset.
+
+ The Dynamics Toolset is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by the Free
+ Software Foundation, either version 3 of the License, or (at your option) any
+ later version.
+
+ The Dynamics Toolset is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ details.
+
+ You should have received a copy of the GNU General Public License
+ along with the Dynamics Toolset. If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#include "PoincareSectionOptionsDialog.h"
+
+#include "GLMotif/WidgetFactory.h"
+#include "PoincareSectionTool.h"
+#include "Dynamics/Trace.h"
+
+GLMotif::PopupWindow* PoincareSectionOptionsDialog::createDialog()
+{
+   WidgetFactory factory;
+
+   // create popup-shell
+   GLMotif::PopupWindow* parameterDialogPopup=factory.createPopupWindow("ParameterDialogPopup", "Poincare Section Options");
+
+   // create the main layout
+   GLMotif::RowColumn* parameterDialog=factory.createRowColumn("ParameterDialog", 3);
+   factory.setLayout(parameterDialog);
+
+   factory.createLabel("NumberOfSeedsLabel", "Seeds");
+
+   numberOfSeedsValue=factory.createTextField("NumberOfSeedsTextField", 10);
+   numberOfSeedsValue->setString("10000");
+
+   numberOfSeedsSlider=factory.createSlider("NumberOfSeedsSlider", 15.0);
+   numberOfSeedsSlider->setValueRange(1000.0, 200000.0, 1000.0);
+   numberOfSeedsSlider->setValue(10000.0);
+
+   numberOfSeedsSlider->getValueChangedCallbacks().add(this, &PoincareSectionOptionsDialog::sliderCallback);
+
+   factory.createLabel("TransientLabel", "Transient Steps");
+
+   transientValue=factory.createTextField("TransientTextField", 10);
+   transientValue->setString("500");
+
+   transientSlider=factory.createSlider("TransientSlider", 15.0);
+   transientSlider->setValueRange(0.0, 10000.0, 100.0);
+   transientSlider->setValue(500.0);
+
+   transientSlider->getValueChangedCallbacks().add(this, &PoincareSectionOptionsDialog::sliderCallback);
+
+   factory.createLabel("PointSizeLabel", "Point Size");
+
+   pointSizeValue=factory.createTextField("PointSizeTextField", 10);
+   pointSizeValue->setString("2.0");
+
+   pointSizeSlider=factory.createSlider("PointSizeSlider", 15.0);
+   pointSizeSlider->setValueRange(1.0, 10.0, 0.5);
+   pointSizeSlider->setValue(2.0);
+
+   pointSizeSlider->getValueChangedCallbacks().add(this, &PoincareSectionOptionsDialog::sliderCallback);
+
+   factory.createLabel("NumberOfThreadsLabel", "Threads");
+
+   // the tool starts with one thread per processor
+   int numThreads=static_cast<PoincareSectionTool*> (tool)->getNumberOfThreads();
+   char buff[10];
+   snprintf(buff, sizeof(buff), "%i", numThreads);
+
+   numberOfThreadsValue=factory.createTextField("NumberOfThreadsTextField", 10);
+   numberOfThreadsValue->setString(buff);
+
+   numberOfThreadsSlider=factory.createSlider("NumberOfThreadsSlider", 15.0);
+   numberOfThreadsSlider->setValueRange(1.0, DTS::ThreadPool::getNumProcessors(), 1.0);
+   numberOfThreadsSlider->setValue(numThreads);
+
+   numberOfThreadsSlider->getValueChangedCallbacks().add(this, &PoincareSectionOptionsDialog::sliderCallback);
+
+   GLMotif::ToggleButton* bothDirectionsToggle=factory.createCheckBox("BothDirectionsToggle", "Both Directions");
+   bothDirectionsToggle->getValueChangedCallbacks().add(this, &PoincareSectionOptionsDialog::toggleCallback);
+
+   // create push buttons
+   GLMotif::Button* clearPoints=factory.createButton("ClearPoints", "Clear Points");
+   clearPoints->getSelectCallbacks().add(this, &PoincareSectionOptionsDialog::buttonCallback);
+
+   parameterDialog->manageChild();
+
+   return parameterDialogPopup;
+}
+
+void PoincareSectionOptionsDialog::sliderCallback(GLMotif::Slider::ValueChangedCallbackData* cbData)
+{
+   DTS_TRACE_SCOPE("PoincareSectionOptionsDialog::sliderCallback");
+
+   // get slider value
+   float value=cbData->value;
+
+   // update text field
+   char buff[10];
+
+   PoincareSectionTool* pTool=static_cast<PoincareSectionTool*> (tool);
+
+   std::string name=cbData->slider->getName();
+
+   if (name == "NumberOfSeedsSlider")
+   {
+      pTool->setNumberOfSeeds((unsigned int) value);
+
+      snprintf(buff, sizeof(buff), "%i", (unsigned int) value);
+      numberOfSeedsValue->setString(buff);
+   }
+   else if (name == "TransientSlider")
+   {
+      pTool->setTransient((unsigned int) value);
+
+      snprintf(buff, sizeof(buff), "%i", (unsigned int) value);
+      transientValue->setString(buff);
+   }
+   else if (name == "PointSizeSlider")
+   {
+      pTool->setPointSize(value);
+
+      snprintf(buff, sizeof(buff), "%.1f", value);
+      pointSizeValue->setString(buff);
+   }
+   else if (name == "NumberOfThreadsSlider")
+   {
+      pTool->setNumberOfThreads((int) value);
+
+      snprintf(buff, sizeof(buff), "%i", (int) value);
+      numberOfThreadsValue->setString(buff);
+   }
+}
+
+void PoincareSectionOptionsDialog::toggleCallback(GLMotif::ToggleButton::ValueChangedCallbackData* cbData)
+{
+   DTS_TRACE_SCOPE("PoincareSectionOptionsDialog::toggleCallback");
+
+   std::string name=cbData->toggle->getName();
+   PoincareSectionTool* pTool=static_cast<PoincareSectionTool*> (tool);
+
+   if (name == "BothDirectionsToggle")
+   {
+      pTool->setBothDirections(cbData->set);
+   }
+}
+
+void PoincareSectionOptionsDialog::buttonCallback(GLMotif::Button::SelectCallbackData* cbData)
+{
+   DTS_TRACE_SCOPE("PoincareSectionOptionsDialog::buttonCallback");
+
+   std::string name=cbData->button->getName();
+   PoincareSectionTool* pTool=static_cast<PoincareSectionTool*> (tool);
+   if (name == "ClearPoints")
+   {
+      pTool->clearPoints();
+   }
+}
@@ -0,0 +1,62 @@
+/*******************************************************************************
+ PoincareSectionOptionsDialog: User-interface dialog for the PoincareSectionTool.
+
+ This file is part of the Dynamics Toolset.
+
+ The Dynamics Toolset is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by the Free
+ Software Foundation, either version 3 of the License, or (at your option) any
+ later version.
+
+ The Dynamics Toolset is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ details.
+
+ You should have received a copy of the GNU General Public License
+ along with the Dynamics Toolset. If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#ifndef POINCARE_SECTION_OPTIONS_DIALOG_H
+#define POINCARE_SECTION_OPTIONS_DIALOG_H
+
+#include <GLMotif/GLMotif>
+#include "CaveDialog.h"
+
+#include "AbstractDynamicsTool.h"
+
+/** User-interface dialog for setting PoincareSectionTool options.
+ *
+ */
+class PoincareSectionOptionsDialog: public CaveDialog
+{
+      AbstractDynamicsTool* tool;
+
+      GLMotif::Slider* numberOfSeedsSlider;
+      GLMotif::TextField* numberOfSeedsValue;
+      GLMotif::Slider* transientSlider;
+      GLMotif::TextField* transientValue;
+      GLMotif::Slider* pointSizeSlider;
+      GLMotif::TextField* pointSizeValue;
+      GLMotif::Slider* numberOfThreadsSlider;
+      GLMotif::TextField* numberOfThreadsValue;
+
+      void sliderCallback(GLMotif::Slider::ValueChangedCallbackData* cbData);
+      void toggleCallback(GLMotif::ToggleButton::ValueChangedCallbackData* cbData);
+      void buttonCallback(GLMotif::Button::SelectCallbackData* cbData);
+
+   protected:
+      GLMotif::PopupWindow* createDialog();
+
+   public:
+      PoincareSectionOptionsDialog(GLMotif::PopupMenu *parentMenu, AbstractDynamicsTool *t) :
+         CaveDialog(parentMenu), tool(t)
+      {
+         dialogWindow=createDialog();
+      }
+
+      virtual ~PoincareSectionOptionsDialog()
+      {
+      }
+};
+
+#endif
@@ -0,0 +1,670 @@
+/*******************************************************************************
+ PoincareSectionTool: Collects the crossings of trajectories through a plane.
+
+ This file is part of the Dynamics Toolset.
+
+ The Dynamics Toolset is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by the Free
+ Software Foundation, either version 3 of the License, or (at your option) any
+ later version.
+
+ The Dynamics Toolset is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ details.
+
+ You should have received a copy of the GNU General Public License
+ along with the Dynamics Toolset. If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#include "PoincareSectionTool.h"
+
+// STL includes
+//
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+// External includes
+//
+#include "VruiStreamManip.h"
+
+// Project includes
+//
+#include "Dynamics/Counters.h"
+
+//
+// PoincareSectionTool initialization
+//
+
+const size_t PoincareSectionTool::MaxHits=4 * 1024 * 1024;
+
+//
+// PoincareSectionTool::Icon methods
+//
+
+void PoincareSectionTool::Icon::display(GLContextData& contextData) const
+{
+   DataItem* dataItem=contextData.retrieveDataItem<DataItem> (parent);
+   glCallList(dataItem->displayListId);
+}
+
+//
+// PoincareSectionTool::DataItem methods
+//
+
+PoincareSectionTool::DataItem::DataItem(void) :
+   displayListId(glGenLists(1))
+{
+}
+
+PoincareSectionTool::DataItem::~DataItem(void)
+{
+   glDeleteLists(displayListId, 1);
+}
+
+namespace
+{
+
+/** Signed distance of a display point from the plane.
+ */
+inline double planeSide(const double* origin, const double* normal, const double* display)
+{
+   return (display[0] - origin[0]) * normal[0] + (display[1] - origin[1]) * normal[1]
+         + (display[2] - origin[2]) * normal[2];
+}
+
+/** Two unit vectors spanning the plane with the given unit normal.
+ */
+void planeAxes(const double* normal, double* u, double* v)
+{
+   // start from the coordinate axis least aligned with the normal
+   double axis[3]= { 0.0, 0.0, 0.0 };
+   int smallest=0;
+   for (int k=1; k < 3; k++)
+   {
+      if (std::abs(normal[k]) < std::abs(normal[smallest]))
+         smallest=k;
+   }
+   axis[smallest]=1.0;
+
+   // u = axis x normal, v = normal x u
+   u[0]=axis[1] * normal[2] - axis[2] * normal[1];
+   u[1]=axis[2] * normal[0] - axis[0] * normal[2];
+   u[2]=axis[0] * normal[1] - axis[1] * normal[0];
+   double length=std::sqrt(u[0] * u[0] + u[1] * u[1] + u[2] * u[2]);
+   for (int k=0; k < 3; k++)
+      u[k]/=length;
+
+   v[0]=normal[1] * u[2] - normal[2] * u[1];
+   v[1]=normal[2] * u[0] - normal[0] * u[2];
+   v[2]=normal[0] * u[1] - normal[1] * u[0];
+}
+
+/** Locates the point within one step where a trajectory meets the plane.
+ *
+ * The trajectory between the states x0 and x1 one step h apart is taken to
+ * be the cubic Hermite interpolant of the states and the derivatives f0 and
+ * f1 there, which is as accurate as a fourth order step. Its crossing is
+ * found by regula falsi with the Illinois modification, which keeps the
+ * root bracketed and converges superlinearly. Without a step size (h = 0)
+ * the interpolant is the straight line between the states.
+ */
+class CrossingLocator
+{
+   public:
+      CrossingLocator(const DTSExperiment* experiment, double stepSize) :
+         experiment(experiment), dimension(experiment->model->getDimension()),
+               stepSize(stepSize), f0(dimension), f1(dimension), x(dimension),
+               stateTemp(dimension), valueTemp(dimension)
+      {
+      }
+
+      /** Finds the crossing between x0 (distance g0 from the plane) and x1
+       * (distance g1 of the other sign) and writes its display coordinates.
+       */
+      void locate(const double* x0, const double* x1, double g0, double g1,
+            const double* origin, const double* normal, double* display)
+      {
+         if (stepSize != 0.0)
+         {
+            experiment->model->evaluateState(x0, &f0[0], stateTemp, valueTemp);
+            experiment->model->evaluateState(x1, &f1[0], stateTemp, valueTemp);
+         }
+
+         double tolerance=1e-6 * (std::abs(g0) + std::abs(g1));
+         double a=0.0, ga=g0;
+         double b=1.0, gb=g1;
+         int side=0; ///< End replaced last, -1 for a and 1 for b.
+
+         for (int iteration=0; iteration < MaxIterations; iteration++)
+         {
+            double theta=(a * gb - b * ga) / (gb - ga);
+            interpolate(x0, x1, theta);
+            experiment->transformer->transformBatch(&x[0], display, 1, 1);
+
+            double g=planeSide(origin, normal, display);
+            if (std::abs(g) <= tolerance)
+               return;
+
+            if ((g < 0.0) == (ga < 0.0))
+            {
+               a=theta;
+               ga=g;
+               if (side == -1)
+                  gb*=0.5;
+               side=-1;
+            }
+            else
+            {
+               b=theta;
+               gb=g;
+               if (side == 1)
+                  ga*=0.5;
+               side=1;
+            }
+         }
+      }
+
+   private:
+      static const int MaxIterations=12;
+
+      const DTSExperiment* experiment;
+      int dimension;
+      double stepSize;
+      std::vector<double> f0;
+      std::vector<double> f1;
+      std::vector<double> x;
+      DTS::Vector<double> stateTemp; ///< Arguments of the model, see DynamicalModel::evaluateState().
+      DTS::Vector<double> valueTemp;
+
+      void interpolate(const double* x0, const double* x1, double theta)
+      {
+         double t2=theta * theta;
+         double t3=t2 * theta;
+         double h00=2.0 * t3 - 3.0 * t2 + 1.0;
+         double h10=(t3 - 2.0 * t2 + theta) * stepSize;
+         double h01=-2.0 * t3 + 3.0 * t2;
+         double h11=(t3 - t2) * stepSize;
+
+         for (int k=0; k < dimension; k++)
+         {
+            x[k]=h00 * x0[k] + h01 * x1[k];
+            if (stepSize != 0.0)
+               x[k]+=h10 * f0[k] + h11 * f1[k];
+         }
+      }
+};
+
+/** Advances a range of seeds and collects their crossings, see
+ * PoincareSectionTool::step().
+ */
+class StepTask: public DTS::ThreadPool::Task
+{
+   public:
+      DTSExperiment* experiment;
+      int dimension;
+      size_t stride; ///< Length of each row of states.
+      double stepSize; ///< Of the integrator, 0 if it has none.
+      double* states;
+      double* steps;
+      double* displays;
+      double* sides;
+      unsigned int* ages;
+      const GLColor<GLubyte, 4>* colors;
+      unsigned int transient;
+      bool bothDirections;
+      const double* origin;
+      const double* normal;
+      Integrator<Scalar>::Workspace* workspaces; ///< Indexed by thread.
+      PoincareSectionData::HitArray* hits; ///< Indexed by thread.
+
+      void run(size_t begin, size_t end, int thread)
+      {
+         size_t count=end - begin;
+
+         // a range of all rows has the same stride
+         experiment->integrator->stepBatch(states + begin, steps + begin,
+               count, stride, workspaces[thread]);
+         for (int k=0; k < dimension; k++)
+         {
+            double* state=states + k * stride;
+            const double* step=steps + k * stride;
+            for (size_t i=begin; i < end; i++)
+            {
+               state[i]+=step[i];
+            }
+         }
+
+         experiment->transformer->transformBatch(states + begin,
+               displays + 3 * begin, count, stride);
+
+         // created with the first crossing, most steps have none
+         CrossingLocator* locator=0;
+         std::vector<double> x0;
+         std::vector<double> x1;
+
+         for (size_t i=begin; i < end; i++)
+         {
+            double g0=sides[i];
+            double g1=planeSide(origin, normal, displays + 3 * i);
+            sides[i]=g1;
+
+            // the first step leaves the plane the seed started on
+            if (ages[i] <= transient)
+            {
+               ages[i]++;
+               continue;
+            }
+
+            if (!((g0 < 0.0 && g1 >= 0.0) || (bothDirections && g0 >= 0.0 && g1 < 0.0)))
+               continue;
+
+            if (locator == 0)
+            {
+               locator=new CrossingLocator(experiment, stepSize);
+               x0.resize(dimension);
+               x1.resize(dimension);
+            }
+
+            // the state before the step is the one after it minus the step
+            for (int k=0; k < dimension; k++)
+            {
+               x1[k]=states[k * stride + i];
+               x0[k]=x1[k] - steps[k * stride + i];
+            }
+
+            double display[3];
+            locator->locate(&x0[0], &x1[0], g0, g1, origin, normal, display);
+
+            ColorPoint hit;
+            hit.pos[0]=display[0];
+            hit.pos[1]=display[1];
+            hit.pos[2]=display[2];
+            hit.color=colors[i];
+            hits[thread].push_back(hit);
+         }
+
+         delete locator;
+      }
+};
+
+}
+
+//
+// PoincareSectionTool methods
+//
+
+void PoincareSectionTool::initContext(GLContextData& contextData) const
+{
+   DataItem* dataItem=new DataItem;
+   contextData.addDataItem(this, dataItem);
+
+   // a plane pierced by an orbit
+   glNewList(dataItem->displayListId, GL_COMPILE);
+
+   glPushAttrib(GL_LIGHTING_BIT | GL_LINE_BIT | GL_POINT_BIT);
+   glDisable(GL_LIGHTING);
+
+   glColor3f(0.0f, 0.6f, 1.0f);
+   glBegin(GL_LINE_LOOP);
+   glVertex3f(-0.8f, -0.5f, 0.0f);
+   glVertex3f(0.8f, -0.5f, 0.0f);
+   glVertex3f(0.8f, 0.5f, 0.0f);
+   glVertex3f(-0.8f, 0.5f, 0.0f);
+   glEnd();
+
+   glColor3f(1.0f, 1.0f, 1.0f);
+   glBegin(GL_LINE_STRIP);
+   for (int i=0; i <= 32; i++)
+   {
+      float angle=i * 2.0f * M_PI / 32;
+      glVertex3f(0.4f * std::cos(angle), 0.25f * std::sin(angle), 0.6f * std::sin(angle));
+   }
+   glEnd();
+
+   glPointSize(5.0f);
+   glColor3f(1.0f, 0.3f, 0.3f);
+   glBegin(GL_POINTS);
+   glVertex3f(0.4f, 0.0f, 0.0f);
+   glVertex3f(-0.4f, 0.0f, 0.0f);
+   glEnd();
+
+   glPopAttrib();
+
+   glEndList();
+}
+
+void PoincareSectionTool::setExperiment(DTSExperiment* e)
+{
+   Threads::Mutex::Lock lock(dataMutex);
+   experiment=e;
+
+   if (!dataInited || data.dimension != experiment->model->getDimension())
+   {
+      data.init(experiment->model->getDimension());
+      dataInited=true;
+   }
+
+   // Start with a clean slate
+   data.running=false;
+   clearHits();
+}
+
+void PoincareSectionTool::updatedExperiment()
+{
+   // the crossings of the old system do not belong to the new one
+   Threads::Mutex::Lock lock(dataMutex);
+   std::fill(data.ages.begin(), data.ages.end(), 0);
+   clearHits();
+}
+
+void PoincareSectionTool::clearPoints()
+{
+   Threads::Mutex::Lock lock(dataMutex);
+   clearHits();
+}
+
+void PoincareSectionTool::clearHits()
+{
+   {
+      Threads::Mutex::Lock lock(data.pendingMutex);
+      data.pendingHits.clear();
+   }
+   data.hits.clear();
+   data.hitsVersion++;
+   data.totalHits=0;
+}
+
+void PoincareSectionTool::setNumberOfSeeds(unsigned int num)
+{
+   Threads::Mutex::Lock lock(dataMutex);
+   data.numSeeds=num;
+   data.running=false;
+   if (dataInited)
+   {
+      data.init(data.dimension);
+   }
+}
+
+void PoincareSectionTool::step()
+{
+   if (!data.running || data.numSeeds == 0)
+      return;
+
+   // at most the tool's share of the application's threads
+   DTS::ThreadPool& pool=threadPool();
+   int numThreads=std::min(data.numThreads, pool.getNumThreads());
+   data.workspaces.resize(numThreads);
+   data.threadHits.resize(numThreads);
+   for (int t=0; t < numThreads; t++)
+   {
+      data.threadHits[t].clear();
+   }
+
+   StepTask task;
+   task.experiment=experiment;
+   task.dimension=data.dimension;
+   task.stride=data.numSeeds;
+   task.stepSize=experiment->integrator->getRealParamIndex("stepSize") >= 0
+         ? experiment->integrator->getRealParamValue("stepSize") : 0.0;
+   task.states=&data.states[0];
+   task.steps=&data.steps[0];
+   task.displays=&data.displays[0];
+   task.sides=&data.sides[0];
+   task.ages=&data.ages[0];
+   task.colors=&data.colors[0];
+   task.transient=data.transient;
+   task.bothDirections=data.bothDirections;
+   task.origin=data.origin;
+   task.normal=data.normal;
+   task.workspaces=&data.workspaces[0];
+   task.hits=&data.threadHits[0];
+
+   // split the seeds across cores if the integrator allows it
+   if (experiment->integrator->isReentrant())
+   {
+      pool.parallelFor(data.numSeeds, 1024, task, numThreads);
+   }
+   else
+   {
+      task.run(0, data.numSeeds, 0);
+   }
+
+   // hand the crossings to the application thread
+   Threads::Mutex::Lock lock(data.pendingMutex);
+   for (int t=0; t < numThreads; t++)
+   {
+      const PoincareSectionData::HitArray& hits=data.threadHits[t];
+      data.pendingHits.insert(data.pendingHits.end(), hits.begin(), hits.end());
+      data.totalHits+=hits.size();
+   }
+
+   if (data.totalHits >= MaxHits)
+   {
+      master::filter(std::cout)() << "PoincareSection::stopped after " << data.totalHits
+            << " crossings" << std::endl;
+      data.running=false;
+   }
+}
+
+void PoincareSectionTool::frame()
+{
+   Threads::Mutex::Lock lock(data.pendingMutex);
+   data.hits.insert(data.hits.end(), data.pendingHits.begin(), data.pendingHits.end());
+   data.pendingHits.clear();
+}
+
+void PoincareSectionTool::moved(const ToolBox::MotionEvent & motionEvent)
+{
+   if (experiment == NULL || locked || !active)
+   {
+      return;
+   }
+
+   placePlaneAtLocator();
+}
+
+void PoincareSectionTool::mainButtonPressed(const ToolBox::ButtonPressEvent & buttonPressEvent)
+{
+   if (experiment == NULL || locked)
+   {
+      return;
+   }
+
+   // pause the seeds while the plane moves, their crossings would not lie on it
+   {
+      Threads::Mutex::Lock lock(dataMutex);
+      data.running=false;
+      clearHits();
+   }
+
+   active=true;
+   placePlaneAtLocator();
+}
+
+void PoincareSectionTool::mainButtonReleased(const ToolBox::ButtonReleaseEvent & buttonReleaseEvent)
+{
+   if (experiment == NULL || locked || !active)
+   {
+      return;
+   }
+
+   active=false;
+   releaseSeeds(experiment->transformer->getRadius());
+}
+
+void PoincareSectionTool::placePlaneAtLocator()
+{
+   const Vrui::NavTrackerState& transformation=toolBox()->deviceTransformationInModel();
+
+   // the plane faces the direction the wand points in
+   setPlane(transformation.getOrigin(), transformation.transform(Vrui::Vector(0, 1, 0)));
+}
+
+void PoincareSectionTool::setPlane(const Vrui::Point& pos, const Vrui::Vector& direction)
+{
+   double length=std::sqrt(direction[0] * direction[0] + direction[1] * direction[1]
+         + direction[2] * direction[2]);
+   if (length == 0.0)
+   {
+      return;
+   }
+
+   Threads::Mutex::Lock lock(dataMutex);
+   for (int k=0; k < 3; k++)
+   {
+      data.origin[k]=pos[k];
+      data.normal[k]=direction[k] / length;
+   }
+}
+
+void PoincareSectionTool::releaseSeeds(Vrui::Scalar radius)
+{
+   Threads::Mutex::Lock lock(dataMutex);
+
+   master::filter(std::cout)() << "PoincareSection::releasing " << data.numSeeds << " seeds... "
+         << std::endl;
+
+   double u[3], v[3];
+   planeAxes(data.normal, u, v);
+
+   double display[3];
+   std::vector<double> state(data.dimension);
+
+   // spread the seeds uniformly over a disk on the plane
+   DTS::Random random(randomSeed, data.releases++);
+   for (int i=0; i < data.numSeeds; i++)
+   {
+      double w[4];
+      random.uniform(i, 0, w);
+
+      double r=radius * std::sqrt(w[0]);
+      double theta=w[1] * 2.0 * M_PI;
+      double a=r * std::cos(theta);
+      double b=r * std::sin(theta);
+
+      for (int k=0; k < 3; k++)
+      {
+         display[k]=data.origin[k] + a * u[k] + b * v[k];
+      }
+      experiment->invTransformState(display, &state[0]);
+      for (int k=0; k < data.dimension; k++)
+      {
+         data.states[k * data.numSeeds + i]=state[k];
+      }
+
+      // the seeds start on the plane
+      data.sides[i]=0.0;
+      data.ages[i]=0;
+
+      // color by position on the disk
+      data.colors[i][0]=(unsigned int) ((0.5 + 0.5 * a / radius) * 255.0);
+      data.colors[i][1]=(unsigned int) ((0.5 + 0.5 * b / radius) * 255.0);
+      data.colors[i][2]=(unsigned int) ((1.0 - r / radius) * 255.0);
+      data.colors[i][3]=255;
+   }
+
+   data.running=true;
+}
+
+void PoincareSectionTool::render(DTS::DataItem* dataItem) const
+{
+   if (experiment == NULL)
+   {
+      return;
+   }
+
+   glPushAttrib(GL_LIGHTING_BIT | GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT | GL_POINT_BIT);
+   glDisable(GL_LIGHTING);
+
+   // the plane, as a translucent square the size of the attractor
+   if (active || data.running || !data.hits.empty())
+   {
+      double u[3], v[3];
+      planeAxes(data.normal, u, v);
+      double size=experiment->transformer->getRadius();
+
+      double corners[4][3];
+      for (int k=0; k < 3; k++)
+      {
+         corners[0][k]=data.origin[k] - size * u[k] - size * v[k];
+         corners[1][k]=data.origin[k] + size * u[k] - size * v[k];
+         corners[2][k]=data.origin[k] + size * u[k] + size * v[k];
+         corners[3][k]=data.origin[k] - size * u[k] + size * v[k];
+      }
+
+      glDepthMask(GL_FALSE);
+      glEnable(GL_BLEND);
+      glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+      glColor4f(0.0f, 0.6f, 1.0f, 0.15f);
+      glBegin(GL_QUADS);
+      for (int c=0; c < 4; c++)
+         glVertex3dv(corners[c]);
+      glEnd();
+      glDisable(GL_BLEND);
+      glDepthMask(GL_TRUE);
+
+      glColor4f(0.0f, 0.8f, 1.0f, 1.0f);
+      glBegin(GL_LINE_LOOP);
+      for (int c=0; c < 4; c++)
+         glVertex3dv(corners[c]);
+      glEnd();
+   }
+
+   size_t count=data.hits.size();
+   if (count > 0)
+   {
+      glPointSize(pointSize);
+      glEnableClientState(GL_VERTEX_ARRAY);
+      glEnableClientState(GL_COLOR_ARRAY);
+
+      if (dataItem->hasVertexBufferObjectExtension)
+      {
+         glBindBufferARB(GL_ARRAY_BUFFER_ARB, dataItem->poincareBufferId);
+
+         if (dataItem->poincareBufferVersion != data.hitsVersion)
+         {
+            dataItem->poincareUploadedPoints=0;
+            dataItem->poincareBufferVersion=data.hitsVersion;
+         }
+
+         // grow the buffer geometrically, the points in it are uploaded again
+         if (count > dataItem->poincareBufferCapacity)
+         {
+            size_t capacity=std::max<size_t>(2 * dataItem->poincareBufferCapacity, 65536);
+            while (capacity < count)
+               capacity*=2;
+
+            glBufferDataARB(GL_ARRAY_BUFFER_ARB, capacity * sizeof(ColorPoint), NULL,
+                  GL_DYNAMIC_DRAW_ARB);
+            dataItem->poincareBufferCapacity=capacity;
+            dataItem->poincareUploadedPoints=0;
+         }
+
+         // only the crossings found since the last frame are sent
+         size_t uploaded=dataItem->poincareUploadedPoints;
+         if (uploaded < count)
+         {
+            glBufferSubDataARB(GL_ARRAY_BUFFER_ARB, uploaded * sizeof(ColorPoint),
+                  (count - uploaded) * sizeof(ColorPoint), &data.hits[uploaded]);
+            DTS::Counters::add(DTS::Counters::UPLOAD_BYTES, (count - uploaded) * sizeof(ColorPoint));
+            dataItem->poincareUploadedPoints=count;
+         }
+
+         glInterleavedArrays(GL_C4UB_V3F, sizeof(ColorPoint), 0);
+         glDrawArrays(GL_POINTS, 0, count);
+
+         glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+      }
+      else
+      {
+         glInterleavedArrays(GL_C4UB_V3F, sizeof(ColorPoint), &data.hits[0]);
+         glDrawArrays(GL_POINTS, 0, count);
+      }
+
+      glDisableClientState(GL_COLOR_ARRAY);
+      glDisableClientState(GL_VERTEX_ARRAY);
+   }
+
+   glPopAttrib();
+}
@@ -0,0 +1,266 @@
+/*******************************************************************************
+ PoincareSectionTool: Collects the crossings of trajectories through a plane.
+
+ This file is part of the Dynamics Toolset.
+
+ The Dynamics Toolset is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by the Free
+ Software Foundation, either version 3 of the License, or (at your option) any
+ later version.
+
+ The Dynamics Toolset is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ details.
+
+ You should have received a copy of the GNU General Public License
+ along with the Dynamics Toolset. If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#ifndef POINCARE_SECTION_TOOL_H
+#define POINCARE_SECTION_TOOL_H
+
+// STL includes
+//
+#include <algorithm>
+#include <vector>
+
+// Vrui includes
+//
+#include <Threads/Mutex.h>
+
+// Project includes
+//
+#include "FieldViewer.h"
+#include "DataItem.h"
+#include "ColorPoint.h"
+#include "AbstractDynamicsTool.h"
+#include "Dynamics/ThreadPool.h"
+
+#include "PoincareSectionOptionsDialog.h"
+
+// Forward declarations
+class PoincareSectionTool;
+
+/** Data storage for PoincareSectionTool.
+ *
+ * The seeds are kept as structure-of-arrays like the particles of the
+ * DotSpreaderTool. Of their trajectories only the last state is kept; the
+ * crossings found by step() are the only data that grows.
+ */
+class PoincareSectionData
+{
+      friend class PoincareSectionTool;
+
+   public:
+      /// Seed states as structure-of-arrays: component k of seed i is at
+      /// states[k * numSeeds + i].
+      typedef std::vector<double> StateArray;
+      typedef std::vector<ColorPoint> HitArray;
+
+   private:
+      StateArray states;
+      StateArray steps; ///< Step vectors, same layout as states.
+      std::vector<double> displays; ///< Display coordinates, xyz per seed.
+      std::vector<double> sides; ///< Signed distance of each seed from the plane.
+      std::vector<unsigned int> ages; ///< Steps taken by each seed.
+      std::vector<GLColor<GLubyte, 4> > colors; ///< Color of the hits of each seed.
+
+      bool running;
+      size_t totalHits; ///< Crossings found since the points were last cleared.
+      int numSeeds;
+      int dimension;
+      unsigned int releases; ///< Seed releases, keys their random positions.
+      unsigned int transient; ///< Steps of a seed before its crossings count.
+      bool bothDirections; ///< Count crossings against the normal too.
+
+      double origin[3]; ///< Point on the plane, in display coordinates.
+      double normal[3]; ///< Unit normal of the plane.
+
+      int numThreads; ///< Most threads of the application's pool that step() uses.
+      std::vector<Integrator<Scalar>::Workspace> workspaces; ///< One per pool thread.
+      std::vector<HitArray> threadHits; ///< Crossings found by each pool thread in one step.
+
+      /// Crossings found by step() and not yet picked up by frame().
+      HitArray pendingHits;
+      Threads::Mutex pendingMutex;
+
+      /// All crossings, owned by the application thread and drawn by render().
+      HitArray hits;
+      unsigned int hitsVersion; ///< Incremented whenever hits is cleared.
+
+      PoincareSectionData() :
+         running(false), totalHits(0), numSeeds(10000), dimension(0), releases(0), transient(500),
+               bothDirections(false), numThreads(DTS::ThreadPool::getNumProcessors()),
+               hitsVersion(0)
+      {
+         origin[0]=origin[1]=origin[2]=0.0;
+         normal[0]=normal[2]=0.0;
+         normal[1]=1.0;
+      }
+
+      void init(int dimension)
+      {
+         this->dimension=dimension;
+         states.assign(numSeeds * dimension, 0.0);
+         steps.resize(numSeeds * dimension);
+         displays.resize(numSeeds * 3);
+         sides.resize(numSeeds);
+         ages.resize(numSeeds);
+         colors.resize(numSeeds);
+      }
+};
+
+/** Collects the Poincare section of a plane placed with the wand.
+ *
+ * Pressing the main button places the plane through the wand position,
+ * facing the direction the wand points; while the button is held the plane
+ * follows the wand. Releasing the button spreads seeds over a disk on the
+ * plane the size of the attractor and starts integrating them in parallel.
+ *
+ * After every step the signed distance of each seed from the plane is
+ * compared with the one before. When it changes sign in the direction of
+ * the normal (or either direction, see setBothDirections) the crossing is
+ * located within the step: the trajectory over the step is the cubic
+ * Hermite interpolant of the states and derivatives at both ends, and the
+ * point where it meets the plane is found by regula falsi. Only the
+ * crossings are kept, so memory grows with the number of hits and not with
+ * the length of the trajectories, and the hits are appended to a vertex
+ * buffer that grows geometrically, uploading only the new points each frame.
+ */
+class PoincareSectionTool: public AbstractDynamicsTool, public GLObject
+{
+   public:
+
+      /* Embedded classes */
+
+      class Icon: public ToolBox::Icon
+      {
+         public:
+            Icon(const PoincareSectionTool* pTool) :
+               parent(pTool)
+            {
+            }
+            void display(GLContextData& contextData) const;
+            const PoincareSectionTool* parent;
+      };
+
+      class DataItem: public GLObject::DataItem
+      {
+         public:
+            DataItem();
+            virtual ~DataItem();
+
+            GLuint displayListId;
+      };
+
+      friend class Icon;
+      friend class DataItem;
+
+      /// Crossings kept at most, about 64 MB.
+      static const size_t MaxHits;
+
+   public:
+
+      /* Interface */
+
+      PoincareSectionTool(ToolBox::ToolBox* toolBox, Viewer* app) :
+         AbstractDynamicsTool(toolBox, app), dataInited(false), active(false),
+               pointSize(2.0f)
+      {
+         icon(new Icon(this));
+
+         // Set member from parent class
+         _needsGLSL=false;
+      }
+
+      virtual ~PoincareSectionTool()
+      {
+      }
+
+      virtual void setExperiment(DTSExperiment* e);
+      virtual void updatedExperiment();
+
+      void initContext(GLContextData& contextData) const;
+
+      virtual void moved(const ToolBox::MotionEvent & motionEvent);
+      virtual void mainButtonPressed(const ToolBox::ButtonPressEvent & buttonPressEvent);
+      virtual void mainButtonReleased(const ToolBox::ButtonReleaseEvent & buttonReleaseEvent);
+      virtual void otherButtonPressed(const ToolBox::ButtonPressEvent & buttonPressEvent)
+      {
+      }
+      virtual void otherButtonReleased(const ToolBox::ButtonReleaseEvent & buttonReleaseEvent)
+      {
+      }
+
+      virtual void render(DTS::DataItem* dataItem) const;
+      virtual void step();
+      virtual void frame();
+
+      virtual bool stepsAsynchronously() const
+      {
+         return true;
+      }
+
+      virtual CaveDialog* createOptionsDialog(GLMotif::PopupMenu *parent)
+      {
+         dialog=new PoincareSectionOptionsDialog(parent, this);
+         return dialog;
+      }
+
+      /* New methods */
+
+      /** Removes the collected crossings, the seeds keep running.
+       */
+      void clearPoints();
+
+      void setNumberOfSeeds(unsigned int num);
+
+      void setTransient(unsigned int steps)
+      {
+         Threads::Mutex::Lock lock(dataMutex);
+         data.transient=steps;
+      }
+
+      void setBothDirections(bool flag)
+      {
+         Threads::Mutex::Lock lock(dataMutex);
+         data.bothDirections=flag;
+      }
+
+      void setPointSize(float value)
+      {
+         pointSize=value;
+      }
+
+      void setNumberOfThreads(int num)
+      {
+         Threads::Mutex::Lock lock(dataMutex);
+         data.numThreads=std::max(num, 1);
+      }
+
+      int getNumberOfThreads() const
+      {
+         return data.numThreads;
+      }
+
+      /** Places the plane through 'pos' with normal 'direction', in display
+       * coordinates.
+       */
+      void setPlane(const Vrui::Point& pos, const Vrui::Vector& direction);
+
+      /** Spreads the seeds over a disk of 'radius' on the plane.
+       */
+      void releaseSeeds(Vrui::Scalar radius);
+
+   private:
+      PoincareSectionData data;
+      bool dataInited;
+
+      bool active; ///< The main button is held and the plane follows the wand.
+      float pointSize; ///< In pixels.
+
+      void clearHits();
+      void placePlaneAtLocator();
+};
+
+#endif
@@ -22,6 +22,7 @@
 #include "GLMotif/WidgetFactory.h"
 
 #include "StaticSolverTool.h"
+#include "Dynamics/Trace.h"
 
 GLMotif::PopupWindow* StaticSolverOptionsDialog::createDialog()
 {
@@ -80,6 +81,24 @@ GLMotif::PopupWindow* StaticSolverOptionsDialog::createDialog()
    colorToggles.push_back(solidColorToggle);
    colorToggles.push_back(gradientColorToggle);
 
+   // create integration method toggle buttons (check boxes)
+   factory.createLabel("", "Integrator");
+   GLMotif::ToggleButton* adaptiveToggle=factory.createCheckBox("AdaptiveToggle", "Adaptive", true);
+   GLMotif::ToggleButton* multistepToggle=factory.createCheckBox("MultistepToggle", "Multistep");
+   factory.createLabel("", "");
+   GLMotif::ToggleButton* steppedToggle=factory.createCheckBox("SteppedToggle", "Experiment");
+   factory.createLabel("Spacer3", "");
+
+   // assign integration method toggle callbacks
+   adaptiveToggle->getValueChangedCallbacks().add(this, &StaticSolverOptionsDialog::integrationMethodTogglesCallback);
+   multistepToggle->getValueChangedCallbacks().add(this, &StaticSolverOptionsDialog::integrationMethodTogglesCallback);
+   steppedToggle->getValueChangedCallbacks().add(this, &StaticSolverOptionsDialog::integrationMethodTogglesCallback);
+
+   // add integration method toggles to array for radio-button behavior
+   integrationToggles.push_back(adaptiveToggle);
+   integrationToggles.push_back(multistepToggle);
+   integrationToggles.push_back(steppedToggle);
+
    // Multiple static solutions
    factory.createLabel("", "Behavior");
    GLMotif::ToggleButton* multipleStaticSolutionsToggle=factory.createCheckBox("MultipleStaticSolutionsToggle", "Allow Multiple Static Solutions", pTool->multipleStaticSolutions);
@@ -107,6 +126,8 @@ GLMotif::PopupWindow* StaticSolverOptionsDialog::createDialog()
 
 void StaticSolverOptionsDialog::sliderCallback(GLMotif::Slider::ValueChangedCallbackData* cbData)
 {
+   DTS_TRACE_SCOPE("StaticSolverOptionsDialog::sliderCallback");
+
    // get slider value
    unsigned int value=(unsigned int) cbData->value;
 
@@ -123,6 +144,8 @@ void StaticSolverOptionsDialog::sliderCallback(GLMotif::Slider::ValueChangedCall
 
 void StaticSolverOptionsDialog::lineStyleTogglesCallback(GLMotif::ToggleButton::ValueChangedCallbackData* cbData)
 {
+   DTS_TRACE_SCOPE("StaticSolverOptionsDialog::lineStyleTogglesCallback");
+
    // set the line style value
 
    std::string name=cbData->toggle->getName();
@@ -150,6 +173,8 @@ void StaticSolverOptionsDialog::lineStyleTogglesCallback(GLMotif::ToggleButton::
 
 void StaticSolverOptionsDialog::colorStyleTogglesCallback(GLMotif::ToggleButton::ValueChangedCallbackData* cbData)
 {
+   DTS_TRACE_SCOPE("StaticSolverOptionsDialog::colorStyleTogglesCallback");
+
    // set the line color value
 
    std::string name=cbData->toggle->getName();
@@ -177,14 +202,51 @@ void StaticSolverOptionsDialog::colorStyleTogglesCallback(GLMotif::ToggleButton:
          (*button)->setToggle(true);
 }
 
+void StaticSolverOptionsDialog::integrationMethodTogglesCallback(GLMotif::ToggleButton::ValueChangedCallbackData* cbData)
+{
+   DTS_TRACE_SCOPE("StaticSolverOptionsDialog::integrationMethodTogglesCallback");
+
+   // set the integration method
+
+   std::string name=cbData->toggle->getName();
+
+   StaticSolverTool* pTool=static_cast<StaticSolverTool*> (tool);
+
+   if (name == "AdaptiveToggle")
+   {
+      pTool->setIntegrationMethod(StaticSolverData::ADAPTIVE);
+   }
+   else if (name == "MultistepToggle")
+   {
+      pTool->setIntegrationMethod(StaticSolverData::MULTISTEP);
+   }
+   else if (name == "SteppedToggle")
+   {
+      pTool->setIntegrationMethod(StaticSolverData::STEPPED);
+   }
+
+   // fake radio-button behavior
+   for (ToggleArray::iterator button=integrationToggles.begin(); button
+         != integrationToggles.end(); ++button)
+      if (strcmp((*button)->getName(), name.c_str()) != 0
+            and (*button)->getToggle())
+         (*button)->setToggle(false);
+      else if (strcmp((*button)->getName(), name.c_str()) == 0)
+         (*button)->setToggle(true);
+}
+
 void StaticSolverOptionsDialog::multipleStaticSolutionsToggleCallback(GLMotif::ToggleButton::ValueChangedCallbackData* cbData)
 {
+   DTS_TRACE_SCOPE("StaticSolverOptionsDialog::multipleStaticSolutionsToggleCallback");
+
    StaticSolverTool* pTool=static_cast<StaticSolverTool*> (tool);
    pTool->multipleStaticSolutions = not pTool->multipleStaticSolutions;
 }
 
 void StaticSolverOptionsDialog::clearButtonCallback(GLMotif::Button::SelectCallbackData* cbData)
 {
+   DTS_TRACE_SCOPE("StaticSolverOptionsDialog::clearButtonCallback");
+
    StaticSolverTool* pTool=static_cast<StaticSolverTool*> (tool);
    pTool->clearDatasets();
    pTool->requestDataDisplayListUpdate();
@@ -39,11 +39,13 @@ class StaticSolverOptionsDialog: public CaveDialog
       void sliderCallback(GLMotif::Slider::ValueChangedCallbackData* cbData);
       void lineStyleTogglesCallback(GLMotif::ToggleButton::ValueChangedCallbackData* cbData);
       void colorStyleTogglesCallback(GLMotif::ToggleButton::ValueChangedCallbackData* cbData);
+      void integrationMethodTogglesCallback(GLMotif::ToggleButton::ValueChangedCallbackData* cbData);
       void multipleStaticSolutionsToggleCallback(GLMotif::ToggleButton::ValueChangedCallbackData* cbData);
       void clearButtonCallback(GLMotif::Button::SelectCallbackData* cbData);
 
       ToggleArray lineToggles;
       ToggleArray colorToggles;
+      ToggleArray integrationToggles;
 
    protected:
       GLMotif::PopupWindow* createDialog();
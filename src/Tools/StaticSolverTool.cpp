@@ -28,18 +28,35 @@
 //
 #include <Geometry/Point.h>
 #include <GL/GLPolylineTube.h>
+#include <Misc/Timer.h>
 
 // OpenGL includes
 //
 #include <GL/glu.h>
 #include <GL/gle.h>
 
+// Project includes
+//
+#include "Dynamics/Counters.h"
+#include "Dynamics/DormandPrince45.h"
+#include "PolylineSimplifier.h"
+
 //
 // StaticSolverData initialization
 //
 
 const unsigned int StaticSolverData::MaxPoints=20000;
 
+//
+// StaticSolverTool initialization
+//
+
+const unsigned int StaticSolverTool::ChunkSize=512;
+const unsigned int StaticSolverTool::InitialPoints=4 * StaticSolverTool::ChunkSize;
+const double StaticSolverTool::RefinementBudget=0.004;
+const double StaticSolverTool::TubeRadius=0.1;
+const double StaticSolverTool::LineTolerance=0.05 * StaticSolverTool::TubeRadius;
+
 //
 // StaticSolverTool::Icon methods
 //
@@ -59,7 +76,19 @@ StaticSolverTool::StaticSolverTool(ToolBox::ToolBox* toolBox, Viewer* app) :
          multipleStaticSolutions(false),
          numberOfPoints(5000),
          lineStyle(StaticSolverData::POLY_LINE),
-         colorStyle(StaticSolverData::SOLID)
+         colorStyle(StaticSolverData::SOLID),
+         integrationMethod(StaticSolverData::ADAPTIVE),
+         solvedIntegrator(NULL),
+         solvedModelVersion(0),
+         solvedIntegratorVersion(0),
+         stagingExperiment(NULL),
+         workerExperiment(NULL),
+         generation(0),
+         jobDue(false),
+         jobRunning(false),
+         jobFinished(false),
+         workerRunning(false),
+         tubeVersion(0)
       {
          icon(new Icon(this));
 
@@ -69,7 +98,13 @@ StaticSolverTool::StaticSolverTool(ToolBox::ToolBox* toolBox, Viewer* app) :
 
 StaticSolverTool::~StaticSolverTool()
 {
+   stopWorker();
    clearDatasets();
+
+   for (unsigned int i=0; i < tubes.size(); i++)
+   {
+      delete tubes[i];
+   }
 }
 
 void StaticSolverTool::initContext(GLContextData& contextData) const
@@ -139,24 +174,42 @@ void StaticSolverTool::render(DTS::DataItem* dataItem) const
    }
    glCallList(dataItem->dataDisplayListId);
 
+   drawTubes(dataItem);
+   drawPartialLines(dataItem);
 }
 
 void StaticSolverTool::setExperiment(DTSExperiment* e)
 {
+   stopWorker();
+
    experiment = e;
    clearDatasets();
+
+   // the cached trajectories belong to the integrators of the old experiment
+   cache.clear();
+   solvedIntegrator = NULL;
+
+   if (experiment != NULL)
+   {
+      startWorker();
+   }
+
    requestDataDisplayListUpdate();
 }
 
 void StaticSolverTool::updatedExperiment()
 {
-   // recompute all static solutions
-   std::vector<StaticSolverData*>::iterator it;
-   for (it = datasets.begin(); it != datasets.end(); it++)
+   // The points are stored in model coordinates, so if only the transformer
+   // changed they just have to be projected again by the display list.
+   if (experiment->integrator == solvedIntegrator
+         && experiment->model->getVersion() == solvedModelVersion
+         && experiment->integrator->getVersion() == solvedIntegratorVersion)
    {
-      computeStaticSolution(*it);
+      requestDataDisplayListUpdate();
+      return;
    }
-   requestDataDisplayListUpdate();
+
+   requestRecompute();
 }
 
 
@@ -164,6 +217,54 @@ void StaticSolverTool::step()
 {
 }
 
+void StaticSolverTool::frame()
+{
+   // pick up the trajectories of a finished recomputation
+   StaticSolverJob job;
+   bool current=false;
+   {
+      Threads::Mutex::Lock lock(jobMutex);
+      if (jobFinished)
+      {
+         job.swap(finishedJob);
+         jobFinished=false;
+         current=job.generation == generation;
+      }
+   }
+
+   // a job finished before the parameters changed again only goes into
+   // the cache; its datasets show other parameters by now
+   if (!current)
+   {
+      for (unsigned int i=0; i < job.keys.size(); i++)
+      {
+         cache.insert(job.keys[i], job.points[i], job.points[i].size());
+      }
+      job.clear();
+   }
+
+   for (unsigned int i=0; i < job.datasets.size(); i++)
+   {
+      StaticSolverData* data=job.datasets[i];
+      data->points.swap(job.points[i]);
+      data->computedPoints=data->numberOfPoints;
+      data->refining=false;
+      data->history=AdamsBashforthMoulton4::History();
+      cache.insert(job.keys[i], data->points, data->numberOfPoints);
+   }
+   if (!job.datasets.empty())
+   {
+      requestDataDisplayListUpdate();
+   }
+
+   refineStaticSolutions();
+
+   if (tubeVersion != dataDisplayListVersion)
+   {
+      updateTubes();
+   }
+}
+
 void StaticSolverTool::moved(const ToolBox::MotionEvent & motionEvent)
 {
 }
@@ -201,7 +302,7 @@ void StaticSolverTool::addStaticSolution(DTS::Vector<double> position)
    newData->colorStyle = colorStyle;
    newData->lineStyle = lineStyle;
    newData->setNumberOfPoints(numberOfPoints, experiment->model->getDimension());
-   computeStaticSolution(newData);
+   solveStaticSolution(newData);
 
    if (not multipleStaticSolutions)
    {
@@ -216,24 +317,52 @@ void StaticSolverTool::addStaticSolution(DTS::Vector<double> position)
 // StaticSolverTool internal methods
 //
 
+/** Transforms all points of a trajectory with one call.
+ *
+ * \param displays Gets 3 display coordinates per point.
+ */
+void StaticSolverTool::transformPoints(const StaticSolverData* d, std::vector<double>& states,
+      std::vector<double>& displays) const
+{
+   const int dimension=experiment->model->getDimension();
+   const unsigned int n=d->numberOfPoints;
+
+   states.resize(size_t(n) * dimension);
+   displays.resize(3 * size_t(n));
+   for (unsigned int j=0; j < n; j++)
+   {
+      for (int k=0; k < dimension; k++)
+      {
+         states[k * n + j]=d->points[j][k];
+      }
+   }
+   experiment->transformer->transformBatch(&states[0], &displays[0], n, n);
+}
+
 void StaticSolverTool::drawBasicLine(StaticSolverData* d) const
 {
+   const unsigned int n=d->numberOfPoints;
+
+   // only the points needed to draw the line within LineTolerance
+   std::vector<double> states;
+   std::vector<double> displays;
+   std::vector<unsigned int> kept;
+   transformPoints(d, states, displays);
+   PolylineSimplifier(LineTolerance).simplify(&displays[0], n, kept);
+
    // save the current attribute state
    glPushAttrib(GL_LIGHTING_BIT);
 
    glDisable(GL_LIGHTING);
 
-   DTS::Vector<double> tmp(3);
-
    if (datasets[0]->colorStyle == StaticSolverData::SOLID)
    {
       glColor3f(1.0f, 0.5f, 0.0f);
 
       glBegin(GL_LINE_STRIP);
-      for (unsigned int i=0; i < datasets[0]->numberOfPoints; i++)
+      for (unsigned int m=0; m < kept.size(); m++)
       {
-         experiment->transformer->transform(d->points[i], tmp);
-         glVertex3f(tmp[0], tmp[1], tmp[2]);
+         glVertex3dv(&displays[3 * kept[m]]);
       }
       glEnd();
 
@@ -241,18 +370,16 @@ void StaticSolverTool::drawBasicLine(StaticSolverData* d) const
    else if (datasets[0]->colorStyle == StaticSolverData::GRADIENT)
    {
       glBegin(GL_LINES);
-      for (unsigned int i=1; i < datasets[0]->numberOfPoints; i++)
+      for (unsigned int m=1; m < kept.size(); m++)
       {
-         const unsigned int index=(int) ((float) i / (float) datasets[0]->numberOfPoints
-               * 255.0);
+         // the color of the original point ending the segment
+         const unsigned int index=(int) ((float) kept[m] / (float) n * 255.0);
 
          const float* color=datasets[0]->colorMap->getColor(index);
          glColor3fv(color);
 
-         experiment->transformer->transform(d->points[i-1], tmp);
-         glVertex3f(tmp[0], tmp[1], tmp[2]);
-         experiment->transformer->transform(d->points[i], tmp);
-         glVertex3f(tmp[0], tmp[1], tmp[2]);
+         glVertex3dv(&displays[3 * kept[m-1]]);
+         glVertex3dv(&displays[3 * kept[m]]);
       }
       glEnd();
 
@@ -262,135 +389,367 @@ void StaticSolverTool::drawBasicLine(StaticSolverData* d) const
    glPopAttrib();
 }
 
-void StaticSolverTool::drawPolyLine(StaticSolverData* d) const
+/* Private methods */
+
+/** The integrator for an integration method.
+ *
+ * The adaptive integrator takes long steps and fills in the evenly spaced
+ * points with its interpolant, the multistep integrator needs two model
+ * evaluations per point. Both are much cheaper than a Runge-Kutta step per
+ * point. They take the spacing of the points from the current integrator.
+ */
+Integrator<double>* StaticSolverTool::getSolutionIntegrator(DTSExperiment* e,
+      StaticSolverData::IntegrationMethod integrationMethod)
 {
-   unsigned int numPoints = datasets[0]->numberOfPoints;
+   Integrator<double>* integrator=e->integrator;
+   Integrator<double>* method=NULL;
+   if (integrationMethod == StaticSolverData::ADAPTIVE)
+   {
+      method=e->getIntegrator("dopri5");
+   }
+   else if (integrationMethod == StaticSolverData::MULTISTEP)
+   {
+      method=e->getIntegrator("abm4");
+   }
+   if (method != NULL && method != integrator)
+   {
+      // copying bumps the version, which would restart multistep histories
+      if (method->getRealParamValue("stepSize") != integrator->getRealParamValue("stepSize"))
+      {
+         method->copyParamValues(*integrator);
+      }
+      integrator=method;
+   }
 
-   // save the current attribute state
-   glPushAttrib(GL_LIGHTING_BIT);
+   return integrator;
+}
 
-   // allocate memory for gle rendering methods
-   // first and last points set the angle, not position: add 2 extra points
-   gleDouble points[numPoints + 2][3];
-   float colors[numPoints + 2][3];
-   gleDouble radius=0.1; // radius of poly-cylinder
+/** Fills points [first, last) following points[first-1].
+ *
+ * The points are computed in chunks of ChunkSize; if 'generation' is given,
+ * the computation stops between chunks once it no longer equals
+ * 'jobGeneration'.
+ *
+ * \return false if the computation was cancelled.
+ */
+bool StaticSolverTool::integrate(DTSExperiment* e,
+      StaticSolverData::IntegrationMethod integrationMethod,
+      std::vector<DTS::Vector<double> >& points, AdamsBashforthMoulton4::History& history,
+      unsigned int first, unsigned int last, const volatile unsigned int* generation,
+      unsigned int jobGeneration)
+{
+   Integrator<double>* integrator=getSolutionIntegrator(e, integrationMethod);
+   DormandPrince45* dense=dynamic_cast<DormandPrince45*> (integrator);
+   AdamsBashforthMoulton4* multistep=dynamic_cast<AdamsBashforthMoulton4*> (integrator);
 
-   DTS::Vector<double> tmp(experiment->model->getDimension());
+   int dimension=e->model->getDimension();
+   DTS::Vector<double> tmp(dimension);
 
-   if (datasets[0]->colorStyle == StaticSolverData::SOLID)
+   // The current integrator, through the fused stepper if the experiment has one
+   DTSExperiment::Stepper& stepper=e->getStepper();
+   std::vector<double> state(dimension);
+   for (int c=0; c < dimension; c++)
    {
-      glEnable(GL_LIGHTING);
+      state[c]=points[first-1][c];
+   }
 
-      GLMaterial
-            material(GLMaterial::Color(1.0, 0.5, 0.0, 1.0), GLMaterial::Color(1.0, 1.0, 1.0, 1.0), 80.0);
+   // Chunks start at fixed indices, so that the adaptive integrator restarts
+   // at the same points however the trajectory is split into calls.
+   unsigned int chunkEnd;
+   for (unsigned int chunk=first; chunk < last; chunk=chunkEnd)
+   {
+      if (generation != NULL && *generation != jobGeneration)
+      {
+         return false;
+      }
 
-      glMaterial(GLMaterialEnums::FRONT_AND_BACK, material);
+      chunkEnd=std::min(((chunk - 1) / ChunkSize + 1) * ChunkSize + 1, last);
 
-      /*
-      float xmin = 0;
-      float xmax = 0;
-      float ymin = 0;
-      float ymax = 0;
-      float zmin = 0;
-      float zmax = 0;
-      */
-      for (unsigned int i=0; i < numPoints; i++)
+      if (dense != NULL)
+      {
+         // each chunk starts the step size control over from its first point
+         dense->integrate(points.begin() + (chunk - 1), points.begin() + chunkEnd);
+      }
+      else if (multistep != NULL)
+      {
+         for (unsigned int i=chunk; i < chunkEnd; i++)
+         {
+            points[i] = points[i-1];
+            multistep->step(history, points[i-1], tmp);
+            points[i] += tmp;
+         }
+      }
+      else
       {
-         experiment->transformer->transform(d->points[i], tmp);
-
-         points[i+1][0]=tmp[0];
-         points[i+1][1]=tmp[1];
-         points[i+1][2]=tmp[2];
-         /*
-          if (points[i][0] > xmax) xmax = points[i][0];
-          if (points[i][0] < xmin) xmin = points[i][0];
-          if (points[i][0] > ymax) ymax = points[i][1];
-          if (points[i][0] < ymin) ymin = points[i][1];
-          if (points[i][0] > zmax) zmax = points[i][2];
-          if (points[i][0] < zmin) zmin = points[i][2];
-         */
+         for (unsigned int i=chunk; i < chunkEnd; i++)
+         {
+            stepper(&state[0]);
+            for (int c=0; c < dimension; c++)
+            {
+               points[i][c]=state[c];
+            }
+         }
       }
-      //std::cout << xmin << " " << xmax << " " << ymin << " " << ymax << " " << zmin << " " << zmax << std::endl;
+   }
+
+   return true;
+}
+
+TrajectoryCache::Key StaticSolverTool::cacheKey(StaticSolverData* data)
+{
+   return TrajectoryCache::Key(*experiment->model,
+         *getSolutionIntegrator(experiment, integrationMethod), data->points[0],
+         data->numberOfPoints);
+}
 
-      // set first and last
-      points[0][0] = .95 * points[1][0];
-      points[0][1] = .95 * points[1][1];
-      points[0][2] = .95 * points[1][2];
-      points[numPoints+1][0] = .95 * points[numPoints][0];
-      points[numPoints+1][1] = .95 * points[numPoints][1];
-      points[numPoints+1][2] = .95 * points[numPoints][2];
+/** Fills in the trajectory from the cache, or computes and caches it.
+ */
+void StaticSolverTool::solveStaticSolution(StaticSolverData* data)
+{
+   solvedIntegrator=experiment->integrator;
+   solvedModelVersion=experiment->model->getVersion();
+   solvedIntegratorVersion=experiment->integrator->getVersion();
 
+   TrajectoryCache::Key key=cacheKey(data);
+   data->history=AdamsBashforthMoulton4::History();
+   if (cache.find(key, data->points))
+   {
+      // the derivatives belong to another computation, so the multistep
+      // integrator restarts if the trajectory is extended
+      data->computedPoints=data->numberOfPoints;
+      data->refining=false;
+      return;
+   }
 
+   // show the start at once, frame() computes the rest
+   data->computedPoints=1;
+   data->refining=true;
+   extendStaticSolution(data, InitialPoints);
+}
 
+/** Computes up to 'count' more points of a trajectory.
+ *
+ * Complete trajectories are cached and move to the display list.
+ */
+void StaticSolverTool::extendStaticSolution(StaticSolverData* data, unsigned int count)
+{
+   unsigned int last=std::min(data->computedPoints + count, data->numberOfPoints);
+   if (data->computedPoints < last)
+   {
+      // also called from button events, while other tools may step
+      finishSimulationStep();
+      integrate(experiment, integrationMethod, data->points, data->history,
+            data->computedPoints, last);
+      data->computedPoints=last;
    }
-   else if (datasets[0]->colorStyle == StaticSolverData::GRADIENT)
+
+   if (data->isComplete() && data->refining)
    {
-      glDisable(GL_LIGHTING);
+      data->refining=false;
+      cache.insert(cacheKey(data), data->points, data->numberOfPoints);
+      requestDataDisplayListUpdate();
+   }
+}
+
+/** Extends the trajectories still being computed for RefinementBudget seconds.
+ */
+void StaticSolverTool::refineStaticSolutions()
+{
+   Misc::Timer timer;
 
-      for (unsigned int i=0; i < numPoints; i++)
+   std::vector<StaticSolverData*>::iterator it;
+   for (it = datasets.begin(); it != datasets.end(); it++)
+   {
+      while ((*it)->refining && timer.peekTime() < RefinementBudget)
       {
-         unsigned int index=(int) ((float) i / (float) numPoints * 255.0);
+         extendStaticSolution(*it, ChunkSize);
+      }
+   }
+}
 
-         const float* color=datasets[0]->colorMap->getColor(index);
-         glColor3fv(color);
+void StaticSolverTool::recomputeDatasets()
+{
+   std::vector<StaticSolverData*>::iterator it;
+   for (it = datasets.begin(); it != datasets.end(); it++)
+   {
+      solveStaticSolution(*it);
+   }
+   requestDataDisplayListUpdate();
+}
 
-         colors[i][0]=color[0];
-         colors[i][1]=color[1];
-         colors[i][2]=color[2];
+/** Recomputes all datasets for the current parameters.
+ *
+ * Cached trajectories are filled in at once. The others are left to the
+ * worker, which replaces a job that is still running, so the datasets keep
+ * showing their previous trajectories until frame() picks up the new ones.
+ * Without a worker, i.e. if the experiment cannot be cloned, they are
+ * computed here.
+ */
+void StaticSolverTool::requestRecompute()
+{
+   if (!workerRunning)
+   {
+      recomputeDatasets();
+      return;
+   }
 
-         experiment->transformer->transform(d->points[i], tmp);
+   solvedIntegrator=experiment->integrator;
+   solvedModelVersion=experiment->model->getVersion();
+   solvedIntegratorVersion=experiment->integrator->getVersion();
 
-         points[i+1][0]=tmp[0];
-         points[i+1][1]=tmp[1];
-         points[i+1][2]=tmp[2];
-      }
+   Threads::Mutex::Lock lock(jobMutex);
 
-      // set first and last
-      colors[0][0] = colors[1][0];
-      colors[0][1] = colors[1][1];
-      colors[0][2] = colors[1][2];
-      colors[numPoints+1][0] = colors[numPoints][0];
-      colors[numPoints+1][1] = colors[numPoints][1];
-      colors[numPoints+1][2] = colors[numPoints][2];
+   ++generation;
+   pendingJob.clear();
+   pendingJob.generation=generation;
+   pendingJob.integrationMethod=integrationMethod;
 
-      points[0][0] = .95 * points[1][0];
-      points[0][1] = .95 * points[1][1];
-      points[0][2] = .95 * points[1][2];
-      points[numPoints+1][0] = .95 * points[numPoints][0];
-      points[numPoints+1][1] = .95 * points[numPoints][1];
-      points[numPoints+1][2] = .95 * points[numPoints][2];
+   std::vector<StaticSolverData*>::iterator it;
+   for (it = datasets.begin(); it != datasets.end(); it++)
+   {
+      StaticSolverData* data=*it;
+      TrajectoryCache::Key key=cacheKey(data);
+      data->history=AdamsBashforthMoulton4::History();
+      if (cache.find(key, data->points))
+      {
+         data->computedPoints=data->numberOfPoints;
+         data->refining=false;
+         continue;
+      }
 
+      // keep showing what there is until the worker delivers
+      data->refining=false;
+      pendingJob.datasets.push_back(data);
+      pendingJob.keys.push_back(key);
+      pendingJob.points.push_back(std::vector<DTS::Vector<double> >(data->numberOfPoints,
+            data->points[0]));
+   }
+   requestDataDisplayListUpdate();
 
+   jobDue=!pendingJob.datasets.empty();
+   if (jobDue)
+   {
+      stagingExperiment->copyParamValues(*experiment);
+      jobCond.signal();
    }
+}
 
-   // draw line as generalized cylinder
-   glePolyCylinder(
-      numPoints,  // num points in polyline
-      points,     // polyline vertces
-      colors,     // colors at polyline verts
-      radius      // radius of polycylinder
-   );
+/** Cancels the recomputation in flight, if any.
+ *
+ * \return true if there was one.
+ */
+bool StaticSolverTool::cancelRecompute()
+{
+   Threads::Mutex::Lock lock(jobMutex);
 
-   // restore previous attribute state
-   glPopAttrib();
+   bool recomputing=jobDue || jobRunning || jobFinished;
+   ++generation;
+   jobDue=false;
+   jobFinished=false;
+   pendingJob.clear();
+   finishedJob.clear();
+
+   return recomputing;
 }
 
-/* Private methods */
+void StaticSolverTool::startWorker()
+{
+   stagingExperiment=experiment->clone();
+   workerExperiment=experiment->clone();
+   if (stagingExperiment == NULL || workerExperiment == NULL)
+   {
+      delete stagingExperiment;
+      delete workerExperiment;
+      stagingExperiment=NULL;
+      workerExperiment=NULL;
+      return;
+   }
 
-void StaticSolverTool::computeStaticSolution(StaticSolverData* data)
+   jobDue=false;
+   jobRunning=false;
+   jobFinished=false;
+   workerRunning=true;
+   worker.start(this, &StaticSolverTool::workerMethod);
+}
+
+void StaticSolverTool::stopWorker()
 {
-   DTS::Vector<double> tmp(experiment->model->getDimension());
-   for (unsigned int i=1; i < data->numberOfPoints; i++)
+   if (!workerRunning)
+   {
+      return;
+   }
+
+   cancelRecompute();
    {
-      data->points[i] = data->points[i-1];
-      experiment->integrator->step(data->points[i-1], tmp);
-      data->points[i] += tmp;
+      Threads::Mutex::Lock lock(jobMutex);
+      workerRunning=false;
+      jobCond.signal();
    }
+
+   // wait for the current chunk to finish
+   worker.join();
+
+   delete stagingExperiment;
+   delete workerExperiment;
+   stagingExperiment=NULL;
+   workerExperiment=NULL;
 }
 
+void* StaticSolverTool::workerMethod()
+{
+   DTS::Trace::setThreadName("static solver");
+
+   StaticSolverJob job;
+
+   while (true)
+   {
+      {
+         Threads::Mutex::Lock lock(jobMutex);
+         while (!jobDue && workerRunning)
+         {
+            jobCond.wait(jobMutex);
+         }
+
+         if (!workerRunning)
+         {
+            break;
+         }
+
+         job.swap(pendingJob);
+         jobDue=false;
+         jobRunning=true;
+         workerExperiment->copyParamValues(*stagingExperiment);
+      }
+
+      bool completed=true;
+      {
+         DTS_TRACE_SCOPE("StaticSolverTool::workerMethod");
+         for (unsigned int i=0; i < job.points.size() && completed; i++)
+         {
+            AdamsBashforthMoulton4::History history;
+            completed=integrate(workerExperiment, job.integrationMethod, job.points[i],
+                  history, 1, job.points[i].size(), &generation, job.generation);
+         }
+      }
+
+      Threads::Mutex::Lock lock(jobMutex);
+      jobRunning=false;
+      if (completed && job.generation == generation)
+      {
+         job.swap(finishedJob);
+         jobFinished=true;
+      }
+      job.clear();
+   }
+
+   return 0;
+}
 
 void StaticSolverTool::clearDatasets()
 {
+   // the worker may not deliver trajectories for the deleted datasets
+   cancelRecompute();
+
    // clear all dynamically allocated StaticSolverData instances
    std::vector<StaticSolverData*>::iterator it;
    for (it = datasets.begin(); it != datasets.end(); it++)
@@ -418,17 +777,314 @@ void StaticSolverTool::updateDataDisplayList(DTS::DataItem* dataItem) const
    // Recall: 'it' is a pointer to a pointer of a StaticSolverData instance.
    for (it = datasets.begin(); it != datasets.end(); it++)
    {
-      // delegate rendering based on line style
+      // trajectories still being computed are drawn by drawPartialLines()
+      if (not (*it)->isComplete())
+      {
+         continue;
+      }
+
+      // tubes are drawn from their meshes by drawTubes()
       if (datasets[0]->lineStyle == StaticSolverData::BASIC)
       {
          drawBasicLine(*it);
       }
-      else if (datasets[0]->lineStyle == StaticSolverData::POLY_LINE)
+   }
+
+   glEndList();
+}
+
+/** Rebuilds the tube meshes after the trajectories or their style changed.
+ *
+ * This replaces tessellating every tube with glePolyCylinder whenever the
+ * display list is compiled. The meshes are built once per version of the
+ * datasets, on the application's worker threads, and drawn by drawTubes().
+ */
+void StaticSolverTool::updateTubes()
+{
+   tubeVersion=dataDisplayListVersion;
+
+   while (tubes.size() < datasets.size())
+   {
+      tubes.push_back(new TubeMesh);
+   }
+
+   std::vector<double> states;
+   std::vector<double> displays;
+   std::vector<float> colors;
+
+   for (unsigned int i=0; i < tubes.size(); i++)
+   {
+      TubeMesh& tube=*tubes[i];
+      if (i >= datasets.size() || not datasets[i]->isComplete()
+            || datasets[i]->lineStyle != StaticSolverData::POLY_LINE)
       {
-         drawPolyLine(*it);
+         tube.clear();
+         continue;
       }
+
+      StaticSolverData* d=datasets[i];
+      const unsigned int n=d->numberOfPoints;
+
+      transformPoints(d, states, displays);
+
+      const float* tubeColors=NULL;
+      if (d->colorStyle == StaticSolverData::GRADIENT)
+      {
+         colors.resize(3 * size_t(n));
+         for (unsigned int j=0; j < n; j++)
+         {
+            const float* color=d->colorMap->getColor((int) ((float) j / (float) n * 255.0));
+            colors[3 * j + 0]=color[0];
+            colors[3 * j + 1]=color[1];
+            colors[3 * j + 2]=color[2];
+         }
+         tubeColors=&colors[0];
+      }
+
+      tube.build(&displays[0], tubeColors, n, TubeRadius, threadPool());
    }
+}
 
-   glEndList();
+namespace
+{
+   /** Radius in pixels of a tube at the point of its bounding sphere
+    *  closest to the viewer.
+    */
+   double projectedTubeRadius(const TubeMesh& tube, const GLdouble* modelview,
+         const GLdouble* projection, const GLint* viewport)
+   {
+      // the navigation transformation scales uniformly
+      double scale=sqrt(modelview[0] * modelview[0] + modelview[1] * modelview[1]
+            + modelview[2] * modelview[2]);
+      double pixels=scale * tube.getRadius() * projection[5] * 0.5 * viewport[3];
+
+      // orthographic projections do not shrink with distance
+      if (projection[11] == 0.0)
+      {
+         return pixels;
+      }
+
+      const double* c=tube.getCenter();
+      double depth=-(modelview[2] * c[0] + modelview[6] * c[1] + modelview[10] * c[2]
+            + modelview[14]) - scale * tube.getBoundingRadius();
+      if (depth <= 0.0)
+      {
+         // the viewer is inside the bounding sphere
+         return pixels * 1.0e6;
+      }
+
+      return pixels / depth;
+   }
+
+   // Vertex layout GL_C3F_V3F
+   struct LineVertex
+   {
+      GLfloat color[3];
+      GLfloat position[3];
+   };
 }
 
+/** Draws the tubes of the complete trajectories, each at the level of
+ *  detail for its size on screen.
+ */
+void StaticSolverTool::drawTubes(DTS::DataItem* dataItem) const
+{
+   bool any=false;
+   for (unsigned int i=0; i < tubes.size(); i++)
+   {
+      any=any || not tubes[i]->empty();
+   }
+   if (not any)
+   {
+      return;
+   }
+
+   const bool useBuffers=dataItem->hasVertexBufferObjectExtension;
+   std::vector<GLuint>& bufferIds=dataItem->staticSolverTubeBufferIds;
+
+   if (useBuffers && dataItem->staticSolverTubeVersion != tubeVersion)
+   {
+      while (bufferIds.size() < 2 * tubes.size())
+      {
+         GLuint id;
+         glGenBuffersARB(1, &id);
+         bufferIds.push_back(id);
+      }
+
+      for (unsigned int i=0; i < tubes.size(); i++)
+      {
+         size_t bytes=tubes[i]->upload(bufferIds[2 * i], bufferIds[2 * i + 1]);
+         DTS::Counters::add(DTS::Counters::UPLOAD_BYTES, bytes);
+      }
+      dataItem->staticSolverTubeVersion=tubeVersion;
+   }
+
+   // save the current attribute state
+   glPushAttrib(GL_LIGHTING_BIT | GL_TRANSFORM_BIT);
+   glEnable(GL_NORMALIZE);
+
+   GLMaterial material(GLMaterial::Color(1.0, 0.5, 0.0, 1.0), GLMaterial::Color(1.0, 1.0, 1.0, 1.0), 80.0);
+
+   GLdouble modelview[16];
+   GLdouble projection[16];
+   GLint viewport[4];
+   glGetDoublev(GL_MODELVIEW_MATRIX, modelview);
+   glGetDoublev(GL_PROJECTION_MATRIX, projection);
+   glGetIntegerv(GL_VIEWPORT, viewport);
+
+   for (unsigned int i=0; i < tubes.size(); i++)
+   {
+      const TubeMesh& tube=*tubes[i];
+      if (tube.empty())
+      {
+         continue;
+      }
+
+      // gradient tubes are colored per vertex, solid ones are lit
+      if (tube.hasColors())
+      {
+         glDisable(GL_LIGHTING);
+      }
+      else
+      {
+         glEnable(GL_LIGHTING);
+         glMaterial(GLMaterialEnums::FRONT_AND_BACK, material);
+      }
+
+      unsigned int level=tube.selectLevel(projectedTubeRadius(tube, modelview, projection, viewport));
+
+      if (useBuffers)
+      {
+         glBindBufferARB(GL_ARRAY_BUFFER_ARB, bufferIds[2 * i]);
+         glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, bufferIds[2 * i + 1]);
+      }
+      tube.draw(level, useBuffers);
+   }
+
+   if (useBuffers)
+   {
+      glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, 0);
+      glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+   }
+
+   // restore the previous attribute state
+   glPopAttrib();
+}
+
+/** Draws the trajectories still being computed as lines.
+ *
+ * Each dataset has a region of numberOfPoints vertices in a buffer object.
+ * Only points computed since the last frame are transformed and uploaded,
+ * the buffer is refilled when the display list version changes.
+ */
+void StaticSolverTool::drawPartialLines(DTS::DataItem* dataItem) const
+{
+   bool partial=false;
+   for (unsigned int i=0; i < datasets.size(); i++)
+   {
+      partial=partial || not datasets[i]->isComplete();
+   }
+   if (not partial)
+   {
+      return;
+   }
+
+   // save the current attribute state
+   glPushAttrib(GL_LIGHTING_BIT);
+   glDisable(GL_LIGHTING);
+
+   std::vector<LineVertex> vertices;
+   const float solid[3]={1.0f, 0.5f, 0.0f};
+
+   if (dataItem->hasVertexBufferObjectExtension)
+   {
+      glBindBufferARB(GL_ARRAY_BUFFER_ARB, dataItem->staticSolverBufferId);
+
+      std::vector<unsigned int>& uploaded=dataItem->staticSolverUploadedPoints;
+      if (dataItem->staticSolverBufferVersion != dataDisplayListVersion
+            || uploaded.size() != datasets.size())
+      {
+         glBufferDataARB(GL_ARRAY_BUFFER_ARB, datasets.size() * numberOfPoints
+               * sizeof(LineVertex), NULL, GL_DYNAMIC_DRAW_ARB);
+         uploaded.assign(datasets.size(), 0);
+         dataItem->staticSolverBufferVersion=dataDisplayListVersion;
+      }
+
+      glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+      glInterleavedArrays(GL_C3F_V3F, 0, 0);
+
+      for (unsigned int i=0; i < datasets.size(); i++)
+      {
+         StaticSolverData* d=datasets[i];
+         if (d->isComplete())
+         {
+            continue;
+         }
+
+         // append the points computed since the last upload
+         unsigned int first=uploaded[i];
+         unsigned int last=std::min(d->computedPoints, numberOfPoints);
+         if (first < last)
+         {
+            vertices.resize(last - first);
+            for (unsigned int j=first; j < last; j++)
+            {
+               const float* color=solid;
+               if (d->colorStyle == StaticSolverData::GRADIENT)
+               {
+                  color=d->colorMap->getColor((int) ((float) j / (float) d->numberOfPoints * 255.0));
+               }
+               experiment->transformer->transform(d->points[j], dataItem->tempDisplay);
+
+               LineVertex& v=vertices[j - first];
+               v.color[0]=color[0];
+               v.color[1]=color[1];
+               v.color[2]=color[2];
+               v.position[0]=dataItem->tempDisplay[0];
+               v.position[1]=dataItem->tempDisplay[1];
+               v.position[2]=dataItem->tempDisplay[2];
+            }
+
+            glBufferSubDataARB(GL_ARRAY_BUFFER_ARB, (i * numberOfPoints + first)
+                  * sizeof(LineVertex), vertices.size() * sizeof(LineVertex), &vertices[0]);
+            DTS::Counters::add(DTS::Counters::UPLOAD_BYTES, vertices.size() * sizeof(LineVertex));
+            uploaded[i]=last;
+         }
+
+         glDrawArrays(GL_LINE_STRIP, i * numberOfPoints, uploaded[i]);
+      }
+
+      glPopClientAttrib();
+      glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+   }
+   else
+   {
+      for (unsigned int i=0; i < datasets.size(); i++)
+      {
+         StaticSolverData* d=datasets[i];
+         if (d->isComplete())
+         {
+            continue;
+         }
+
+         glBegin(GL_LINE_STRIP);
+         for (unsigned int j=0; j < d->computedPoints; j++)
+         {
+            if (d->colorStyle == StaticSolverData::GRADIENT)
+            {
+               glColor3fv(d->colorMap->getColor((int) ((float) j / (float) d->numberOfPoints * 255.0)));
+            }
+            else
+            {
+               glColor3fv(solid);
+            }
+            experiment->transformer->transform(d->points[j], dataItem->tempDisplay);
+            glVertex3f(dataItem->tempDisplay[0], dataItem->tempDisplay[1], dataItem->tempDisplay[2]);
+         }
+         glEnd();
+      }
+   }
+
+   // restore the previous attribute state
+   glPopAttrib();
+}
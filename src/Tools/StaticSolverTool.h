@@ -22,12 +22,16 @@
 
 // STL includes
 //
+#include <algorithm>
 #include <vector>
 #include <iostream>
 
 // Vrui includes
 //
 #include <GL/GLModels.h>
+#include <Threads/Thread.h>
+#include <Threads/Mutex.h>
+#include <Threads/Cond.h>
 
 // External includes
 //
@@ -38,8 +42,12 @@
 #include "DataItem.h"
 #include "AbstractDynamicsTool.h"
 #include "Dynamics/Vector.h"
+#include "Dynamics/AdamsBashforthMoulton4.h"
+#include "Dynamics/ThreadPool.h"
 
 #include "StaticSolverOptionsDialog.h"
+#include "TrajectoryCache.h"
+#include "TubeMesh.h"
 
 // Forward declarations
 class StaticSolverTool;
@@ -58,7 +66,8 @@ class StaticSolverData
 
    public:
       StaticSolverData(int modelDimension) :
-         numberOfPoints(5000), lineStyle(BASIC), colorStyle(GRADIENT)
+         numberOfPoints(5000), computedPoints(1), refining(false), lineStyle(BASIC),
+               colorStyle(GRADIENT)
       {
          points.reserve(numberOfPoints);
 
@@ -89,13 +98,23 @@ class StaticSolverData
          SOLID, GRADIENT
       };
 
+      enum IntegrationMethod
+      {
+         STEPPED, ADAPTIVE, MULTISTEP
+      };
+
       void setNumberOfPoints(unsigned int size, unsigned int dimension)
       {
          // resize, provide vector of proper dimension to copy from
          DTS::Vector<double> dummy(dimension);
          points.resize(size, dummy);
          numberOfPoints = size;
+         computedPoints = std::min(computedPoints, size);
+      }
 
+      bool isComplete() const
+      {
+         return computedPoints >= numberOfPoints;
       }
 
       static const unsigned int MaxPoints;
@@ -103,11 +122,50 @@ class StaticSolverData
    private:
       unsigned int numberOfPoints; ///< Number of points to use when rendering line.
       std::vector<DTS::Vector<double> > points; ///< Actual point data.
+      unsigned int computedPoints; ///< Number of valid points at the start of 'points'.
+      bool refining; ///< Whether StaticSolverTool::frame() computes the remaining points.
 
       LineStyle lineStyle; ///< Style used in rendering line.
       ColorStyle colorStyle; ///< Color used in redering line.
 
       ColorMap* colorMap; ///< Color map for rendering color gradient.
+
+      AdamsBashforthMoulton4::History history; ///< Derivatives at the last points for the multistep integrator.
+};
+
+/** Trajectories recomputed on the worker thread of StaticSolverTool.
+ *
+ * The datasets are only referenced, never touched, by the worker; they are
+ * valid as long as the generation of the job is the current one.
+ */
+struct StaticSolverJob
+{
+      StaticSolverJob() :
+         generation(0), integrationMethod(StaticSolverData::ADAPTIVE)
+      {
+      }
+
+      void clear()
+      {
+         datasets.clear();
+         keys.clear();
+         points.clear();
+      }
+
+      void swap(StaticSolverJob& other)
+      {
+         std::swap(generation, other.generation);
+         std::swap(integrationMethod, other.integrationMethod);
+         datasets.swap(other.datasets);
+         keys.swap(other.keys);
+         points.swap(other.points);
+      }
+
+      unsigned int generation;
+      StaticSolverData::IntegrationMethod integrationMethod;
+      std::vector<StaticSolverData*> datasets; ///< Datasets the trajectories are for.
+      std::vector<TrajectoryCache::Key> keys; ///< Cache keys of the trajectories.
+      std::vector<std::vector<DTS::Vector<double> > > points; ///< Initial states in, trajectories out.
 };
 
 /** Computes the path of a particle and renders it as a line.
@@ -175,6 +233,7 @@ class StaticSolverTool: public AbstractDynamicsTool, public GLObject
       virtual void setExperiment(DTSExperiment* e);
       virtual void updatedExperiment();
       virtual void step();
+      virtual void frame();
 
       void addStaticSolution(DTS::Vector<double> position);
 
@@ -220,8 +279,19 @@ class StaticSolverTool: public AbstractDynamicsTool, public GLObject
          Vrui::requestUpdate();
       }
 
+      void setIntegrationMethod(StaticSolverData::IntegrationMethod method)
+      {
+         integrationMethod = method;
+         requestRecompute();
+         Vrui::requestUpdate();
+      }
+
       void setNumberOfPoints(unsigned int size)
       {
+         // a running recomputation has the old number of points, restart it
+         // instead of extending trajectories it is about to replace
+         bool recomputing=cancelRecompute();
+
          StaticSolverData* data;
 
          std::vector<StaticSolverData*>::iterator it;
@@ -230,21 +300,16 @@ class StaticSolverTool: public AbstractDynamicsTool, public GLObject
             data = *it;
             data->setNumberOfPoints(size, experiment->model->getDimension());
 
-            // Assumption: All StaticSolutions have the same number of points.
-            // So if we enter this branch for one solution, we will enter this
-            // for all solutions.
-            if (size > numberOfPoints)
-            {
-               // So, we need to calculate solutions for new points
-               for (unsigned int i=numberOfPoints; i < size; i++)
-               {
-                  experiment->integrator->step(data->points[i-1], data->points[i]);
-                  data->points[i] += data->points[i-1];
-               }
-            }
+            // new points are computed over the next frames by frame()
+            data->refining = !recomputing && !data->isComplete();
          }
          numberOfPoints = size;
 
+         if (recomputing)
+         {
+            requestRecompute();
+         }
+
          requestDataDisplayListUpdate();
          Vrui::requestUpdate();
       }
@@ -259,12 +324,65 @@ class StaticSolverTool: public AbstractDynamicsTool, public GLObject
       unsigned int numberOfPoints;
       StaticSolverData::LineStyle lineStyle;
       StaticSolverData::ColorStyle colorStyle;
+      StaticSolverData::IntegrationMethod integrationMethod;
+
+      TrajectoryCache cache; ///< Trajectories computed before, see solveStaticSolution().
+      const Integrator<double>* solvedIntegrator; ///< Integrator and versions the datasets were computed with.
+      unsigned int solvedModelVersion;
+      unsigned int solvedIntegratorVersion;
+
+      /* Recomputation on a worker thread, so that dragging a parameter
+       * slider does not wait for the trajectories. */
+      DTSExperiment* stagingExperiment; ///< Parameters for the next job, guarded by jobMutex.
+      DTSExperiment* workerExperiment; ///< Only used by the worker.
+      Threads::Thread worker;
+      Threads::Mutex jobMutex; ///< Guards the jobs and flags below.
+      Threads::Cond jobCond; ///< Signaled when a job is due or the worker should exit.
+      StaticSolverJob pendingJob; ///< Next job for the worker.
+      StaticSolverJob finishedJob; ///< Trajectories for frame() to pick up.
+      volatile unsigned int generation; ///< Increased to cancel the jobs in flight.
+      bool jobDue;
+      bool jobRunning;
+      bool jobFinished;
+      bool workerRunning;
+
+      /* Tubes of the complete trajectories in POLY_LINE style */
+      std::vector<TubeMesh*> tubes; ///< Indexed like datasets, empty for the others.
+      unsigned int tubeVersion; ///< dataDisplayListVersion the tubes were built for.
+
+      /* Progressive computation of long trajectories */
+      static const unsigned int ChunkSize; ///< Points computed between checks for cancellation and time.
+      static const unsigned int InitialPoints; ///< Points of a new trajectory shown at once.
+      static const double RefinementBudget; ///< Seconds per frame spent on remaining points.
+
+      /* Rendering of complete trajectories */
+      static const double TubeRadius; ///< Radius of the tubes in POLY_LINE style.
+      static const double LineTolerance; ///< Distance basic lines may deviate from the trajectory.
 
       /* Internal methods */
-      void computeStaticSolution(StaticSolverData* d);
+      static Integrator<double>* getSolutionIntegrator(DTSExperiment* e,
+            StaticSolverData::IntegrationMethod method);
+      static bool integrate(DTSExperiment* e, StaticSolverData::IntegrationMethod method,
+            std::vector<DTS::Vector<double> >& points, AdamsBashforthMoulton4::History& history,
+            unsigned int first, unsigned int last, const volatile unsigned int* generation=NULL,
+            unsigned int jobGeneration=0);
+      TrajectoryCache::Key cacheKey(StaticSolverData* d);
+      void solveStaticSolution(StaticSolverData* d);
+      void extendStaticSolution(StaticSolverData* d, unsigned int count);
+      void refineStaticSolutions();
+      void recomputeDatasets();
+      void requestRecompute();
+      bool cancelRecompute();
+      void startWorker();
+      void stopWorker();
+      void* workerMethod();
       void clearDatasets();
+      void transformPoints(const StaticSolverData* d, std::vector<double>& states,
+            std::vector<double>& displays) const;
       void drawBasicLine(StaticSolverData* d) const;
-      void drawPolyLine(StaticSolverData* d) const;
+      void updateTubes();
+      void drawTubes(DTS::DataItem* dataItem) const;
+      void drawPartialLines(DTS::DataItem* dataItem) const;
       void requestDatasetsUpdate();
       void requestDataDisplayListUpdate();
       void updateDataDisplayList(DTS::DataItem* dataItem) const;
@@ -0,0 +1,156 @@
+/*******************************************************************************
+ SweepViewerOptionsDialog: User-interface dialog for the SweepViewerTool.
+
+ This file is part of the Dynamics Toolset.
+
+ The Dynamics Toolset is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by the Free
+ Software Foundation, either version 3 of the License, or (at your option) any
+ later version.
+
+ The Dynamics Toolset is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ details.
+
+ You should have received a copy of the GNU General Public License
+ along with the Dynamics Toolset. If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#include "SweepViewerOptionsDialog.h"
+
+#include "GLMotif/WidgetFactory.h"
+#include "SweepViewerTool.h"
+#include "Dynamics/Trace.h"
+
+GLMotif::PopupWindow* SweepViewerOptionsDialog::createDialog()
+{
+   WidgetFactory factory;
+
+   // create popup-shell
+   GLMotif::PopupWindow* parameterDialogPopup=factory.createPopupWindow("ParameterDialogPopup", "Sweep Viewer Options");
+
+   // create the main layout
+   GLMotif::RowColumn* parameterDialog=factory.createRowColumn("ParameterDialog", 3);
+   factory.setLayout(parameterDialog);
+
+   factory.createLabel("FileLabel", "File");
+
+   fileValue=factory.createTextField("FileTextField", 20);
+
+   GLMotif::Button* nextFile=factory.createButton("NextFile", "Next File");
+   nextFile->getSelectCallbacks().add(this, &SweepViewerOptionsDialog::buttonCallback);
+
+   factory.createLabel("PointsLabel", "Points");
+
+   pointsValue=factory.createTextField("PointsTextField", 20);
+
+   GLMotif::Button* rescanFiles=factory.createButton("RescanFiles", "Rescan Files");
+   rescanFiles->getSelectCallbacks().add(this, &SweepViewerOptionsDialog::buttonCallback);
+
+   factory.createLabel("PointSizeLabel", "Point Size");
+
+   pointSizeValue=factory.createTextField("PointSizeTextField", 10);
+   pointSizeValue->setString("2.0");
+
+   pointSizeSlider=factory.createSlider("PointSizeSlider", 15.0);
+   pointSizeSlider->setValueRange(1.0, 10.0, 0.5);
+   pointSizeSlider->setValue(2.0);
+
+   pointSizeSlider->getValueChangedCallbacks().add(this, &SweepViewerOptionsDialog::sliderCallback);
+
+   // create display check boxes
+   GLMotif::ToggleButton* diagramToggle=factory.createCheckBox("DiagramToggle", "Diagram", true);
+   GLMotif::ToggleButton* phaseSpaceToggle=factory.createCheckBox("PhaseSpaceToggle", "Phase Space");
+
+   // set callbacks for toggle buttons (check boxes)
+   diagramToggle->getValueChangedCallbacks().add(this, &SweepViewerOptionsDialog::displayTogglesCallback);
+   phaseSpaceToggle->getValueChangedCallbacks().add(this, &SweepViewerOptionsDialog::displayTogglesCallback);
+
+   // add toggle buttons to array for radio-button behavior
+   displayToggles.push_back(diagramToggle);
+   displayToggles.push_back(phaseSpaceToggle);
+
+   parameterDialog->manageChild();
+
+   updateFile();
+
+   return parameterDialogPopup;
+}
+
+void SweepViewerOptionsDialog::updateFile()
+{
+   SweepViewerTool* pTool=static_cast<SweepViewerTool*> (tool);
+
+   std::string name=pTool->getFileName();
+   fileValue->setString(name.empty() ? "(no .sweep files)" : name.c_str());
+
+   char buff[20];
+   snprintf(buff, sizeof(buff), "%lu", (unsigned long) pTool->getNumberOfPoints());
+   pointsValue->setString(buff);
+}
+
+void SweepViewerOptionsDialog::sliderCallback(GLMotif::Slider::ValueChangedCallbackData* cbData)
+{
+   DTS_TRACE_SCOPE("SweepViewerOptionsDialog::sliderCallback");
+
+   float value=cbData->value;
+
+   char buff[10];
+
+   SweepViewerTool* pTool=static_cast<SweepViewerTool*> (tool);
+
+   std::string name=cbData->slider->getName();
+
+   if (name == "PointSizeSlider")
+   {
+      pTool->setPointSize(value);
+
+      snprintf(buff, sizeof(buff), "%.1f", value);
+      pointSizeValue->setString(buff);
+   }
+}
+
+void SweepViewerOptionsDialog::displayTogglesCallback(GLMotif::ToggleButton::ValueChangedCallbackData* cbData)
+{
+   DTS_TRACE_SCOPE("SweepViewerOptionsDialog::displayTogglesCallback");
+
+   std::string name=cbData->toggle->getName();
+
+   SweepViewerTool* pTool=static_cast<SweepViewerTool*> (tool);
+
+   if (name == "DiagramToggle")
+   {
+      pTool->setDisplayMode(SweepViewerTool::DIAGRAM);
+   }
+   else if (name == "PhaseSpaceToggle")
+   {
+      pTool->setDisplayMode(SweepViewerTool::PHASE_SPACE);
+   }
+
+   // fake radio-button behavior
+   for (ToggleArray::iterator button=displayToggles.begin(); button
+         != displayToggles.end(); ++button)
+      if (strcmp((*button)->getName(), name.c_str()) != 0
+            and (*button)->getToggle())
+         (*button)->setToggle(false);
+      else if (strcmp((*button)->getName(), name.c_str()) == 0)
+         (*button)->setToggle(true);
+}
+
+void SweepViewerOptionsDialog::buttonCallback(GLMotif::Button::SelectCallbackData* cbData)
+{
+   DTS_TRACE_SCOPE("SweepViewerOptionsDialog::buttonCallback");
+
+   std::string name=cbData->button->getName();
+   SweepViewerTool* pTool=static_cast<SweepViewerTool*> (tool);
+   if (name == "NextFile")
+   {
+      pTool->loadNextFile();
+   }
+   else if (name == "RescanFiles")
+   {
+      pTool->rescanFiles();
+   }
+
+   updateFile();
+}
@@ -0,0 +1,333 @@
+/*******************************************************************************
+ SweepViewerTool: Shows the bifurcation diagrams written by the sweep program.
+
+ This file is part of the Dynamics Toolset.
+
+ The Dynamics Toolset is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by the Free
+ Software Foundation, either version 3 of the License, or (at your option) any
+ later version.
+
+ The Dynamics Toolset is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ details.
+
+ You should have received a copy of the GNU General Public License
+ along with the Dynamics Toolset. If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#include "SweepViewerTool.h"
+
+// STL includes
+//
+#include <algorithm>
+#include <cstdlib>
+
+// System includes
+//
+#include <unistd.h>
+
+// External includes
+//
+#include "Directory.h"
+#include "VruiStreamManip.h"
+
+// Project includes
+//
+#include "Dynamics/Counters.h"
+#include "Dynamics/Factory.h"
+
+//
+// SweepViewerTool::Icon methods
+//
+
+void SweepViewerTool::Icon::display(GLContextData& contextData) const
+{
+   DataItem* dataItem=contextData.retrieveDataItem<DataItem> (parent);
+   glCallList(dataItem->displayListId);
+}
+
+//
+// SweepViewerTool::DataItem methods
+//
+
+SweepViewerTool::DataItem::DataItem(void) :
+   displayListId(glGenLists(1))
+{
+}
+
+SweepViewerTool::DataItem::~DataItem(void)
+{
+   glDeleteLists(displayListId, 1);
+}
+
+//
+// SweepViewerTool methods
+//
+
+SweepViewerTool::SweepViewerTool(ToolBox::ToolBox* toolBox, Viewer* app) :
+   AbstractDynamicsTool(toolBox, app), currentFile(-1), version(0),
+         displayMode(DIAGRAM), pointSize(2.0f), origin(0, 0, 0)
+{
+   icon(new Icon(this));
+
+   // Set member from parent class
+   _needsGLSL=false;
+
+   rescanFiles();
+}
+
+void SweepViewerTool::initContext(GLContextData& contextData) const
+{
+   DataItem* dataItem=new DataItem;
+   contextData.addDataItem(this, dataItem);
+
+   // a period-doubling cascade
+   glNewList(dataItem->displayListId, GL_COMPILE);
+
+   glPushAttrib(GL_LIGHTING_BIT | GL_LINE_BIT);
+   glDisable(GL_LIGHTING);
+   glLineWidth(2.0f);
+
+   glColor3f(0.0f, 0.8f, 1.0f);
+   glBegin(GL_LINES);
+   glVertex3f(-0.9f, 0.0f, 0.0f);
+   glVertex3f(-0.3f, 0.0f, 0.0f);
+   glEnd();
+
+   glColor3f(0.6f, 0.4f, 1.0f);
+   glBegin(GL_LINE_STRIP);
+   glVertex3f(0.3f, 0.5f, 0.0f);
+   glVertex3f(-0.3f, 0.0f, 0.0f);
+   glVertex3f(0.3f, -0.5f, 0.0f);
+   glEnd();
+
+   glColor3f(1.0f, 0.3f, 0.3f);
+   glBegin(GL_LINES);
+   for (int branch=-1; branch <= 1; branch+=2)
+   {
+      glVertex3f(0.9f, branch * 0.5f + 0.3f, 0.0f);
+      glVertex3f(0.3f, branch * 0.5f, 0.0f);
+      glVertex3f(0.3f, branch * 0.5f, 0.0f);
+      glVertex3f(0.9f, branch * 0.5f - 0.3f, 0.0f);
+   }
+   glEnd();
+
+   glPopAttrib();
+
+   glEndList();
+}
+
+void SweepViewerTool::setExperiment(DTSExperiment* e)
+{
+   experiment=e;
+
+   // start with the diagram in the middle of the new model
+   DTS::Vector<double> center=experiment->transformer->getCenterPoint();
+   origin=Vrui::Point(center[0], center[1], center[2]);
+
+   placePoints();
+}
+
+void SweepViewerTool::updatedExperiment()
+{
+   // only the phase space view depends on the transformer
+   if (displayMode == PHASE_SPACE)
+   {
+      placePoints();
+   }
+}
+
+void SweepViewerTool::mainButtonPressed(const ToolBox::ButtonPressEvent & buttonPressEvent)
+{
+   if (experiment == NULL || locked)
+   {
+      return;
+   }
+
+   // move the diagram to the locator
+   origin=toolBox()->deviceTransformationInModel().getOrigin();
+
+   if (displayMode == DIAGRAM)
+   {
+      placePoints();
+   }
+}
+
+void SweepViewerTool::rescanFiles()
+{
+   std::string current=getFileName();
+
+   files.clear();
+   if (access(".", R_OK) == 0)
+   {
+      Directory dir;
+      dir.addExtensionFilter("sweep");
+      dir.read(".");
+      files=dir.contents();
+   }
+   std::sort(files.begin(), files.end());
+
+   std::vector<std::string>::iterator it=std::find(files.begin(), files.end(), current);
+   if (it != files.end())
+   {
+      currentFile=it - files.begin();
+   }
+   else
+   {
+      loadFile(files.empty() ? -1 : 0);
+   }
+}
+
+void SweepViewerTool::loadNextFile()
+{
+   if (files.empty())
+   {
+      return;
+   }
+
+   loadFile((currentFile + 1) % files.size());
+}
+
+std::string SweepViewerTool::getFileName() const
+{
+   if (currentFile < 0)
+   {
+      return std::string();
+   }
+   return files[currentFile];
+}
+
+void SweepViewerTool::setDisplayMode(DisplayMode mode)
+{
+   displayMode=mode;
+   placePoints();
+}
+
+bool SweepViewerTool::loadFile(int index)
+{
+   currentFile=-1;
+   parameters.clear();
+   states.clear();
+
+   if (index >= 0)
+   {
+      if (DTS::SweepFile::read(files[index], header, parameters, states))
+      {
+         currentFile=index;
+         master::filter(std::cout)() << "SweepViewer::loaded " << parameters.size()
+               << " points of " << header.experiment << " over " << header.parameter
+               << " from " << files[index] << std::endl;
+      }
+      else
+      {
+         std::cerr << "ERROR: " << files[index] << " is not a sweep file" << std::endl;
+      }
+   }
+
+   placePoints();
+   return currentFile >= 0;
+}
+
+void SweepViewerTool::placePoints()
+{
+   size_t count=parameters.size();
+   points.resize(count);
+   version++;
+
+   if (count == 0)
+   {
+      return;
+   }
+
+   int dimension=header.dimension;
+   double range=header.last - header.first;
+
+   // range of the collected coordinate, which is also the width of the diagram
+   double yMin=states[header.coordinate];
+   double yMax=yMin;
+   for (size_t i=0; i < count; i++)
+   {
+      double y=states[i * dimension + header.coordinate];
+      yMin=std::min(yMin, y);
+      yMax=std::max(yMax, y);
+   }
+   double height=yMax > yMin ? yMax - yMin : 1.0;
+
+   // the states are only meaningful to the experiment that produced them
+   ExperimentFactory::const_iterator maker=Factory.find(header.experiment);
+   bool phaseSpace=displayMode == PHASE_SPACE && experiment != NULL
+         && maker != Factory.end() && maker->second == experiment->getMaker()
+         && experiment->model->getDimension() == dimension;
+   double display[3];
+
+   for (size_t i=0; i < count; i++)
+   {
+      double f=range != 0.0 ? (parameters[i] - header.first) / range : 0.0;
+      ColorPoint& point=points[i];
+
+      if (phaseSpace)
+      {
+         experiment->transformState(&states[i * dimension], display);
+         point.pos[0]=display[0];
+         point.pos[1]=display[1];
+         point.pos[2]=display[2];
+      }
+      else
+      {
+         double y=states[i * dimension + header.coordinate];
+         point.pos[0]=origin[0] + (f - 0.5) * height;
+         point.pos[1]=origin[1] + y - 0.5 * (yMin + yMax);
+         point.pos[2]=origin[2];
+      }
+
+      point.color[0]=(unsigned int) (f * 255.0);
+      point.color[1]=(unsigned int) ((1.0 - 2.0 * std::abs(f - 0.5)) * 160.0);
+      point.color[2]=(unsigned int) ((1.0 - f) * 255.0);
+      point.color[3]=255;
+   }
+}
+
+void SweepViewerTool::render(DTS::DataItem* dataItem) const
+{
+   if (points.empty())
+   {
+      return;
+   }
+
+   glPushAttrib(GL_LIGHTING_BIT | GL_POINT_BIT);
+   glDisable(GL_LIGHTING);
+   glPointSize(pointSize);
+
+   glEnableClientState(GL_VERTEX_ARRAY);
+   glEnableClientState(GL_COLOR_ARRAY);
+
+   if (dataItem->hasVertexBufferObjectExtension)
+   {
+      glBindBufferARB(GL_ARRAY_BUFFER_ARB, dataItem->sweepBufferId);
+
+      // the points only change when a file is loaded or the view changes
+      if (dataItem->sweepBufferVersion != version)
+      {
+         glBufferDataARB(GL_ARRAY_BUFFER_ARB, points.size() * sizeof(ColorPoint),
+               &points[0], GL_STATIC_DRAW_ARB);
+         DTS::Counters::add(DTS::Counters::UPLOAD_BYTES, points.size() * sizeof(ColorPoint));
+         dataItem->sweepBufferVersion=version;
+      }
+
+      glInterleavedArrays(GL_C4UB_V3F, sizeof(ColorPoint), 0);
+      glDrawArrays(GL_POINTS, 0, points.size());
+
+      glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+   }
+   else
+   {
+      glInterleavedArrays(GL_C4UB_V3F, sizeof(ColorPoint), &points[0]);
+      glDrawArrays(GL_POINTS, 0, points.size());
+   }
+
+   glDisableClientState(GL_COLOR_ARRAY);
+   glDisableClientState(GL_VERTEX_ARRAY);
+
+   glPopAttrib();
+}
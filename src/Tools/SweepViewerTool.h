@@ -0,0 +1,176 @@
+/*******************************************************************************
+ SweepViewerTool: Shows the bifurcation diagrams written by the sweep program.
+
+ This file is part of the Dynamics Toolset.
+
+ The Dynamics Toolset is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by the Free
+ Software Foundation, either version 3 of the License, or (at your option) any
+ later version.
+
+ The Dynamics Toolset is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ details.
+
+ You should have received a copy of the GNU General Public License
+ along with the Dynamics Toolset. If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#ifndef SWEEP_VIEWER_TOOL_H
+#define SWEEP_VIEWER_TOOL_H
+
+// STL includes
+//
+#include <string>
+#include <vector>
+
+// Project includes
+//
+#include "FieldViewer.h"
+#include "DataItem.h"
+#include "ColorPoint.h"
+#include "AbstractDynamicsTool.h"
+#include "Dynamics/SweepFile.h"
+
+#include "SweepViewerOptionsDialog.h"
+
+/** Shows the bifurcation diagrams written by the sweep program.
+ *
+ * The tool lists the sweep files (see DTS::SweepFile) in the working
+ * directory and shows one of them as a point cloud, colored from blue at the
+ * first parameter value to red at the last. As a diagram, the parameter runs
+ * along x and the collected coordinate along y, in a square centered where
+ * the main button was last pressed. In phase space, the collected states are
+ * shown through the transformer of the current experiment, on top of the
+ * attractor they were taken from; this needs an experiment of the same
+ * dimension.
+ *
+ * The points only change when a file is loaded or the view changes, so they
+ * are uploaded to a vertex buffer once and drawn from there every frame.
+ */
+class SweepViewerTool: public AbstractDynamicsTool, public GLObject
+{
+   public:
+
+      /// How the points are placed.
+      enum DisplayMode
+      {
+         DIAGRAM,    ///< Parameter against the collected coordinate.
+         PHASE_SPACE ///< Collected states through the experiment transformer.
+      };
+
+      /* Embedded classes */
+
+      class Icon: public ToolBox::Icon
+      {
+         public:
+            Icon(const SweepViewerTool* pTool) :
+               parent(pTool)
+            {
+            }
+            void display(GLContextData& contextData) const;
+            const SweepViewerTool* parent;
+      };
+
+      class DataItem: public GLObject::DataItem
+      {
+         public:
+            DataItem();
+            virtual ~DataItem();
+
+            GLuint displayListId;
+      };
+
+      friend class Icon;
+      friend class DataItem;
+
+   public:
+
+      /* Interface */
+
+      SweepViewerTool(ToolBox::ToolBox* toolBox, Viewer* app);
+
+      virtual ~SweepViewerTool()
+      {
+      }
+
+      virtual void setExperiment(DTSExperiment* e);
+      virtual void updatedExperiment();
+
+      void initContext(GLContextData& contextData) const;
+
+      virtual void moved(const ToolBox::MotionEvent & motionEvent)
+      {
+      }
+      virtual void mainButtonPressed(const ToolBox::ButtonPressEvent & buttonPressEvent);
+      virtual void mainButtonReleased(const ToolBox::ButtonReleaseEvent & buttonReleaseEvent)
+      {
+      }
+      virtual void otherButtonPressed(const ToolBox::ButtonPressEvent & buttonPressEvent)
+      {
+      }
+      virtual void otherButtonReleased(const ToolBox::ButtonReleaseEvent & buttonReleaseEvent)
+      {
+      }
+
+      virtual void render(DTS::DataItem* dataItem) const;
+
+      virtual void step()
+      {
+      }
+
+      virtual CaveDialog* createOptionsDialog(GLMotif::PopupMenu *parent)
+      {
+         dialog=new SweepViewerOptionsDialog(parent, this);
+         return dialog;
+      }
+
+      /* New methods */
+
+      /** Lists the sweep files in the working directory again and loads the
+       * first one if the current file is gone.
+       */
+      void rescanFiles();
+
+      /** Loads the file after the current one, wrapping around.
+       */
+      void loadNextFile();
+
+      /** Name of the loaded file, empty if there is none.
+       */
+      std::string getFileName() const;
+
+      /** Number of points of the loaded file.
+       */
+      size_t getNumberOfPoints() const
+      {
+         return parameters.size();
+      }
+
+      void setDisplayMode(DisplayMode mode);
+
+      void setPointSize(float value)
+      {
+         pointSize=value;
+      }
+
+   private:
+      std::vector<std::string> files;
+      int currentFile; ///< Index into files, -1 if nothing is loaded.
+
+      DTS::SweepFile::Header header;
+      std::vector<double> parameters; ///< Parameter value of every point.
+      std::vector<double> states; ///< 'header.dimension' values per point.
+
+      std::vector<ColorPoint> points; ///< Placed points, rebuilt by placePoints().
+      unsigned int version; ///< Incremented whenever points changes.
+
+      DisplayMode displayMode;
+      float pointSize; ///< In pixels.
+      Vrui::Point origin; ///< Center of the diagram.
+
+      bool loadFile(int index);
+      void placePoints();
+};
+
+#endif
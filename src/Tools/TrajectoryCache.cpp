@@ -0,0 +1,182 @@
+/*******************************************************************************
+ TrajectoryCache: Computed trajectories, reused when their inputs recur.
+
+ This file is part of the Dynamics Toolset.
+
+ The Dynamics Toolset is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by the Free
+ Software Foundation, either version 3 of the License, or (at your option) any
+ later version.
+
+ The Dynamics Toolset is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ details.
+
+ You should have received a copy of the GNU General Public License
+ along with the Dynamics Toolset. If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#include "TrajectoryCache.h"
+
+// Project includes
+//
+#include "Dynamics/Counters.h"
+
+// 64 MB, about 400 trajectories of 5000 points in four dimensions
+const size_t TrajectoryCache::DefaultCapacity=64 * 1024 * 1024;
+
+//
+// TrajectoryCache::Key methods
+//
+
+TrajectoryCache::Key::Key(const DynamicalModel<double>& model,
+      const Integrator<double>& integrator, const DTS::Vector<double>& initial,
+      unsigned int numberOfPoints) :
+   integrator(&integrator), numberOfPoints(numberOfPoints)
+{
+   appendParameters(model, values);
+   appendParameters(integrator, values);
+   for (int i=0; i < initial.getDimension(); i++)
+   {
+      values.push_back(initial[i]);
+   }
+}
+
+bool TrajectoryCache::Key::operator<(const Key& other) const
+{
+   if (integrator != other.integrator)
+   {
+      return integrator < other.integrator;
+   }
+   if (numberOfPoints != other.numberOfPoints)
+   {
+      return numberOfPoints < other.numberOfPoints;
+   }
+   return values < other.values;
+}
+
+size_t TrajectoryCache::Key::getSize() const
+{
+   return sizeof(Key) + values.size() * sizeof(double);
+}
+
+void TrajectoryCache::Key::appendParameters(const ParameterClass<double>& parameters,
+      std::vector<double>& values)
+{
+   const std::vector<double>& real=parameters.getRealParamValues();
+   values.insert(values.end(), real.begin(), real.end());
+
+   const ParameterClass<double>::IntParameters& integer=parameters.getIntParams();
+   for (unsigned int i=0; i < integer.size(); i++)
+   {
+      values.push_back(integer[i].value);
+   }
+
+   const ParameterClass<double>::BoolParameters& boolean=parameters.getBoolParams();
+   for (unsigned int i=0; i < boolean.size(); i++)
+   {
+      values.push_back(boolean[i].value ? 1.0 : 0.0);
+   }
+}
+
+//
+// TrajectoryCache methods
+//
+
+TrajectoryCache::TrajectoryCache(size_t capacity) :
+   capacity(capacity), size(0)
+{
+   hitCounter=DTS::Counters::getCounter("Trajectory cache hits");
+   missCounter=DTS::Counters::getCounter("Trajectory cache misses");
+}
+
+bool TrajectoryCache::find(const Key& key, std::vector<DTS::Vector<double> >& points)
+{
+   EntryMap::iterator it=index.find(key);
+   if (it == index.end())
+   {
+      DTS::Counters::add(missCounter);
+      return false;
+   }
+   DTS::Counters::add(hitCounter);
+
+   // move the entry to the front of the list, the iterators stay valid
+   entries.splice(entries.begin(), entries, it->second);
+
+   const Entry& entry=*it->second;
+   unsigned int numberOfPoints=entry.states.size() / entry.dimension;
+   for (unsigned int i=0; i < numberOfPoints && i < points.size(); i++)
+   {
+      DTS::Vector<double>& point=points[i];
+      if (point.getDimension() != entry.dimension)
+      {
+         point.setDimension(entry.dimension);
+      }
+      for (int c=0; c < entry.dimension; c++)
+      {
+         point[c]=entry.states[i * entry.dimension + c];
+      }
+   }
+
+   return true;
+}
+
+void TrajectoryCache::insert(const Key& key, const std::vector<DTS::Vector<double> >& points,
+      unsigned int numberOfPoints)
+{
+   if (numberOfPoints == 0 || numberOfPoints > points.size())
+   {
+      return;
+   }
+
+   // replace an existing trajectory for the same key
+   EntryMap::iterator it=index.find(key);
+   if (it != index.end())
+   {
+      size-=it->second->getSize();
+      entries.erase(it->second);
+      index.erase(it);
+   }
+
+   entries.push_front(Entry(key));
+   Entry& entry=entries.front();
+   entry.dimension=points[0].getDimension();
+   entry.states.resize(numberOfPoints * entry.dimension);
+   for (unsigned int i=0; i < numberOfPoints; i++)
+   {
+      for (int c=0; c < entry.dimension; c++)
+      {
+         entry.states[i * entry.dimension + c]=points[i][c];
+      }
+   }
+
+   index.insert(EntryMap::value_type(key, entries.begin()));
+   size+=entry.getSize();
+
+   evict();
+}
+
+void TrajectoryCache::clear()
+{
+   entries.clear();
+   index.clear();
+   size=0;
+}
+
+void TrajectoryCache::setCapacity(size_t bytes)
+{
+   capacity=bytes;
+   evict();
+}
+
+void TrajectoryCache::evict()
+{
+   // the most recent trajectory is kept even if it alone exceeds the capacity
+   while (size > capacity && entries.size() > 1)
+   {
+      Entry& entry=entries.back();
+      size-=entry.getSize();
+      index.erase(entry.key);
+      entries.pop_back();
+   }
+}
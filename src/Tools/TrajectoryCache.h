@@ -0,0 +1,139 @@
+/*******************************************************************************
+ TrajectoryCache: Computed trajectories, reused when their inputs recur.
+
+ This file is part of the Dynamics Toolset.
+
+ The Dynamics Toolset is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by the Free
+ Software Foundation, either version 3 of the License, or (at your option) any
+ later version.
+
+ The Dynamics Toolset is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ details.
+
+ You should have received a copy of the GNU General Public License
+ along with the Dynamics Toolset. If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#ifndef TRAJECTORY_CACHE_H
+#define TRAJECTORY_CACHE_H
+
+// STL includes
+//
+#include <cstddef>
+#include <list>
+#include <map>
+#include <vector>
+
+// Project includes
+//
+#include "Dynamics/DynamicalModel.h"
+#include "Dynamics/Integrator.h"
+#include "Dynamics/Vector.h"
+
+/** Trajectories of the StaticSolverTool, reused when their inputs recur.
+ *
+ * A trajectory is determined by the model parameters, the integrator and
+ * its parameters, the initial state and the number of points. The key holds
+ * the values of all of these rather than the model and integrator versions,
+ * which grow with every change: sliding a parameter away and back to its
+ * old value finds the trajectory computed before.
+ *
+ * The trajectories are stored in model coordinates, so they stay valid when
+ * only the transformer changes. The cache keeps the most recently used
+ * trajectories up to a capacity in bytes and evicts the least recently used
+ * one first. Integrators are identified by address, so the cache must be
+ * cleared when the experiment changes.
+ */
+class TrajectoryCache
+{
+   public:
+      /** Inputs that determine a trajectory.
+       */
+      class Key
+      {
+         public:
+            Key(const DynamicalModel<double>& model, const Integrator<double>& integrator,
+                  const DTS::Vector<double>& initial, unsigned int numberOfPoints);
+
+            bool operator<(const Key& other) const;
+
+            /** Approximate size of the key in bytes.
+             */
+            size_t getSize() const;
+
+         private:
+            const Integrator<double>* integrator;
+            unsigned int numberOfPoints;
+            std::vector<double> values; ///< Parameter values followed by the initial state.
+
+            static void appendParameters(const ParameterClass<double>& parameters,
+                  std::vector<double>& values);
+      };
+
+      TrajectoryCache(size_t capacity=DefaultCapacity);
+
+      /** Copies a cached trajectory into 'points' and marks it most recently used.
+       *
+       * \return false if there is no trajectory for the key.
+       */
+      bool find(const Key& key, std::vector<DTS::Vector<double> >& points);
+
+      /** Stores the first 'numberOfPoints' points, evicting the least recently
+       * used trajectories while the cache exceeds its capacity.
+       */
+      void insert(const Key& key, const std::vector<DTS::Vector<double> >& points,
+            unsigned int numberOfPoints);
+
+      void clear();
+
+      void setCapacity(size_t bytes);
+
+      size_t getCapacity() const
+      {
+         return capacity;
+      }
+
+      /** Bytes used by the cached trajectories and their keys.
+       */
+      size_t getSize() const
+      {
+         return size;
+      }
+
+      static const size_t DefaultCapacity;
+
+   private:
+      struct Entry
+      {
+         Entry(const Key& key) :
+            key(key), dimension(0)
+         {
+         }
+
+         Key key;
+         int dimension;
+         std::vector<double> states; ///< Points, 'dimension' consecutive values each.
+
+         size_t getSize() const
+         {
+            return key.getSize() + states.size() * sizeof(double);
+         }
+      };
+
+      typedef std::list<Entry> EntryList;
+      typedef std::map<Key, EntryList::iterator> EntryMap;
+
+      EntryList entries; ///< Most recently used first.
+      EntryMap index;
+      size_t capacity;
+      size_t size;
+
+      int hitCounter;
+      int missCounter;
+
+      void evict();
+};
+
+#endif
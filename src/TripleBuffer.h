@@ -0,0 +1,111 @@
+/*******************************************************************************
+ TripleBuffer: Lock-free hand-off of data between two threads.
+
+ This file is part of the Dynamics Toolset.
+
+ The Dynamics Toolset is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by the Free
+ Software Foundation, either version 3 of the License, or (at your option) any
+ later version.
+
+ The Dynamics Toolset is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ details.
+
+ You should have received a copy of the GNU General Public License
+ along with the Dynamics Toolset. If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+/** Three slots shared by one producer and one consumer thread.
+ *
+ * The producer fills the back slot and publishes it; the consumer picks up
+ * the most recently published slot as its front slot. The third slot sits
+ * in the middle and is exchanged atomically, so neither side ever waits for
+ * the other and the consumer never sees a half-written slot. Slots are
+ * reused, so a slot holding a std::vector stops allocating once it has
+ * reached its largest size.
+ *
+ * getBack()/publish() may only be called by the producer, consume()/
+ * getFront() only by the consumer.
+ */
+template <typename ValueParam>
+class TripleBuffer
+{
+   public:
+      typedef ValueParam Value;
+
+      TripleBuffer() :
+         back(0), middle(1), front(2)
+      {
+      }
+
+      /** Slot to be filled by the producer.
+       */
+      Value& getBack()
+      {
+         return slots[back];
+      }
+
+      /** Hand the back slot to the consumer and take over the middle one.
+       *
+       * A slot published before the consumer picked it up is replaced.
+       */
+      void publish()
+      {
+         back=exchangeMiddle(back | FRESH) & INDEX;
+      }
+
+      /** Make the latest published slot the front slot.
+       *
+       * \return False if nothing was published since the last call, in which
+       * case the front slot is unchanged.
+       */
+      bool consume()
+      {
+         if ((middle & FRESH) == 0)
+            return false;
+
+         front=exchangeMiddle(front) & INDEX;
+         return true;
+      }
+
+      /** Slot last picked up by the consumer.
+       */
+      const Value& getFront() const
+      {
+         return slots[front];
+      }
+
+   private:
+      enum
+      {
+         INDEX=3, ///< Bits of a slot index.
+         FRESH=4  ///< Set on the middle index when it was published but not consumed.
+      };
+
+      /** Atomically replace the middle index; full memory barrier.
+       */
+      int exchangeMiddle(int value)
+      {
+         int old;
+         do
+         {
+            old=middle;
+         } while (!__sync_bool_compare_and_swap(&middle, old, value));
+         return old;
+      }
+
+      Value slots[3];
+      int back; ///< Owned by the producer.
+      volatile int middle;
+      int front; ///< Owned by the consumer.
+
+      /* Not copyable */
+      TripleBuffer(const TripleBuffer&);
+      TripleBuffer& operator=(const TripleBuffer&);
+};
+
+#endif
@@ -0,0 +1,378 @@
+/*******************************************************************************
+ TubeMesh: Triangle mesh of a tube around a polyline, in levels of detail.
+
+ This file is part of the Dynamics Toolset.
+
+ The Dynamics Toolset is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by the Free
+ Software Foundation, either version 3 of the License, or (at your option) any
+ later version.
+
+ The Dynamics Toolset is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ details.
+
+ You should have received a copy of the GNU General Public License
+ along with the Dynamics Toolset. If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#include "TubeMesh.h"
+
+// STL includes
+//
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+// Vrui includes
+//
+#include <GL/Extensions/GLARBVertexBufferObject.h>
+
+// Project includes
+//
+#include "PolylineSimplifier.h"
+
+namespace
+{
+
+/// Vertices per ring of each level.
+const unsigned int Sides[TubeMesh::NumLevels]={ 12, 8, 6, 4 };
+
+/// Smallest projected tube radius, in pixels, each level is used for.
+const double MinPixels[TubeMesh::NumLevels]={ 6.0, 2.5, 1.0, 0.0 };
+
+/// Distance, in tube radii, the center line of each level may deviate from
+/// the polyline. Below level 0 this is at most half a pixel on screen.
+const double Tolerances[TubeMesh::NumLevels]={ 0.05, 0.5 / 6.0, 0.5 / 2.5, 0.5 };
+
+/** Rings of consecutive points of one level.
+ */
+struct LevelGeometry
+{
+      const double* points;
+      const float* colors;
+      unsigned int numPoints;
+      double radius;
+
+      const unsigned int* samples; ///< Point of each ring.
+      unsigned int sides; ///< Vertices per ring.
+      unsigned int numRings;
+
+      TubeMesh::Vertex* vertices; ///< First vertex of the level.
+      unsigned int firstVertex; ///< Index of the first vertex of the level.
+      GLuint* indices; ///< First index of the level.
+      double* frames; ///< Tangent, normal and binormal of each ring.
+
+      /// Point of ring j, clamped to the ends of the tube.
+      unsigned int getPoint(int j) const
+      {
+         if (j <= 0)
+            return samples[0];
+         return samples[std::min(unsigned(j), numRings - 1)];
+      }
+};
+
+/** Computes the frames and vertices of a range of rings.
+ *
+ * The tangent is the central difference of the neighbouring points, the
+ * normal the coordinate axis least aligned with it, made orthogonal.
+ */
+class RingTask: public DTS::ThreadPool::Task
+{
+   public:
+      const LevelGeometry* level;
+
+      void run(size_t begin, size_t end, int thread)
+      {
+         const LevelGeometry& g=*level;
+
+         for (size_t j=begin; j < end; j++)
+         {
+            unsigned int p=g.getPoint(j);
+            const double* prev=g.points + 3 * g.getPoint(int(j) - 1);
+            const double* next=g.points + 3 * g.getPoint(j + 1);
+
+            double* t=g.frames + 9 * j;
+            double* n=t + 3;
+            double* b=t + 6;
+
+            double length=0.0;
+            for (int k=0; k < 3; k++)
+            {
+               t[k]=next[k] - prev[k];
+               length+=t[k] * t[k];
+            }
+            length=std::sqrt(length);
+            if (length > 0.0)
+            {
+               t[0]/=length;
+               t[1]/=length;
+               t[2]/=length;
+            }
+            else
+            {
+               // the trajectory has come to rest
+               t[0]=0.0;
+               t[1]=0.0;
+               t[2]=1.0;
+            }
+
+            int axis=0;
+            for (int k=1; k < 3; k++)
+            {
+               if (std::fabs(t[k]) < std::fabs(t[axis]))
+                  axis=k;
+            }
+            for (int k=0; k < 3; k++)
+            {
+               n[k]=-t[axis] * t[k];
+            }
+            n[axis]+=1.0;
+            length=std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            n[0]/=length;
+            n[1]/=length;
+            n[2]/=length;
+
+            b[0]=t[1] * n[2] - t[2] * n[1];
+            b[1]=t[2] * n[0] - t[0] * n[2];
+            b[2]=t[0] * n[1] - t[1] * n[0];
+
+            const double* point=g.points + 3 * p;
+            TubeMesh::Vertex* ring=g.vertices + j * g.sides;
+            for (unsigned int s=0; s < g.sides; s++)
+            {
+               double angle=2.0 * M_PI * s / g.sides;
+               double c=std::cos(angle);
+               double d=std::sin(angle);
+
+               TubeMesh::Vertex& v=ring[s];
+               for (int k=0; k < 3; k++)
+               {
+                  double direction=c * n[k] + d * b[k];
+                  v.normal[k]=direction;
+                  v.position[k]=point[k] + g.radius * direction;
+               }
+
+               if (g.colors != NULL)
+               {
+                  v.color[0]=GLubyte(g.colors[3 * p + 0] * 255.0f);
+                  v.color[1]=GLubyte(g.colors[3 * p + 1] * 255.0f);
+                  v.color[2]=GLubyte(g.colors[3 * p + 2] * 255.0f);
+               }
+               else
+               {
+                  v.color[0]=v.color[1]=v.color[2]=255;
+               }
+               v.color[3]=255;
+            }
+         }
+      }
+};
+
+/** Joins a range of consecutive rings with triangles.
+ *
+ * Ring j+1 is turned against ring j by the angle of its normal in the
+ * frame of ring j; its vertices are joined with an offset of that angle
+ * rounded to whole vertices.
+ */
+class SegmentTask: public DTS::ThreadPool::Task
+{
+   public:
+      const LevelGeometry* level;
+
+      void run(size_t begin, size_t end, int thread)
+      {
+         const LevelGeometry& g=*level;
+         const int sides=g.sides;
+
+         for (size_t j=begin; j < end; j++)
+         {
+            const double* n0=g.frames + 9 * j + 3;
+            const double* b0=g.frames + 9 * j + 6;
+            const double* n1=g.frames + 9 * (j + 1) + 3;
+
+            double x=n1[0] * n0[0] + n1[1] * n0[1] + n1[2] * n0[2];
+            double y=n1[0] * b0[0] + n1[1] * b0[1] + n1[2] * b0[2];
+            int offset=int(std::floor(std::atan2(y, x) * sides / (2.0 * M_PI) + 0.5));
+
+            GLuint ring0=g.firstVertex + j * sides;
+            GLuint ring1=ring0 + sides;
+            GLuint* triangle=g.indices + 6 * j * sides;
+            for (int s=0; s < sides; s++)
+            {
+               GLuint a=ring0 + s;
+               GLuint b=ring0 + (s + 1) % sides;
+               GLuint c=ring1 + ((s - offset) % sides + sides) % sides;
+               GLuint d=ring1 + ((s + 1 - offset) % sides + sides) % sides;
+
+               triangle[0]=a;
+               triangle[1]=b;
+               triangle[2]=d;
+               triangle[3]=a;
+               triangle[4]=d;
+               triangle[5]=c;
+               triangle+=6;
+            }
+         }
+      }
+};
+
+}
+
+//
+// TubeMesh methods
+//
+
+TubeMesh::TubeMesh() :
+   colored(false), boundingRadius(0.0), radius(0.0)
+{
+   center[0]=center[1]=center[2]=0.0;
+   clear();
+}
+
+void TubeMesh::clear()
+{
+   vertices.clear();
+   indices.clear();
+   for (unsigned int l=0; l < NumLevels; l++)
+   {
+      levels[l].firstIndex=0;
+      levels[l].numIndices=0;
+   }
+}
+
+void TubeMesh::build(const double* points, const float* colors, unsigned int numPoints,
+      double radius, DTS::ThreadPool& pool)
+{
+   clear();
+   colored=colors != NULL;
+   this->radius=radius;
+   if (numPoints < 2)
+   {
+      return;
+   }
+
+   // bounding sphere of the tube
+   double min[3]={ points[0], points[1], points[2] };
+   double max[3]={ points[0], points[1], points[2] };
+   for (unsigned int i=1; i < numPoints; i++)
+   {
+      for (int k=0; k < 3; k++)
+      {
+         min[k]=std::min(min[k], points[3 * i + k]);
+         max[k]=std::max(max[k], points[3 * i + k]);
+      }
+   }
+   double diagonal=0.0;
+   for (int k=0; k < 3; k++)
+   {
+      center[k]=0.5 * (min[k] + max[k]);
+      diagonal+=(max[k] - min[k]) * (max[k] - min[k]);
+   }
+   boundingRadius=0.5 * std::sqrt(diagonal) + radius;
+
+   // lay out the levels one after another, each with the points it needs
+   // for its tolerance
+   LevelGeometry geometry[NumLevels];
+   size_t numVertices=0;
+   size_t numIndices=0;
+   size_t maxRings=0;
+   for (unsigned int l=0; l < NumLevels; l++)
+   {
+      PolylineSimplifier(Tolerances[l] * radius).simplify(points, numPoints, samples[l]);
+
+      LevelGeometry& g=geometry[l];
+      g.points=points;
+      g.colors=colors;
+      g.numPoints=numPoints;
+      g.radius=radius;
+      g.samples=&samples[l][0];
+      g.sides=Sides[l];
+      g.numRings=samples[l].size();
+      g.firstVertex=numVertices;
+
+      levels[l].firstIndex=numIndices;
+      levels[l].numIndices=6 * (g.numRings - 1) * g.sides;
+
+      numVertices+=g.numRings * g.sides;
+      maxRings=std::max<size_t>(maxRings, g.numRings);
+      numIndices+=levels[l].numIndices;
+   }
+
+   vertices.resize(numVertices);
+   indices.resize(numIndices);
+   frames.resize(9 * maxRings);
+
+   for (unsigned int l=0; l < NumLevels; l++)
+   {
+      LevelGeometry& g=geometry[l];
+      g.vertices=&vertices[g.firstVertex];
+      g.indices=&indices[levels[l].firstIndex];
+      g.frames=&frames[0];
+
+      RingTask rings;
+      rings.level=&g;
+      pool.parallelFor(g.numRings, 256, rings);
+
+      SegmentTask segments;
+      segments.level=&g;
+      pool.parallelFor(g.numRings - 1, 256, segments);
+   }
+}
+
+unsigned int TubeMesh::selectLevel(double pixels) const
+{
+   unsigned int level=0;
+   while (level + 1 < NumLevels && pixels < MinPixels[level])
+   {
+      level++;
+   }
+   return level;
+}
+
+size_t TubeMesh::upload(GLuint vertexBufferId, GLuint indexBufferId) const
+{
+   if (empty())
+   {
+      return 0;
+   }
+
+   glBindBufferARB(GL_ARRAY_BUFFER_ARB, vertexBufferId);
+   glBufferDataARB(GL_ARRAY_BUFFER_ARB, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW_ARB);
+   glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+
+   glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, indexBufferId);
+   glBufferDataARB(GL_ELEMENT_ARRAY_BUFFER_ARB, indices.size() * sizeof(GLuint), &indices[0], GL_STATIC_DRAW_ARB);
+   glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, 0);
+
+   return vertices.size() * sizeof(Vertex) + indices.size() * sizeof(GLuint);
+}
+
+void TubeMesh::draw(unsigned int level, bool fromBuffers) const
+{
+   if (empty())
+   {
+      return;
+   }
+
+   const char* base=fromBuffers ? NULL : reinterpret_cast<const char*> (&vertices[0]);
+   const GLvoid* first=fromBuffers
+         ? reinterpret_cast<const GLvoid*> (levels[level].firstIndex * sizeof(GLuint))
+         : &indices[levels[level].firstIndex];
+
+   glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+
+   glEnableClientState(GL_VERTEX_ARRAY);
+   glEnableClientState(GL_NORMAL_ARRAY);
+   glVertexPointer(3, GL_FLOAT, sizeof(Vertex), base + offsetof(Vertex, position));
+   glNormalPointer(GL_FLOAT, sizeof(Vertex), base + offsetof(Vertex, normal));
+   if (colored)
+   {
+      glEnableClientState(GL_COLOR_ARRAY);
+      glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(Vertex), base + offsetof(Vertex, color));
+   }
+
+   glDrawElements(GL_TRIANGLES, levels[level].numIndices, GL_UNSIGNED_INT, first);
+
+   glPopClientAttrib();
+}
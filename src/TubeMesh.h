@@ -0,0 +1,144 @@
+/*******************************************************************************
+ TubeMesh: Triangle mesh of a tube around a polyline, in levels of detail.
+
+ This file is part of the Dynamics Toolset.
+
+ The Dynamics Toolset is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by the Free
+ Software Foundation, either version 3 of the License, or (at your option) any
+ later version.
+
+ The Dynamics Toolset is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ details.
+
+ You should have received a copy of the GNU General Public License
+ along with the Dynamics Toolset. If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#ifndef TUBE_MESH_H
+#define TUBE_MESH_H
+
+// STL includes
+//
+#include <vector>
+
+// Vrui includes
+//
+#include <GL/gl.h>
+
+// Project includes
+//
+#include "Dynamics/ThreadPool.h"
+
+/** Triangle mesh of a tube around a polyline, built once and drawn often.
+ *
+ * The mesh replaces tessellating the tube with glePolyCylinder whenever it
+ * is drawn. It holds NumLevels levels of detail with fewer vertices per
+ * ring and fewer rings from level to level. The rings are placed at the
+ * points a PolylineSimplifier keeps for a tolerance relative to the tube
+ * radius, so straight stretches get few rings and tight bends many, and
+ * the color of each ring is that of its original point. selectLevel()
+ * picks the level for the radius the tube has on screen; the tolerance of
+ * each level keeps its error below half a pixel there.
+ *
+ * Every ring is oriented from its own point and neighbours, so the rings
+ * are computed in parallel. Consecutive rings are then joined with the
+ * rotation that best matches their orientations, which keeps the tube from
+ * twisting more than half the angle between two ring vertices per segment.
+ *
+ * The mesh is kept on the CPU. upload() copies it into buffer objects of a
+ * GL context, draw() renders one level from the bound buffers or, without
+ * buffer objects, from the CPU copy.
+ */
+class TubeMesh
+{
+   public:
+      /// Vertex layout of the mesh, colors are only used if the mesh has them.
+      struct Vertex
+      {
+         GLubyte color[4];
+         GLfloat normal[3];
+         GLfloat position[3];
+      };
+
+      static const unsigned int NumLevels=4;
+
+      TubeMesh();
+
+      /** Builds all levels for a polyline.
+       *
+       * \param points 3 display coordinates per point.
+       * \param colors 3 color components per point, or NULL.
+       */
+      void build(const double* points, const float* colors, unsigned int numPoints,
+            double radius, DTS::ThreadPool& pool);
+
+      /** Removes the mesh, an empty mesh draws nothing.
+       */
+      void clear();
+
+      bool empty() const
+      {
+         return indices.empty();
+      }
+
+      bool hasColors() const
+      {
+         return colored;
+      }
+
+      /** Center and radius of a sphere around the tube, in display coordinates.
+       */
+      const double* getCenter() const
+      {
+         return center;
+      }
+
+      double getBoundingRadius() const
+      {
+         return boundingRadius;
+      }
+
+      double getRadius() const
+      {
+         return radius;
+      }
+
+      /** The coarsest level that still looks round at a projected tube
+       *  radius of 'pixels'.
+       */
+      unsigned int selectLevel(double pixels) const;
+
+      /** Copies the mesh into buffer objects of the current context.
+       *
+       * \return The number of bytes uploaded.
+       */
+      size_t upload(GLuint vertexBufferId, GLuint indexBufferId) const;
+
+      /** Draws a level from the bound buffers if 'fromBuffers' is true, from
+       *  the CPU copy otherwise.
+       */
+      void draw(unsigned int level, bool fromBuffers) const;
+
+   private:
+      struct Level
+      {
+         unsigned int firstIndex;
+         unsigned int numIndices;
+      };
+
+      std::vector<Vertex> vertices; ///< Rings of all levels.
+      std::vector<GLuint> indices; ///< Triangles of all levels.
+      Level levels[NumLevels];
+      bool colored;
+
+      double center[3];
+      double boundingRadius;
+      double radius;
+
+      std::vector<unsigned int> samples[NumLevels]; ///< Points of the rings of each level, while building.
+      std::vector<double> frames; ///< Tangent, normal and binormal per ring, while building.
+};
+
+#endif